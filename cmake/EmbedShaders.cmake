@@ -0,0 +1,42 @@
+# Writes the SPIR-V of every shader into C++ sources, run in script mode by target_embed_shaders.
+#   SHADER_DIR     directory holding <shader>.spv
+#   SHADERS        comma separated shader names relative to SHADER_DIR, e.g. naive/naive.vert
+#   OUTPUT_HEADER  names, usable in constant expressions
+#   OUTPUT_SOURCE  the code words
+
+string(REPLACE "," ";" SHADER_LIST "${SHADERS}")
+list(LENGTH SHADER_LIST SHADER_COUNT)
+
+set(HEADER_CONTENT "// generated by cmake/EmbedShaders.cmake, do not edit\n#pragma once\n\n#include <array>\n#include <cstdint>\n#include <span>\n#include <string_view>\n\nnamespace lvk::detail\n{\n\nextern const std::array<std::span<const uint32_t>, ${SHADER_COUNT}> EMBEDDED_SHADER_CODE;\n\ninline constexpr std::array<std::string_view, ${SHADER_COUNT}> EMBEDDED_SHADER_NAMES\n{\n")
+set(SOURCE_CONTENT "// generated by cmake/EmbedShaders.cmake, do not edit\n#include \"lvk_embedded_shaders.hpp\"\n\nnamespace lvk::detail\n{\n\n")
+set(TABLE_CONTENT "const std::array<std::span<const uint32_t>, ${SHADER_COUNT}> EMBEDDED_SHADER_CODE\n{\n")
+
+# cmake regexes have no {n} quantifier
+string(REPEAT "0x[0-9a-f]+, " 8 LINE_PATTERN)
+
+set(INDEX 0)
+foreach(SHADER ${SHADER_LIST})
+    set(SPV_PATH "${SHADER_DIR}/${SHADER}.spv")
+    file(READ "${SPV_PATH}" HEX_CONTENT HEX)
+    string(LENGTH "${HEX_CONTENT}" HEX_LENGTH)
+    math(EXPR WORD_REMAINDER "${HEX_LENGTH} % 8")
+    if(HEX_LENGTH EQUAL 0 OR NOT WORD_REMAINDER EQUAL 0)
+        message(FATAL_ERROR "${SPV_PATH} is not a whole number of 32 bit words")
+    endif()
+
+    # spir-v is little endian, every 4 bytes become one word literal, 8 per line
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " WORDS "${HEX_CONTENT}")
+    string(REGEX REPLACE "(${LINE_PATTERN})" "\\1\n    " WORDS "${WORDS}")
+
+    string(APPEND HEADER_CONTENT "    \"${SHADER}\",\n")
+    string(APPEND SOURCE_CONTENT "// ${SHADER}\nstatic const uint32_t SHADER_${INDEX}[]\n{\n    ${WORDS}\n};\n\n")
+    string(APPEND TABLE_CONTENT "    std::span<const uint32_t>(SHADER_${INDEX}),\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+string(APPEND HEADER_CONTENT "};\n\n}\n")
+string(APPEND TABLE_CONTENT "};\n\n}\n")
+string(APPEND SOURCE_CONTENT "${TABLE_CONTENT}")
+
+file(WRITE "${OUTPUT_HEADER}" "${HEADER_CONTENT}")
+file(WRITE "${OUTPUT_SOURCE}" "${SOURCE_CONTENT}")
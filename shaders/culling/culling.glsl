@@ -0,0 +1,54 @@
+// shared by scatter.comp and cull.comp, layouts mirror lvk_gpu_culling.hpp
+
+const uint NO_MESH = 0xffffffffu;
+
+struct Mesh
+{
+    vec4 sphere;
+    uint index_count;
+    uint first_index;
+    int vertex_offset;
+    uint vertex_count;
+};
+
+struct ObjectUpdate
+{
+    mat4 world;
+    uint index;
+    uint mesh;
+    uint pad0;
+    uint pad1;
+};
+
+struct DrawIndexedCommand
+{
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int vertex_offset;
+    uint first_instance;
+};
+
+struct DrawCommand
+{
+    uint vertex_count;
+    uint instance_count;
+    uint first_vertex;
+    uint first_instance;
+};
+
+layout(std430, set = 0, binding = 0) buffer WorldMatrices { mat4 world_matrices[]; };
+layout(std430, set = 0, binding = 1) buffer ObjectMeshes { uint object_meshes[]; };
+layout(std430, set = 0, binding = 2) readonly buffer Meshes { Mesh meshes[]; };
+layout(std430, set = 0, binding = 3) readonly buffer ObjectUpdates { ObjectUpdate updates[]; };
+layout(std430, set = 0, binding = 4) writeonly buffer IndexedDraws { DrawIndexedCommand indexed_draws[]; };
+layout(std430, set = 0, binding = 5) writeonly buffer VertexDraws { DrawCommand vertex_draws[]; };
+// [0] indexed draws, [1] non indexed draws, [2] culled objects
+layout(std430, set = 0, binding = 6) buffer DrawCounts { uint draw_counts[3]; };
+
+layout(push_constant) uniform CullConstants
+{
+    vec4 planes[6];
+    uint object_count;
+    uint update_count;
+} constants;
@@ -4,15 +4,23 @@ layout(location = 0) in vec3 in_posision;
 layout(location = 1) in vec3 in_color;
 layout(location = 0) out vec3 frag_color;
 
-layout(push_constant) uniform MVPUBO
+// written once per frame, mirrors CameraUniform in lvk_camera.hpp
+layout(std140, set = 0, binding = 1) uniform Camera
 {
-    mat4 model;
     mat4 view;
     mat4 projection;
-} mvp;
+    mat4 view_projection;
+} camera;
+
+// indexed by gl_InstanceIndex, each instanced draw starts at its first instance via firstInstance.
+// with gpu culling this is the culling pass's world matrix buffer and firstInstance the object index
+layout(std430, set = 0, binding = 0) readonly buffer DrawData
+{
+    mat4 models[];
+} draw_data;
 
 void main()
 {
-    gl_Position =  mvp.projection * mvp.view * mvp.model * vec4(in_posision, 1.0);
+    gl_Position = camera.view_projection * draw_data.models[gl_InstanceIndex] * vec4(in_posision, 1.0);
     frag_color = in_color;
-}
\ No newline at end of file
+}
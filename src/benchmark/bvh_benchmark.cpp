@@ -0,0 +1,241 @@
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// glm
+#include <glm/ext.hpp>
+
+// module
+#include "lvk/lvk_bvh.hpp"
+#include "lvk/lvk_culling.hpp"
+#include "lvk/lvk_job_system.hpp"
+
+// build and query throughput of lvk::Bvh against linear scans over the same boxes
+// usage: bvh_benchmark [count] [queries]
+
+template <typename F>
+double measure(F &&f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static bool BoxInFrustum(const lvk::Frustum &frustum, const lvk::Aabb &box)
+{
+    auto center = box.Center();
+    auto half_extent = box.HalfExtent();
+    for (const auto &plane : frustum.planes)
+    {
+        auto normal = glm::vec3(plane);
+        if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), half_extent) < 0.f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool SameResults(std::vector<uint32_t> a, std::vector<uint32_t> b)
+{
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t queries = argc > 2 ? std::stoul(argv[2]) : 1000;
+
+    // objects scattered through a 2km cube
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-1000.f, 1000.f);
+    std::uniform_real_distribution<float> size(0.5f, 4.f);
+    std::vector<lvk::Aabb> boxes(count);
+    std::vector<uint32_t> ids(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 center{position(rng), position(rng), position(rng)};
+        glm::vec3 half_extent{size(rng), size(rng), size(rng)};
+        boxes[i] = lvk::Aabb{center - half_extent, center + half_extent};
+        ids[i] = static_cast<uint32_t>(i);
+    }
+
+    bool pass = true;
+    auto report = [&](std::string_view name, double seconds, size_t operations, std::string_view unit)
+    {
+        std::cout << fmt::format("{:<24} {:>10.3f} ms {:>12.1f} {}/s\n", name, seconds * 1e3, operations / seconds, unit);
+    };
+
+    lvk::JobSystem jobs;
+    lvk::Bvh tree;
+    std::vector<lvk::Bvh::Proxy> proxies;
+    auto build_time = measure([&]() { proxies = tree.Build(boxes, ids, &jobs); });
+    tree.Validate();
+    report("sah build", build_time, count, "objects");
+    std::cout << fmt::format("{:<24} height {} cost {:.1f}\n", "", tree.GetHeight(), tree.ComputeCost());
+
+    lvk::Bvh incremental;
+    auto insert_count = std::min<size_t>(count, 100000);
+    std::vector<lvk::Bvh::Proxy> incremental_proxies(insert_count);
+    auto insert_time = measure([&]()
+    {
+        for (size_t i = 0; i < insert_count; i++)
+        {
+            incremental_proxies[i] = incremental.Insert(boxes[i], ids[i]);
+        }
+    });
+    incremental.Validate();
+    report("incremental insert", insert_time, insert_count, "objects");
+    std::cout << fmt::format("{:<24} height {} cost {:.1f}\n", "", incremental.GetHeight(), incremental.ComputeCost());
+
+    // cameras at random spots looking at random targets with a 100m far plane
+    std::vector<lvk::Frustum> frustums(queries);
+    for (auto &frustum : frustums)
+    {
+        glm::vec3 eye{position(rng), position(rng), position(rng)};
+        glm::vec3 target{position(rng), position(rng), position(rng)};
+        auto view = glm::lookAt(eye, target, glm::vec3{0.f, 1.f, 0.f});
+        auto projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f);
+        frustum = lvk::ExtractFrustum(projection * view);
+    }
+
+    std::vector<uint32_t> found;
+    size_t found_total = 0;
+    auto frustum_time = measure([&]()
+    {
+        for (const auto &frustum : frustums)
+        {
+            found.clear();
+            tree.QueryFrustum(frustum, found);
+            found_total += found.size();
+        }
+    });
+    report("bvh frustum query", frustum_time, queries, "queries");
+
+    std::vector<uint32_t> linear;
+    auto linear_queries = std::max<size_t>(1, queries / 100);
+    auto linear_time = measure([&]()
+    {
+        for (size_t q = 0; q < linear_queries; q++)
+        {
+            linear.clear();
+            for (size_t i = 0; i < count; i++)
+            {
+                if (BoxInFrustum(frustums[q], boxes[i]))
+                {
+                    linear.push_back(ids[i]);
+                }
+            }
+        }
+    });
+    report("linear frustum scan", linear_time, linear_queries, "queries");
+    found.clear();
+    tree.QueryFrustum(frustums[linear_queries - 1], found);
+    bool frustum_ok = SameResults(found, linear);
+    pass = pass && frustum_ok;
+    std::cout << fmt::format("{:<24} {:.1f} visible per query, {}\n", "", found_total / double(queries), frustum_ok ? "matches linear scan" : "MISMATCH");
+
+    std::vector<glm::vec3> origins(queries);
+    std::vector<glm::vec3> directions(queries);
+    for (size_t q = 0; q < queries; q++)
+    {
+        origins[q] = {position(rng), position(rng), position(rng)};
+        directions[q] = glm::normalize(glm::vec3{position(rng), position(rng), position(rng)});
+    }
+
+    size_t hits = 0;
+    auto ray_time = measure([&]()
+    {
+        for (size_t q = 0; q < queries; q++)
+        {
+            hits += tree.RayCast(origins[q], directions[q], 1000.f).has_value();
+        }
+    });
+    report("bvh ray cast", ray_time, queries, "rays");
+    std::cout << fmt::format("{:<24} {} of {} rays hit\n", "", hits, queries);
+
+    // the nearest hit has to agree with a brute force slab test over every box
+    bool ray_ok = true;
+    for (size_t q = 0; q < std::min<size_t>(queries, 10); q++)
+    {
+        float best = std::numeric_limits<float>::max();
+        auto inverse_direction = 1.f / directions[q];
+        for (size_t i = 0; i < count; i++)
+        {
+            auto t0 = (boxes[i].min - origins[q]) * inverse_direction;
+            auto t1 = (boxes[i].max - origins[q]) * inverse_direction;
+            auto t_near = glm::min(t0, t1);
+            auto t_far = glm::max(t0, t1);
+            float t_enter = std::max({t_near.x, t_near.y, t_near.z, 0.f});
+            float t_exit = std::min({t_far.x, t_far.y, t_far.z, 1000.f});
+            if (t_enter <= t_exit)
+            {
+                best = std::min(best, t_enter);
+            }
+        }
+        auto hit = tree.RayCast(origins[q], directions[q], 1000.f);
+        ray_ok = ray_ok && (hit ? hit->distance == best : best == std::numeric_limits<float>::max());
+    }
+    pass = pass && ray_ok;
+    std::cout << fmt::format("{:<24} {}\n", "", ray_ok ? "nearest hits match brute force" : "NEAREST HIT MISMATCH");
+
+    size_t box_total = 0;
+    auto box_time = measure([&]()
+    {
+        for (size_t q = 0; q < queries; q++)
+        {
+            found.clear();
+            lvk::Aabb query{origins[q] - 20.f, origins[q] + 20.f};
+            tree.QueryBox(query, found);
+            box_total += found.size();
+        }
+    });
+    report("bvh box query", box_time, queries, "queries");
+    std::cout << fmt::format("{:<24} {:.1f} overlaps per query\n", "", box_total / double(queries));
+
+    // every object drifts a little, most stay inside their enlarged boxes
+    std::uniform_real_distribution<float> drift(-0.05f, 0.05f);
+    size_t reinserted = 0;
+    auto move_count = insert_count;
+    auto move_time = measure([&]()
+    {
+        for (size_t i = 0; i < move_count; i++)
+        {
+            glm::vec3 offset{drift(rng), drift(rng), drift(rng)};
+            boxes[i] = lvk::Aabb{boxes[i].min + offset, boxes[i].max + offset};
+            reinserted += incremental.Move(incremental_proxies[i], boxes[i]);
+        }
+    });
+    incremental.Validate();
+    report("move", move_time, move_count, "objects");
+    std::cout << fmt::format("{:<24} {} of {} reinserted\n", "", reinserted, move_count);
+
+    auto refit_time = measure([&]()
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            tree.SetBounds(proxies[i], boxes[i]);
+        }
+        tree.Refit();
+    });
+    tree.Validate();
+    report("set bounds + refit", refit_time, count, "objects");
+
+    auto rebuild_time = measure([&]() { tree.Rebuild(&jobs); });
+    tree.Validate();
+    report("rebuild", rebuild_time, count, "objects");
+
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,172 @@
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// module
+#include "lvk/lvk_job_system.hpp"
+#include "lvk/lvk_mesh_data.hpp"
+#include "lvk/lvk_mesh_optimizer.hpp"
+#include "lvk/lvk_obj_loader.hpp"
+
+// speed and vertex cache efficiency of each mesh optimizer stage over generated meshes and
+// the .obj files given, checks that every stage keeps the triangles
+// usage: mesh_optimizer_benchmark [OBJ...]
+
+template <typename F>
+double measure(F &&f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// rows x columns quads on a unit square, triangles in row order
+static lvk::MeshData MakeGrid(uint32_t rows, uint32_t columns)
+{
+    lvk::MeshData mesh;
+    for (uint32_t y = 0; y <= rows; y++)
+    {
+        for (uint32_t x = 0; x <= columns; x++)
+        {
+            auto u = static_cast<float>(x) / columns;
+            auto v = static_cast<float>(y) / rows;
+            mesh.vertices.push_back({{u, v, 0.f}, {u, v, 1.f}});
+        }
+    }
+    for (uint32_t y = 0; y < rows; y++)
+    {
+        for (uint32_t x = 0; x < columns; x++)
+        {
+            auto a = y * (columns + 1) + x;
+            auto b = a + columns + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    return mesh;
+}
+
+// unit sphere with rings x segments quads, seams duplicated like an exporter would
+static lvk::MeshData MakeSphere(uint32_t rings, uint32_t segments)
+{
+    lvk::MeshData mesh;
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        auto theta = std::numbers::pi_v<float> * ring / rings;
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            auto phi = 2.f * std::numbers::pi_v<float> * segment / segments;
+            glm::vec3 position{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+            mesh.vertices.push_back({position, position * 0.5f + 0.5f});
+        }
+    }
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            auto a = ring * (segments + 1) + segment;
+            auto b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, a + 1, b, a + 1, b + 1, b});
+        }
+    }
+    return mesh;
+}
+
+// triangles in random order, what scans merged from many passes tend to look like
+static lvk::MeshData Shuffle(lvk::MeshData mesh)
+{
+    std::mt19937 rng(42);
+    std::vector<std::array<uint32_t, 3>> triangles(mesh.indices.size() / 3);
+    std::memcpy(triangles.data(), mesh.indices.data(), triangles.size() * sizeof(triangles[0]));
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+    std::memcpy(mesh.indices.data(), triangles.data(), triangles.size() * sizeof(triangles[0]));
+    return mesh;
+}
+
+// triangles as position triples, rotated to start at their smallest corner and sorted
+static std::vector<std::array<float, 9>> CanonicalTriangles(const lvk::MeshData &mesh)
+{
+    std::vector<std::array<float, 9>> triangles;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        std::array<std::array<float, 3>, 3> corners;
+        for (int corner = 0; corner < 3; corner++)
+        {
+            const auto &position = mesh.vertices[mesh.indices[i + corner]].posision;
+            corners[corner] = {position.x, position.y, position.z};
+        }
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+        auto &triangle = triangles.emplace_back();
+        for (int corner = 0; corner < 3; corner++)
+        {
+            std::copy(corners[corner].begin(), corners[corner].end(), triangle.begin() + corner * 3);
+        }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::pair<std::string, lvk::MeshData>> corpus;
+    corpus.emplace_back("grid 512x512", MakeGrid(512, 512));
+    corpus.emplace_back("sphere 256x512", MakeSphere(256, 512));
+    corpus.emplace_back("shuffled grid 512x512", Shuffle(MakeGrid(512, 512)));
+    corpus.emplace_back("shuffled sphere 256x512", Shuffle(MakeSphere(256, 512)));
+
+    lvk::JobSystem jobs;
+    for (int i = 1; i < argc; i++)
+    {
+        corpus.emplace_back(std::filesystem::path(argv[i]).filename().string(), lvk::LoadObj(argv[i], &jobs));
+    }
+
+    bool pass = true;
+    auto report = [&](std::string_view name, double seconds, size_t triangles, const lvk::VertexCacheStats &stats)
+    {
+        std::cout << fmt::format("{:<24} {:>10.3f} ms {:>12.1f} triangles/s   acmr {:.3f} atvr {:.3f}\n",
+                                 name, seconds * 1e3, triangles / seconds, stats.acmr, stats.atvr);
+    };
+
+    for (auto &[name, mesh] : corpus)
+    {
+        auto triangle_count = mesh.indices.size() / 3;
+        auto vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+        std::cout << fmt::format("{}: {} vertices, {} triangles\n", name, vertex_count, triangle_count);
+        auto expected = CanonicalTriangles(mesh);
+        auto input = lvk::AnalyzeVertexCache(mesh.indices, vertex_count);
+        std::cout << fmt::format("{:<24} {:>47}acmr {:.3f} atvr {:.3f}\n", "input", "", input.acmr, input.atvr);
+
+        auto cache_time = measure([&]() { lvk::OptimizeVertexCache(mesh.indices, vertex_count); });
+        report("vertex cache", cache_time, triangle_count, lvk::AnalyzeVertexCache(mesh.indices, vertex_count));
+
+        auto overdraw_time = measure([&]() { lvk::OptimizeOverdraw(mesh.indices, mesh.vertices); });
+        report("overdraw", overdraw_time, triangle_count, lvk::AnalyzeVertexCache(mesh.indices, vertex_count));
+
+        auto fetch_time = measure([&]() { lvk::OptimizeVertexFetch(mesh); });
+        auto output = lvk::AnalyzeVertexCache(mesh.indices, static_cast<uint32_t>(mesh.vertices.size()));
+        report("vertex fetch", fetch_time, triangle_count, output);
+
+        bool same = CanonicalTriangles(mesh) == expected;
+        pass = pass && same;
+        std::cout << fmt::format("{:<24} {:.1f}% fewer transforms, {}\n\n", "",
+                                 (1.f - output.acmr / input.acmr) * 100.f, same ? "triangles kept" : "TRIANGLES CHANGED");
+    }
+
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
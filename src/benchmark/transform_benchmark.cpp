@@ -0,0 +1,105 @@
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// module
+#include "lvk/lvk_scene.hpp"
+#include "lvk/lvk_transform.hpp"
+
+// compares the per object glm chain (GameObject::ModelMatrix) against the batch kernels
+// usage: transform_benchmark [count] [iterations]
+
+template <typename F>
+double measure(size_t iterations, F &&f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 50;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-100.f, 100.f);
+    std::uniform_real_distribution<float> angle(-10.f, 10.f);
+    std::uniform_real_distribution<float> scale(0.1f, 4.f);
+
+    std::vector<glm::vec3> translations(count);
+    std::vector<glm::vec3> rotations(count);
+    std::vector<glm::vec3> scales(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        translations[i] = {position(rng), position(rng), position(rng)};
+        rotations[i] = {angle(rng), angle(rng), angle(rng)};
+        scales[i] = {scale(rng), scale(rng), scale(rng)};
+    }
+
+    std::vector<glm::mat4> reference(count);
+    auto reference_time = measure(iterations, [&]()
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            reference[i] = lvk::Scene::ComposeTransform(translations[i], rotations[i], scales[i]);
+        }
+    });
+    std::cout << fmt::format("{:<8} {:>10.3f} ns/object\n", "glm", reference_time * 1e9 / count);
+
+    bool pass = true;
+    std::vector<glm::mat4> out(count);
+    for (auto kernel : {lvk::TransformKernel::SCALAR, lvk::TransformKernel::SSE, lvk::TransformKernel::AVX2})
+    {
+        if (!lvk::IsTransformKernelSupported(kernel))
+        {
+            std::cout << fmt::format("{:<8} unsupported\n", lvk::TransformKernelName(kernel));
+            continue;
+        }
+
+        auto time = measure(iterations, [&]()
+        {
+            lvk::ComposeTransforms(translations.data(), rotations.data(), scales.data(), out.data(), count, kernel);
+        });
+
+        float max_error = 0.f;
+        for (size_t i = 0; i < count; i++)
+        {
+            float magnitude = std::max({1.f, glm::length(translations[i]), glm::length(scales[i])});
+            for (int c = 0; c < 4; c++)
+            {
+                for (int r = 0; r < 4; r++)
+                {
+                    max_error = std::max(max_error, std::fabs(out[i][c][r] - reference[i][c][r]) / magnitude);
+                }
+            }
+        }
+
+        bool ok = max_error <= lvk::TRANSFORM_TOLERANCE;
+        pass = pass && ok;
+        std::cout << fmt::format("{:<8} {:>10.3f} ns/object {:>6.2f}x  max error {:.3g} {}\n",
+            lvk::TransformKernelName(kernel),
+            time * 1e9 / count,
+            reference_time / time,
+            max_error,
+            ok ? "ok" : "OUT OF TOLERANCE");
+    }
+
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
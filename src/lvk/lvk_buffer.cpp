@@ -69,4 +69,22 @@ void Buffer::UnmapMemory() const
     vmaUnmapMemory(allocator_.get(), allocation_);
 }
 
+void Buffer::FlushMemory(vk::DeviceSize offset, vk::DeviceSize size) const
+{
+    auto result = vmaFlushAllocation(allocator_.get(), allocation_, offset, size);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(fmt::format("vmaFlushAllocation fail result: {}", result));
+    }
+}
+
+void Buffer::InvalidateMemory(vk::DeviceSize offset, vk::DeviceSize size) const
+{
+    auto result = vmaInvalidateAllocation(allocator_.get(), allocation_, offset, size);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(fmt::format("vmaInvalidateAllocation fail result: {}", result));
+    }
+}
+
 }
\ No newline at end of file
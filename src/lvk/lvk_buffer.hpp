@@ -22,6 +22,11 @@ public:
 
     void *MapMemory() const;
     void UnmapMemory() const;
+    void FlushMemory(vk::DeviceSize offset, vk::DeviceSize size) const;
+    void InvalidateMemory(vk::DeviceSize offset, vk::DeviceSize size) const;
+
+    // only valid for buffers created with VMA_ALLOCATION_CREATE_MAPPED_BIT
+    void *GetMappedData() const { return allocation_info_.pMappedData; }
 
     operator vk::Buffer &() { return buffer_; }
     operator const vk::Buffer &() const { return buffer_; }
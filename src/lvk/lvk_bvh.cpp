@@ -0,0 +1,814 @@
+#include "lvk_bvh.hpp"
+
+// module
+#include "lvk_job_system.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+constexpr uint32_t SAH_BIN_COUNT = 16;
+// below this many items a job costs more than it saves
+constexpr uint32_t PARALLEL_BUILD_THRESHOLD = 16 * 1024;
+// bits of the frustum planes a node still has to be tested against
+constexpr uint32_t ALL_PLANES = 0x3f;
+
+Aabb TransformAabb(const Aabb &box, const glm::mat4 &transform)
+{
+    // the extent along each world axis is the sum of the absolute projections (arvo)
+    auto center = glm::vec3(transform * glm::vec4(box.Center(), 1.f));
+    auto half_extent = box.HalfExtent();
+    glm::vec3 world_extent{0.f};
+    for (int c = 0; c < 3; c++)
+    {
+        world_extent += glm::abs(glm::vec3(transform[c])) * half_extent[c];
+    }
+    return Aabb{center - world_extent, center + world_extent};
+}
+
+// slab test, t_enter is clamped to 0 when the origin is inside the box
+static bool IntersectRay(const Aabb &box, const glm::vec3 &origin, const glm::vec3 &inverse_direction, float max_distance, float &t_enter)
+{
+    auto t0 = (box.min - origin) * inverse_direction;
+    auto t1 = (box.max - origin) * inverse_direction;
+    auto t_near = glm::min(t0, t1);
+    auto t_far = glm::max(t0, t1);
+    t_enter = std::max({t_near.x, t_near.y, t_near.z, 0.f});
+    float t_exit = std::min({t_far.x, t_far.y, t_far.z, max_distance});
+    return t_enter <= t_exit;
+}
+
+Bvh::Bvh(float margin) :
+    margin_(margin)
+{}
+
+uint32_t Bvh::AllocateNode()
+{
+    uint32_t node;
+    if (!free_nodes_.empty())
+    {
+        node = free_nodes_.back();
+        free_nodes_.pop_back();
+    }
+    else
+    {
+        node = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[node] = Node{.height = 0};
+    return node;
+}
+
+void Bvh::FreeNode(uint32_t node)
+{
+    nodes_[node] = Node{};
+    free_nodes_.push_back(node);
+}
+
+Bvh::Proxy Bvh::Insert(const Aabb &box, uint32_t user_data)
+{
+    auto leaf = AllocateNode();
+    nodes_[leaf].box = Aabb{box.min - margin_, box.max + margin_};
+    nodes_[leaf].user_data = user_data;
+    InsertLeaf(leaf);
+    leaf_count_++;
+    return leaf;
+}
+
+void Bvh::Remove(Proxy proxy)
+{
+    if (proxy >= nodes_.size() || !nodes_[proxy].IsLeaf() || nodes_[proxy].height != 0)
+    {
+        throw std::runtime_error(fmt::format("bvh proxy {} is not a leaf", proxy));
+    }
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    leaf_count_--;
+}
+
+bool Bvh::Move(Proxy proxy, const Aabb &box)
+{
+    if (nodes_[proxy].box.Contains(box))
+    {
+        return false;
+    }
+
+    RemoveLeaf(proxy);
+    nodes_[proxy].box = Aabb{box.min - margin_, box.max + margin_};
+    InsertLeaf(proxy);
+    return true;
+}
+
+void Bvh::SetBounds(Proxy proxy, const Aabb &box)
+{
+    nodes_[proxy].box = box;
+}
+
+void Bvh::InsertLeaf(uint32_t leaf)
+{
+    if (root_ == NULL_NODE)
+    {
+        root_ = leaf;
+        nodes_[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // descend towards the sibling whose union with the leaf adds the least surface area
+    auto leaf_box = nodes_[leaf].box;
+    auto index = root_;
+    while (!nodes_[index].IsLeaf())
+    {
+        const auto &node = nodes_[index];
+        float area = node.box.SurfaceArea();
+        float combined_area = Aabb::Union(node.box, leaf_box).SurfaceArea();
+
+        // cost of pairing with this node, and the increase every deeper choice pays on top
+        float cost = 2.f * combined_area;
+        float inheritance_cost = 2.f * (combined_area - area);
+        auto child_cost = [&](uint32_t child)
+        {
+            const auto &child_box = nodes_[child].box;
+            float union_area = Aabb::Union(child_box, leaf_box).SurfaceArea();
+            return nodes_[child].IsLeaf() ? union_area + inheritance_cost : union_area - child_box.SurfaceArea() + inheritance_cost;
+        };
+        float left_cost = child_cost(node.left);
+        float right_cost = child_cost(node.right);
+
+        if (cost < left_cost && cost < right_cost)
+        {
+            break;
+        }
+        index = left_cost < right_cost ? node.left : node.right;
+    }
+
+    auto sibling = index;
+    auto old_parent = nodes_[sibling].parent;
+    auto new_parent = AllocateNode();
+    nodes_[new_parent].parent = old_parent;
+    nodes_[new_parent].box = Aabb::Union(leaf_box, nodes_[sibling].box);
+    nodes_[new_parent].height = nodes_[sibling].height + 1;
+    nodes_[new_parent].left = sibling;
+    nodes_[new_parent].right = leaf;
+    nodes_[sibling].parent = new_parent;
+    nodes_[leaf].parent = new_parent;
+
+    if (old_parent == NULL_NODE)
+    {
+        root_ = new_parent;
+    }
+    else if (nodes_[old_parent].left == sibling)
+    {
+        nodes_[old_parent].left = new_parent;
+    }
+    else
+    {
+        nodes_[old_parent].right = new_parent;
+    }
+
+    for (index = nodes_[leaf].parent; index != NULL_NODE; index = nodes_[index].parent)
+    {
+        index = Balance(index);
+        UpdateFromChildren(index);
+    }
+}
+
+void Bvh::RemoveLeaf(uint32_t leaf)
+{
+    if (leaf == root_)
+    {
+        root_ = NULL_NODE;
+        return;
+    }
+
+    auto parent = nodes_[leaf].parent;
+    auto grand_parent = nodes_[parent].parent;
+    auto sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+    FreeNode(parent);
+
+    if (grand_parent == NULL_NODE)
+    {
+        root_ = sibling;
+        nodes_[sibling].parent = NULL_NODE;
+        return;
+    }
+
+    if (nodes_[grand_parent].left == parent)
+    {
+        nodes_[grand_parent].left = sibling;
+    }
+    else
+    {
+        nodes_[grand_parent].right = sibling;
+    }
+    nodes_[sibling].parent = grand_parent;
+
+    for (auto index = grand_parent; index != NULL_NODE; index = nodes_[index].parent)
+    {
+        index = Balance(index);
+        UpdateFromChildren(index);
+    }
+}
+
+void Bvh::UpdateFromChildren(uint32_t node)
+{
+    auto &n = nodes_[node];
+    const auto &left = nodes_[n.left];
+    const auto &right = nodes_[n.right];
+    n.box = Aabb::Union(left.box, right.box);
+    n.height = 1 + std::max(left.height, right.height);
+}
+
+uint32_t Bvh::Balance(uint32_t a)
+{
+    // rotates the taller grandchild up when the children's heights differ by more than one
+    auto &node_a = nodes_[a];
+    if (node_a.IsLeaf() || node_a.height < 2)
+    {
+        return a;
+    }
+
+    auto b = node_a.left;
+    auto c = node_a.right;
+    auto &node_b = nodes_[b];
+    auto &node_c = nodes_[c];
+    int32_t balance = node_c.height - node_b.height;
+
+    auto replace_in_parent = [&](uint32_t old_child, uint32_t new_child)
+    {
+        auto parent = nodes_[new_child].parent;
+        if (parent == NULL_NODE)
+        {
+            root_ = new_child;
+        }
+        else if (nodes_[parent].left == old_child)
+        {
+            nodes_[parent].left = new_child;
+        }
+        else
+        {
+            nodes_[parent].right = new_child;
+        }
+    };
+
+    if (balance > 1)
+    {
+        auto f = node_c.left;
+        auto g = node_c.right;
+        node_c.left = a;
+        node_c.parent = node_a.parent;
+        node_a.parent = c;
+        replace_in_parent(a, c);
+
+        // the taller of f and g stays under c, the other moves under a
+        auto keep = nodes_[f].height > nodes_[g].height ? f : g;
+        auto move = keep == f ? g : f;
+        node_c.right = keep;
+        node_a.right = move;
+        nodes_[move].parent = a;
+        UpdateFromChildren(a);
+        UpdateFromChildren(c);
+        return c;
+    }
+
+    if (balance < -1)
+    {
+        auto d = node_b.left;
+        auto e = node_b.right;
+        node_b.left = a;
+        node_b.parent = node_a.parent;
+        node_a.parent = b;
+        replace_in_parent(a, b);
+
+        auto keep = nodes_[d].height > nodes_[e].height ? d : e;
+        auto move = keep == d ? e : d;
+        node_b.right = keep;
+        node_a.left = move;
+        nodes_[move].parent = a;
+        UpdateFromChildren(a);
+        UpdateFromChildren(b);
+        return b;
+    }
+
+    return a;
+}
+
+void Bvh::Refit()
+{
+    if (root_ == NULL_NODE)
+    {
+        return;
+    }
+
+    // children are visited before their parents in the reversed pre order
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> stack{root_};
+    while (!stack.empty())
+    {
+        auto index = stack.back();
+        stack.pop_back();
+        if (nodes_[index].IsLeaf())
+        {
+            continue;
+        }
+        order.push_back(index);
+        stack.push_back(nodes_[index].left);
+        stack.push_back(nodes_[index].right);
+    }
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        UpdateFromChildren(*it);
+    }
+}
+
+void Bvh::Clear()
+{
+    root_ = NULL_NODE;
+    leaf_count_ = 0;
+    nodes_.clear();
+    free_nodes_.clear();
+}
+
+std::vector<Bvh::Proxy> Bvh::Build(std::span<const Aabb> boxes, std::span<const uint32_t> user_data, JobSystem *jobs)
+{
+    if (boxes.size() != user_data.size())
+    {
+        throw std::runtime_error(fmt::format("bvh build got {} boxes but {} user data", boxes.size(), user_data.size()));
+    }
+
+    Clear();
+    std::vector<Proxy> proxies(boxes.size());
+    nodes_.reserve(boxes.size() * 2);
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        proxies[i] = AllocateNode();
+        nodes_[proxies[i]].box = boxes[i];
+        nodes_[proxies[i]].user_data = user_data[i];
+    }
+    leaf_count_ = boxes.size();
+
+    BuildTopDown(proxies, jobs);
+    return proxies;
+}
+
+void Bvh::Rebuild(JobSystem *jobs)
+{
+    if (root_ == NULL_NODE)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> leaves;
+    leaves.reserve(leaf_count_);
+    AppendLeaves(root_, leaves);
+    for (uint32_t i = 0; i < nodes_.size(); i++)
+    {
+        if (nodes_[i].height > 0)
+        {
+            FreeNode(i);
+        }
+    }
+    BuildTopDown(leaves, jobs);
+}
+
+void Bvh::BuildTopDown(const std::vector<uint32_t> &leaves, JobSystem *jobs)
+{
+    if (leaves.empty())
+    {
+        root_ = NULL_NODE;
+        return;
+    }
+
+    // every internal node is allocated up front, the build jobs only hand them out
+    std::vector<uint32_t> slots(leaves.size() - 1);
+    for (auto &slot : slots)
+    {
+        slot = AllocateNode();
+    }
+
+    std::vector<BuildItem> items(leaves.size());
+    for (size_t i = 0; i < leaves.size(); i++)
+    {
+        const auto &box = nodes_[leaves[i]].box;
+        items[i] = BuildItem{.box = box, .centroid = box.Center(), .leaf = leaves[i]};
+    }
+
+    std::atomic<uint32_t> next_slot{0};
+    root_ = BuildRange(items.data(), static_cast<uint32_t>(items.size()), slots, next_slot, jobs);
+    nodes_[root_].parent = NULL_NODE;
+}
+
+uint32_t Bvh::BuildRange(BuildItem *items, uint32_t count, const std::vector<uint32_t> &slots, std::atomic<uint32_t> &next_slot, JobSystem *jobs)
+{
+    if (count == 1)
+    {
+        return items[0].leaf;
+    }
+
+    auto split = SplitItems(items, count);
+    auto node = slots[next_slot.fetch_add(1, std::memory_order_relaxed)];
+
+    // the halves touch disjoint items and nodes, idle workers steal the left one
+    uint32_t left, right;
+    if (jobs != nullptr && count >= PARALLEL_BUILD_THRESHOLD)
+    {
+        JobCounter left_done;
+        jobs->Run([&]()
+        {
+            left = BuildRange(items, split, slots, next_slot, jobs);
+        }, &left_done);
+        right = BuildRange(items + split, count - split, slots, next_slot, jobs);
+        jobs->Wait(left_done);
+    }
+    else
+    {
+        left = BuildRange(items, split, slots, next_slot, nullptr);
+        right = BuildRange(items + split, count - split, slots, next_slot, nullptr);
+    }
+
+    auto &n = nodes_[node];
+    n.left = left;
+    n.right = right;
+    nodes_[left].parent = node;
+    nodes_[right].parent = node;
+    UpdateFromChildren(node);
+    return node;
+}
+
+uint32_t Bvh::SplitItems(BuildItem *items, uint32_t count)
+{
+    Aabb centroid_bounds{items[0].centroid, items[0].centroid};
+    for (uint32_t i = 1; i < count; i++)
+    {
+        centroid_bounds.min = glm::min(centroid_bounds.min, items[i].centroid);
+        centroid_bounds.max = glm::max(centroid_bounds.max, items[i].centroid);
+    }
+
+    auto extent = centroid_bounds.max - centroid_bounds.min;
+    auto widest = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    auto median_split = [&]()
+    {
+        auto mid = count / 2;
+        std::nth_element(items, items + mid, items + count, [&](const BuildItem &a, const BuildItem &b) { return a.centroid[widest] < b.centroid[widest]; });
+        return mid;
+    };
+
+    if (count <= 2 || extent[widest] <= 0.f)
+    {
+        return median_split();
+    }
+
+    // binned sah, cost of a split is area * count summed over both sides
+    float best_cost = std::numeric_limits<float>::max();
+    int best_axis = -1;
+    uint32_t best_bin = 0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (extent[axis] <= 0.f)
+        {
+            continue;
+        }
+
+        std::array<Aabb, SAH_BIN_COUNT> bin_boxes;
+        std::array<uint32_t, SAH_BIN_COUNT> bin_counts{};
+        float scale = SAH_BIN_COUNT / extent[axis];
+        for (uint32_t i = 0; i < count; i++)
+        {
+            auto bin = std::min(SAH_BIN_COUNT - 1, static_cast<uint32_t>((items[i].centroid[axis] - centroid_bounds.min[axis]) * scale));
+            bin_boxes[bin] = bin_counts[bin] == 0 ? items[i].box : Aabb::Union(bin_boxes[bin], items[i].box);
+            bin_counts[bin]++;
+        }
+
+        // sweep from the right to get the cost of every right side, then from the left
+        std::array<float, SAH_BIN_COUNT> right_costs{};
+        Aabb right_box;
+        uint32_t right_count = 0;
+        for (uint32_t bin = SAH_BIN_COUNT - 1; bin > 0; bin--)
+        {
+            if (bin_counts[bin] > 0)
+            {
+                right_box = right_count == 0 ? bin_boxes[bin] : Aabb::Union(right_box, bin_boxes[bin]);
+                right_count += bin_counts[bin];
+            }
+            right_costs[bin] = right_count > 0 ? right_box.SurfaceArea() * right_count : 0.f;
+        }
+
+        Aabb left_box;
+        uint32_t left_count = 0;
+        for (uint32_t bin = 1; bin < SAH_BIN_COUNT; bin++)
+        {
+            if (bin_counts[bin - 1] > 0)
+            {
+                left_box = left_count == 0 ? bin_boxes[bin - 1] : Aabb::Union(left_box, bin_boxes[bin - 1]);
+                left_count += bin_counts[bin - 1];
+            }
+            if (left_count == 0 || left_count == count)
+            {
+                continue;
+            }
+
+            float cost = left_box.SurfaceArea() * left_count + right_costs[bin];
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = bin;
+            }
+        }
+    }
+
+    if (best_axis < 0)
+    {
+        return median_split();
+    }
+
+    float scale = SAH_BIN_COUNT / extent[best_axis];
+    auto middle = std::partition(items, items + count, [&](const BuildItem &item)
+    {
+        return std::min(SAH_BIN_COUNT - 1, static_cast<uint32_t>((item.centroid[best_axis] - centroid_bounds.min[best_axis]) * scale)) < best_bin;
+    });
+    auto split = static_cast<uint32_t>(middle - items);
+    return split == 0 || split == count ? median_split() : split;
+}
+
+void Bvh::AppendLeaves(uint32_t node, std::vector<uint32_t> &out) const
+{
+    std::vector<uint32_t> stack{node};
+    while (!stack.empty())
+    {
+        auto index = stack.back();
+        stack.pop_back();
+        if (nodes_[index].IsLeaf())
+        {
+            out.push_back(index);
+            continue;
+        }
+        stack.push_back(nodes_[index].left);
+        stack.push_back(nodes_[index].right);
+    }
+}
+
+void Bvh::QueryFrustum(const Frustum &frustum, std::vector<uint32_t> &out) const
+{
+    if (root_ == NULL_NODE)
+    {
+        return;
+    }
+
+    // a node inside a plane has all its children inside it too, so that plane is dropped
+    // from the mask and a node inside every plane reports its whole subtree untested
+    struct Entry
+    {
+        uint32_t node;
+        uint32_t planes;
+    };
+    std::vector<Entry> stack{{root_, ALL_PLANES}};
+    while (!stack.empty())
+    {
+        auto [index, planes] = stack.back();
+        stack.pop_back();
+        const auto &node = nodes_[index];
+        auto center = node.box.Center();
+        auto half_extent = node.box.HalfExtent();
+
+        bool outside = false;
+        for (uint32_t p = 0; p < 6 && !outside; p++)
+        {
+            if (!(planes & (1u << p)))
+            {
+                continue;
+            }
+
+            const auto &plane = frustum.planes[p];
+            auto normal = glm::vec3(plane);
+            float distance = glm::dot(normal, center) + plane.w;
+            float radius = glm::dot(glm::abs(normal), half_extent);
+            outside = distance + radius < 0.f;
+            if (distance - radius >= 0.f)
+            {
+                planes &= ~(1u << p);
+            }
+        }
+        if (outside)
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            out.push_back(node.user_data);
+            continue;
+        }
+        stack.push_back({node.left, planes});
+        stack.push_back({node.right, planes});
+    }
+}
+
+void Bvh::QueryBox(const Aabb &box, std::vector<uint32_t> &out) const
+{
+    if (root_ == NULL_NODE)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> stack{root_};
+    while (!stack.empty())
+    {
+        const auto &node = nodes_[stack.back()];
+        stack.pop_back();
+        if (!node.box.Overlaps(box))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            out.push_back(node.user_data);
+            continue;
+        }
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+}
+
+void Bvh::QueryRay(const glm::vec3 &origin, const glm::vec3 &direction, float max_distance, std::vector<uint32_t> &out) const
+{
+    if (root_ == NULL_NODE)
+    {
+        return;
+    }
+
+    auto inverse_direction = 1.f / direction;
+    std::vector<uint32_t> stack{root_};
+    while (!stack.empty())
+    {
+        const auto &node = nodes_[stack.back()];
+        stack.pop_back();
+        float t_enter;
+        if (!IntersectRay(node.box, origin, inverse_direction, max_distance, t_enter))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            out.push_back(node.user_data);
+            continue;
+        }
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+}
+
+std::optional<RayHit> Bvh::RayCast(const glm::vec3 &origin, const glm::vec3 &direction, float max_distance) const
+{
+    if (root_ == NULL_NODE)
+    {
+        return std::nullopt;
+    }
+
+    auto inverse_direction = 1.f / direction;
+    float t_root;
+    if (!IntersectRay(nodes_[root_].box, origin, inverse_direction, max_distance, t_root))
+    {
+        return std::nullopt;
+    }
+
+    struct Entry
+    {
+        uint32_t node;
+        float t_enter;
+    };
+    std::optional<RayHit> hit;
+    float best = max_distance;
+    std::vector<Entry> stack{{root_, t_root}};
+    while (!stack.empty())
+    {
+        auto [index, t_enter] = stack.back();
+        stack.pop_back();
+        // a closer hit was found after this node was pushed
+        if (t_enter > best)
+        {
+            continue;
+        }
+
+        const auto &node = nodes_[index];
+        if (node.IsLeaf())
+        {
+            best = t_enter;
+            hit = RayHit{.user_data = node.user_data, .distance = t_enter};
+            continue;
+        }
+
+        float t_left, t_right;
+        bool hit_left = IntersectRay(nodes_[node.left].box, origin, inverse_direction, best, t_left);
+        bool hit_right = IntersectRay(nodes_[node.right].box, origin, inverse_direction, best, t_right);
+        // the nearer child goes on top
+        if (hit_left && hit_right && t_left < t_right)
+        {
+            stack.push_back({node.right, t_right});
+            stack.push_back({node.left, t_left});
+            continue;
+        }
+        if (hit_left)
+        {
+            stack.push_back({node.left, t_left});
+        }
+        if (hit_right)
+        {
+            stack.push_back({node.right, t_right});
+        }
+    }
+    return hit;
+}
+
+uint32_t Bvh::GetHeight() const
+{
+    return root_ == NULL_NODE ? 0 : static_cast<uint32_t>(nodes_[root_].height);
+}
+
+float Bvh::ComputeCost() const
+{
+    if (root_ == NULL_NODE)
+    {
+        return 0.f;
+    }
+
+    float area = 0.f;
+    for (const auto &node : nodes_)
+    {
+        if (node.height > 0)
+        {
+            area += node.box.SurfaceArea();
+        }
+    }
+    float root_area = nodes_[root_].box.SurfaceArea();
+    return root_area > 0.f ? area / root_area : 0.f;
+}
+
+void Bvh::Validate() const
+{
+    if (root_ == NULL_NODE)
+    {
+        if (leaf_count_ != 0)
+        {
+            throw std::runtime_error(fmt::format("bvh is empty but counts {} leaves", leaf_count_));
+        }
+        return;
+    }
+
+    if (nodes_[root_].parent != NULL_NODE)
+    {
+        throw std::runtime_error(fmt::format("bvh root {} has a parent", root_));
+    }
+
+    size_t leaves = 0;
+    std::vector<uint32_t> stack{root_};
+    while (!stack.empty())
+    {
+        auto index = stack.back();
+        stack.pop_back();
+        const auto &node = nodes_[index];
+        if (node.IsLeaf())
+        {
+            if (node.height != 0)
+            {
+                throw std::runtime_error(fmt::format("bvh leaf {} has height {}", index, node.height));
+            }
+            leaves++;
+            continue;
+        }
+
+        const auto &left = nodes_[node.left];
+        const auto &right = nodes_[node.right];
+        if (left.parent != index || right.parent != index)
+        {
+            throw std::runtime_error(fmt::format("bvh node {} children don't point back to it", index));
+        }
+        if (node.height != 1 + std::max(left.height, right.height))
+        {
+            throw std::runtime_error(fmt::format("bvh node {} height {} doesn't match its children", index, node.height));
+        }
+        if (!node.box.Contains(left.box) || !node.box.Contains(right.box))
+        {
+            throw std::runtime_error(fmt::format("bvh node {} box doesn't contain its children", index));
+        }
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+
+    if (leaves != leaf_count_)
+    {
+        throw std::runtime_error(fmt::format("bvh reaches {} leaves but counts {}", leaves, leaf_count_));
+    }
+}
+
+}
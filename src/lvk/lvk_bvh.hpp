@@ -0,0 +1,141 @@
+#ifndef _LVK_BVH_H
+#define _LVK_BVH_H
+
+// module
+#include "lvk_culling.hpp"
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+class JobSystem;
+
+struct Aabb
+{
+    glm::vec3 min{0.f};
+    glm::vec3 max{0.f};
+
+    glm::vec3 Center() const { return (min + max) * 0.5f; }
+    glm::vec3 HalfExtent() const { return (max - min) * 0.5f; }
+    float SurfaceArea() const
+    {
+        auto d = max - min;
+        return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+    bool Contains(const Aabb &other) const { return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max)); }
+    bool Overlaps(const Aabb &other) const { return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min)); }
+
+    static Aabb Union(const Aabb &a, const Aabb &b) { return Aabb{glm::min(a.min, b.min), glm::max(a.max, b.max)}; }
+};
+
+// world space box around a local box under an affine transform
+Aabb TransformAabb(const Aabb &box, const glm::mat4 &transform);
+
+struct RayHit
+{
+    uint32_t user_data;
+    // along the ray, to the leaf box not the object itself
+    float distance;
+};
+
+// Dynamic AABB tree with one object per leaf. Incremental inserts pick the sibling
+// with the lowest surface area cost and keep the tree balanced with rotations;
+// Build and Rebuild do a binned SAH build instead, split into jobs for large sets
+// when given a job system. Proxies are leaf node indices, they stay valid until the leaf is removed,
+// including across Move, Refit and Rebuild. Queries report the user data of every
+// leaf whose box passes (typically an Entity index), exact tests are up to the caller.
+class Bvh
+{
+public:
+    using Proxy = uint32_t;
+    static constexpr Proxy NULL_PROXY = std::numeric_limits<uint32_t>::max();
+
+    // boxes passed to Insert and Move are enlarged by margin, so small motions don't restructure the tree
+    explicit Bvh(float margin = 0.1f);
+
+    Proxy Insert(const Aabb &box, uint32_t user_data);
+    void Remove(Proxy proxy);
+    // reinserts the leaf and returns true only when box left its enlarged box
+    bool Move(Proxy proxy, const Aabb &box);
+    // sets the leaf box without touching the tree, call Refit after a batch of these
+    void SetBounds(Proxy proxy, const Aabb &box);
+    // recomputes every internal box bottom up, the structure stays as it is
+    void Refit();
+
+    // replaces the tree with a SAH build over boxes, returns the proxy of every box.
+    // boxes are not enlarged, this is meant for large mostly static sets
+    std::vector<Proxy> Build(std::span<const Aabb> boxes, std::span<const uint32_t> user_data, JobSystem *jobs = nullptr);
+    // SAH build over the current leaves, worth it after many Move or Refit calls degraded the tree
+    void Rebuild(JobSystem *jobs = nullptr);
+    void Clear();
+
+    void QueryFrustum(const Frustum &frustum, std::vector<uint32_t> &out) const;
+    void QueryBox(const Aabb &box, std::vector<uint32_t> &out) const;
+    // every leaf the ray enters within max_distance, direction doesn't need to be normalized
+    void QueryRay(const glm::vec3 &origin, const glm::vec3 &direction, float max_distance, std::vector<uint32_t> &out) const;
+    // the leaf box the ray enters first, nearest first traversal
+    std::optional<RayHit> RayCast(const glm::vec3 &origin, const glm::vec3 &direction, float max_distance) const;
+
+    const Aabb &GetBounds(Proxy proxy) const { return nodes_[proxy].box; }
+    uint32_t GetUserData(Proxy proxy) const { return nodes_[proxy].user_data; }
+    size_t Size() const { return leaf_count_; }
+    uint32_t GetHeight() const;
+    // surface area of all internal nodes relative to the root, lower traverses faster
+    float ComputeCost() const;
+    // throws when links, boxes or heights are inconsistent
+    void Validate() const;
+
+private:
+    static constexpr uint32_t NULL_NODE = NULL_PROXY;
+
+    struct Node
+    {
+        Aabb box;
+        uint32_t parent{NULL_NODE};
+        uint32_t left{NULL_NODE};
+        uint32_t right{NULL_NODE};
+        uint32_t user_data{0};
+        // 0 for leaves, -1 for free nodes
+        int32_t height{-1};
+
+        bool IsLeaf() const { return left == NULL_NODE; }
+    };
+
+    struct BuildItem
+    {
+        Aabb box;
+        glm::vec3 centroid;
+        uint32_t leaf;
+    };
+
+    uint32_t AllocateNode();
+    void FreeNode(uint32_t node);
+    void InsertLeaf(uint32_t leaf);
+    void RemoveLeaf(uint32_t leaf);
+    uint32_t Balance(uint32_t node);
+    void UpdateFromChildren(uint32_t node);
+    void AppendLeaves(uint32_t node, std::vector<uint32_t> &out) const;
+
+    void BuildTopDown(const std::vector<uint32_t> &leaves, JobSystem *jobs);
+    uint32_t BuildRange(BuildItem *items, uint32_t count, const std::vector<uint32_t> &slots, std::atomic<uint32_t> &next_slot, JobSystem *jobs);
+    static uint32_t SplitItems(BuildItem *items, uint32_t count);
+
+private:
+    float margin_;
+    uint32_t root_{NULL_NODE};
+    size_t leaf_count_{0};
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+};
+
+}
+#endif
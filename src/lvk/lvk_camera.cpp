@@ -0,0 +1,65 @@
+#include "lvk_camera.hpp"
+
+// module
+#include "lvk_allocator.hpp"
+
+// std
+#include <cstring>
+
+// glm
+#include <glm/ext.hpp>
+
+namespace lvk
+{
+
+glm::mat4 CameraPose::ViewMatrix() const
+{
+    return glm::lookAt(position, target, up);
+}
+
+glm::mat4 CameraLens::ProjectionMatrix(float aspect_ratio) const
+{
+    return glm::perspective(fov_y, aspect_ratio, near_plane, far_plane);
+}
+
+Camera::Camera(const lvk::Allocator &allocator, const CameraLens &lens) :
+    lens_(lens),
+    buffers_(ConstructBuffers(allocator))
+{}
+
+std::array<std::optional<lvk::Buffer>, MAX_FRAMES_IN_FLIGHT> Camera::ConstructBuffers(const lvk::Allocator &allocator) const
+{
+    VmaAllocationCreateInfo alloc_info{.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, .usage = VMA_MEMORY_USAGE_AUTO};
+    std::array<std::optional<lvk::Buffer>, MAX_FRAMES_IN_FLIGHT> buffers;
+    for (auto &buffer : buffers)
+    {
+        buffer.emplace(
+            allocator,
+            vk::BufferCreateInfo{.size = sizeof(CameraUniform), .usage = vk::BufferUsageFlagBits::eUniformBuffer, .sharingMode = vk::SharingMode::eExclusive},
+            alloc_info);
+    }
+    return buffers;
+}
+
+void Camera::Update(uint32_t frame_index, const CameraPose &pose, vk::Extent2D extent)
+{
+    uniform_.view = pose.ViewMatrix();
+    uniform_.projection = lens_.ProjectionMatrix(extent.width / static_cast<float>(extent.height));
+    uniform_.view_projection = uniform_.projection * uniform_.view;
+
+    auto &buffer = *buffers_[frame_index];
+    std::memcpy(buffer.GetMappedData(), &uniform_, sizeof(uniform_));
+    buffer.FlushMemory(0, VK_WHOLE_SIZE);
+}
+
+vk::DescriptorBufferInfo Camera::GetBufferInfo(uint32_t frame_index) const
+{
+    return vk::DescriptorBufferInfo
+    {
+        .buffer = *buffers_[frame_index],
+        .offset = 0,
+        .range = sizeof(CameraUniform)
+    };
+}
+
+}
@@ -0,0 +1,79 @@
+#ifndef _LVK_CAMERA_H
+#define _LVK_CAMERA_H
+
+// module
+#include "lvk_definitions.hpp"
+#include "lvk_buffer.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <array>
+#include <optional>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+class Allocator;
+
+// where the camera is, part of the simulation state and interpolated like any transform
+struct CameraPose
+{
+    glm::vec3 position{0.f, 0.f, 2.f};
+    glm::vec3 target{0.f, 0.f, 0.f};
+    glm::vec3 up{0.f, -1.f, 0.f};
+
+    glm::mat4 ViewMatrix() const;
+};
+
+struct CameraLens
+{
+    float fov_y{glm::radians(41.f)};
+    float near_plane{0.1f};
+    float far_plane{10.f};
+
+    glm::mat4 ProjectionMatrix(float aspect_ratio) const;
+};
+
+// std140, mirrors the Camera block in shaders/naive/naive.vert
+struct CameraUniform
+{
+    alignas(16) glm::mat4 view{1.0f};
+    alignas(16) glm::mat4 projection{1.0f};
+    alignas(16) glm::mat4 view_projection{1.0f};
+};
+
+// The view of one frame, computed once and read by every draw from a uniform buffer. There
+// is one buffer per frame in flight, Update only writes the one of the frame being prepared.
+class Camera : public boost::noncopyable
+{
+public:
+    explicit Camera(const lvk::Allocator &allocator, const CameraLens &lens = {});
+
+    // the frame's fence must have been waited
+    void Update(uint32_t frame_index, const CameraPose &pose, vk::Extent2D extent);
+
+    void SetLens(const CameraLens &lens) { lens_ = lens; }
+    const CameraLens &GetLens() const { return lens_; }
+    // of the last Update
+    const CameraUniform &GetUniform() const { return uniform_; }
+    // the buffers are never replaced, descriptors can be written once
+    vk::DescriptorBufferInfo GetBufferInfo(uint32_t frame_index) const;
+
+private:
+    std::array<std::optional<lvk::Buffer>, MAX_FRAMES_IN_FLIGHT> ConstructBuffers(const lvk::Allocator &allocator) const;
+
+private:
+    CameraLens lens_;
+    CameraUniform uniform_;
+    std::array<std::optional<lvk::Buffer>, MAX_FRAMES_IN_FLIGHT> buffers_;
+};
+
+}
+#endif
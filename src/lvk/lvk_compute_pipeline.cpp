@@ -0,0 +1,48 @@
+#include "lvk_compute_pipeline.hpp"
+// module
+#include "lvk_hardware.hpp"
+#include "lvk_pipeline_cache.hpp"
+
+namespace lvk
+{
+
+ComputePipeline::ComputePipeline(const lvk::Hardware& hardware,
+                                 const vk::raii::PipelineLayout &pipeline_layout,
+                                 lvk::Shader shader,
+                                 lvk::PipelineCache &pipeline_cache) :
+    pipeline_layout_(pipeline_layout),
+    shader_(std::move(shader)),
+    pipeline_(ConstructPipeline(pipeline_cache))
+{
+}
+
+ComputePipeline::ComputePipeline(ComputePipeline&& other) noexcept :
+    pipeline_layout_(other.pipeline_layout_),
+    shader_(std::move(other.shader_)),
+    pipeline_(std::move(other.pipeline_))
+{}
+
+vk::raii::Pipeline ComputePipeline::ConstructPipeline(lvk::PipelineCache &pipeline_cache)
+{
+    vk::ComputePipelineCreateInfo compute_pipeline_create_info
+    {
+        .stage
+        {
+            .stage = shader_.GetShaderStage(),
+            .module = *shader_.GetShaderModule(),
+            .pName = shader_.GetShaderName().c_str()
+        },
+        .layout = *pipeline_layout_.get(),
+        .basePipelineHandle = nullptr,
+        .basePipelineIndex = -1,
+    };
+
+    return pipeline_cache.CreatePipeline(compute_pipeline_create_info);
+}
+
+void ComputePipeline::BindPipeline(const vk::raii::CommandBuffer &command_buffer) const
+{
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline_);
+}
+
+}// namespace lvk
@@ -0,0 +1,46 @@
+#ifndef _LVK_COMPUTE_PIPELINE_H
+#define _LVK_COMPUTE_PIPELINE_H
+
+// module
+#include "lvk_shader.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+
+namespace lvk
+{
+class Hardware;
+class PipelineCache;
+
+class ComputePipeline : public boost::noncopyable
+{
+public:
+    ComputePipeline(const lvk::Hardware& hardware,
+                    const vk::raii::PipelineLayout &pipeline_layout,
+                    lvk::Shader shader,
+                    lvk::PipelineCache &pipeline_cache);
+
+    ComputePipeline(ComputePipeline&& other) noexcept;
+
+    void BindPipeline(const vk::raii::CommandBuffer &command_buffer) const;
+
+public:
+    const vk::raii::Pipeline &GetPipeline() const { return pipeline_; }
+
+private:
+    vk::raii::Pipeline ConstructPipeline(lvk::PipelineCache &pipeline_cache);
+
+private:
+    std::reference_wrapper<const vk::raii::PipelineLayout> pipeline_layout_;
+    lvk::Shader shader_;
+
+    vk::raii::Pipeline pipeline_;
+};
+
+}// namespace lvk
+#endif
@@ -0,0 +1,158 @@
+#include "lvk_culling.hpp"
+
+// module
+#include "lvk_job_system.hpp"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LVK_CULLING_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace lvk
+{
+
+// below this many spheres a job costs more than it saves
+constexpr uint32_t PARALLEL_CULL_THRESHOLD = 32 * 1024;
+
+Bounds ComputeBounds(const glm::vec3 *positions, size_t count, size_t stride)
+{
+    Bounds bounds;
+    if (count == 0)
+    {
+        return bounds;
+    }
+
+    auto position = [&](size_t i) -> const glm::vec3 &
+    {
+        return *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const std::byte *>(positions) + i * stride);
+    };
+
+    bounds.min = bounds.max = position(0);
+    for (size_t i = 1; i < count; i++)
+    {
+        bounds.min = glm::min(bounds.min, position(i));
+        bounds.max = glm::max(bounds.max, position(i));
+    }
+
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+    float radius_squared = 0.f;
+    for (size_t i = 0; i < count; i++)
+    {
+        auto offset = position(i) - bounds.center;
+        radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+    }
+    bounds.radius = std::sqrt(radius_squared);
+    return bounds;
+}
+
+Frustum ExtractFrustum(const glm::mat4 &view_projection)
+{
+    // rows of the column major matrix (gribb/hartmann)
+    auto row = [&](int r) { return glm::vec4(view_projection[0][r], view_projection[1][r], view_projection[2][r], view_projection[3][r]); };
+
+    Frustum frustum
+    {
+        .planes
+        {
+            row(3) + row(0),
+            row(3) - row(0),
+            row(3) + row(1),
+            row(3) - row(1),
+            // depth is [0, w], not [-w, w]
+            row(2),
+            row(3) - row(2),
+        }
+    };
+
+    for (auto &plane : frustum.planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+void SphereList::Resize(size_t count)
+{
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    radius.resize(count);
+}
+
+static uint32_t CullSpheresRange(const Frustum &frustum, const SphereList &spheres, uint8_t *visible, size_t begin, size_t end)
+{
+    uint32_t visible_count = 0;
+    size_t i = begin;
+
+#ifdef LVK_CULLING_SSE
+    __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    for (int p = 0; p < 6; p++)
+    {
+        plane_x[p] = _mm_set1_ps(frustum.planes[p].x);
+        plane_y[p] = _mm_set1_ps(frustum.planes[p].y);
+        plane_z[p] = _mm_set1_ps(frustum.planes[p].z);
+        plane_w[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+
+    // four spheres per iteration, inside when the signed distance to every plane is > -radius
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&spheres.x[i]);
+        __m128 y = _mm_loadu_ps(&spheres.y[i]);
+        __m128 z = _mm_loadu_ps(&spheres.z[i]);
+        __m128 negative_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, plane_x[p]), _mm_mul_ps(y, plane_y[p])), _mm_add_ps(_mm_mul_ps(z, plane_z[p]), plane_w[p]));
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(distance, negative_radius));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        visible[i + 0] = mask & 1;
+        visible[i + 1] = (mask >> 1) & 1;
+        visible[i + 2] = (mask >> 2) & 1;
+        visible[i + 3] = (mask >> 3) & 1;
+        visible_count += std::popcount(static_cast<unsigned>(mask));
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        bool inside = true;
+        for (const auto &plane : frustum.planes)
+        {
+            inside = inside && plane.x * spheres.x[i] + plane.y * spheres.y[i] + plane.z * spheres.z[i] + plane.w > -spheres.radius[i];
+        }
+        visible[i] = inside;
+        visible_count += inside;
+    }
+    return visible_count;
+}
+
+uint32_t CullSpheres(const Frustum &frustum, const SphereList &spheres, uint8_t *visible, JobSystem *jobs)
+{
+    auto count = static_cast<uint32_t>(spheres.Size());
+    if (jobs == nullptr)
+    {
+        return CullSpheresRange(frustum, spheres, visible, 0, count);
+    }
+
+    std::atomic<uint32_t> visible_count{0};
+    jobs->ParallelFor(0, count, PARALLEL_CULL_THRESHOLD, [&](uint32_t begin, uint32_t end)
+    {
+        visible_count.fetch_add(CullSpheresRange(frustum, spheres, visible, begin, end), std::memory_order_relaxed);
+    });
+    return visible_count.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,62 @@
+#ifndef _LVK_CULLING_H
+#define _LVK_CULLING_H
+
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+class JobSystem;
+
+// object space bounds of a model, computed once at load time
+struct Bounds
+{
+    glm::vec3 min{0.f};
+    glm::vec3 max{0.f};
+    // bounding sphere around the aabb center
+    glm::vec3 center{0.f};
+    float radius{0.f};
+};
+
+// positions may be interleaved with other vertex data, stride is in bytes
+Bounds ComputeBounds(const glm::vec3 *positions, size_t count, size_t stride = sizeof(glm::vec3));
+
+// planes as (normal, distance), normalized and pointing inwards
+struct Frustum
+{
+    std::array<glm::vec4, 6> planes;
+};
+
+// projection * view, clip space depth in [0, 1] (GLM_FORCE_DEPTH_ZERO_TO_ONE)
+Frustum ExtractFrustum(const glm::mat4 &view_projection);
+
+// World space spheres in structure of arrays layout.
+struct SphereList
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> radius;
+
+    void Resize(size_t count);
+    size_t Size() const { return x.size(); }
+};
+
+// writes 1 to visible[i] when sphere i touches the frustum, 0 otherwise, returns the visible count.
+// SSE on x86-64, large lists are split across the job system's threads when one is given.
+uint32_t CullSpheres(const Frustum &frustum, const SphereList &spheres, uint8_t *visible, JobSystem *jobs = nullptr);
+
+struct CullingStats
+{
+    uint32_t visible{0};
+    uint32_t culled{0};
+};
+
+}
+#endif
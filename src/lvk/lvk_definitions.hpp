@@ -32,6 +32,8 @@ constexpr std::string_view EXT_NAME_VK_KHR_shader_non_semantic_info = "VK_KHR_sh
 
 constexpr std::string_view EXT_NAME_VK_KHR_portability_enumeration = "VK_KHR_portability_enumeration";
 
+constexpr std::string_view EXT_NAME_VK_KHR_draw_indirect_count = "VK_KHR_draw_indirect_count";
+
 enum EngineEvent
 {
     eWindowRename = 1,
@@ -43,7 +45,6 @@ struct FrameContext
     const vk::raii::CommandBuffer &command_buffer;
     const vk::raii::Framebuffer &framebuffer;
     const vk::raii::RenderPass &render_pass;
-    const vk::raii::SwapchainKHR &swapchain;
     vk::Extent2D extent;
 };
 
@@ -8,8 +8,22 @@
 #include "lvk_allocator.hpp"
 #include "lvk_vertex.hpp"
 #include "lvk_renderer.hpp"
+#include "lvk_uploader.hpp"
+#include "lvk_geometry_arena.hpp"
 #include "lvk_game_object.hpp"
+#include "lvk_scene.hpp"
 #include "lvk_render_system.hpp"
+#include "lvk_job_system.hpp"
+#include "lvk_mesh_cache.hpp"
+#include "lvk_mesh_file.hpp"
+#include "lvk_mesh_optimizer.hpp"
+#include "lvk_obj_loader.hpp"
+#include "lvk_pipeline_cache.hpp"
+#include "lvk_shader_bundle.hpp"
+#include "lvk_shader_watcher.hpp"
+#include "lvk_scene_snapshot.hpp"
+#include "lvk_gltf_loader.hpp"
+#include "lvk_triple_buffer.hpp"
 #include "sdl2pp/sdl2pp.hpp"
 
 // boost
@@ -19,6 +33,10 @@
 #include <unordered_set>
 #include <thread>
 #include <unordered_map>
+#include <optional>
+#include <chrono>
+#include <filesystem>
+#include <limits>
 
 
 // fmt
@@ -27,6 +45,10 @@
 // glm
 #include <glm/gtc/matrix_transform.hpp>
 
+// set by cmake to the glslc the shaders were built with
+#ifndef LVK_GLSLC_EXECUTABLE
+#define LVK_GLSLC_EXECUTABLE "glslc"
+#endif
 
 
 
@@ -36,15 +58,19 @@ namespace lvk::detail
 class EngineImpl
 {
 public:
-    EngineImpl() :
-        sdl_context_(SDL_INIT_VIDEO | SDL_INIT_AUDIO),
-        window_("Vulkan Engine", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 800, 600, SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_VULKAN),
-        instance_(context_, window_),
-        surface_(instance_, window_),
-        hardware_(instance_, surface_),
+    explicit EngineImpl(const EngineOptions &options) :
+        options_(options),
+        jobs_(options.worker_threads, options.pin_threads ? std::optional<uint32_t>(RENDER_CORE + 1) : std::nullopt),
+        shader_bundle_(options.shader_bundle),
+        sdl_context_(options.headless ? SDL_INIT_EVENTS : SDL_INIT_VIDEO | SDL_INIT_AUDIO),
+        window_(ConstructWindow(options)),
+        instance_(window_ ? lvk::Instance(context_, *window_) : lvk::Instance(context_)),
+        surface_(ConstructSurface()),
+        hardware_(surface_ ? lvk::Hardware(instance_, *surface_, options.device) : lvk::Hardware(instance_, options.device)),
         gpu_allocator_(instance_, hardware_),
-        renderer_(hardware_, surface_, window_),
-        command_pool_(ConstructCommandPool(hardware_)),
+        pipeline_cache_(hardware_, options.pipeline_cache),
+        renderer_(ConstructRenderer()),
+        uploader_(hardware_, gpu_allocator_),
         engine_event_(SDL_RegisterEvents(1))
     {}
 
@@ -52,32 +78,76 @@ public:
 
 private:
     void LoadGameObjects();
+    void ConstructGeometryArena(uint32_t max_vertex_count);
+    void UpdateGameObjects(float delta_time);
+    void RunSimulation();
+    void PublishSnapshot(uint64_t tick, std::chrono::steady_clock::time_point due);
     void RunRender();
-    void DrawFrame(lvk::RenderSystem &render_system, const FrameContext &context);
+    void DrawFrame(lvk::RenderSystem &render_system, lvk::SceneInterpolator &interpolator, const FrameContext &context);
+    void Quit();
+    void SavePipelineCache();
+    static void PinThread(const char *name, uint32_t core);
 
-    vk::raii::CommandPool ConstructCommandPool(const lvk::Hardware &hardware)
+    static std::optional<lvk::SDLWindow> ConstructWindow(const EngineOptions &options)
     {
-        vk::CommandPoolCreateInfo command_pool_create_info
+        if (options.headless)
         {
-            .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer, 
-            .queueFamilyIndex = hardware.GetQueueIndex(Hardware::QueueType::GRAPHICS).value(),
-        };
-        return vk::raii::CommandPool(hardware.GetDevice(), command_pool_create_info);
+            return std::nullopt;
+        }
+        return std::optional<lvk::SDLWindow>(std::in_place, "Vulkan Engine", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, options.width, options.height, SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_VULKAN);
+    }
+
+    std::optional<lvk::Surface> ConstructSurface()
+    {
+        if (!window_)
+        {
+            return std::nullopt;
+        }
+        return std::optional<lvk::Surface>(std::in_place, instance_, *window_);
+    }
+
+    lvk::Renderer ConstructRenderer()
+    {
+        if (!surface_)
+        {
+            return lvk::Renderer(hardware_, gpu_allocator_, vk::Extent2D{options_.width, options_.height});
+        }
+        return lvk::Renderer(hardware_, *surface_, *window_);
     }
 
 private:
+    static constexpr uint32_t EVENT_CORE = 0;
+    static constexpr uint32_t RENDER_CORE = 1;
+    // a simulation further behind than this skips ahead instead of catching up
+    static constexpr int MAX_CATCH_UP_STEPS = 8;
+    // pipelines compiled later on reach the disk even if the process doesn't exit cleanly
+    static constexpr std::chrono::seconds PIPELINE_CACHE_SAVE_INTERVAL{60};
+
+    EngineOptions options_;
+    lvk::JobSystem jobs_;
+    lvk::ShaderBundle shader_bundle_;
     vk::raii::Context context_;
     lvk::SDLContext sdl_context_;
-    lvk::SDLWindow window_;
+    std::optional<lvk::SDLWindow> window_;
     lvk::Instance instance_;
-    lvk::Surface surface_;
+    std::optional<lvk::Surface> surface_;
     lvk::Hardware hardware_;
     lvk::Allocator gpu_allocator_;
+    lvk::PipelineCache pipeline_cache_;
     lvk::Renderer renderer_;
-    vk::raii::CommandPool command_pool_;
+    lvk::Uploader uploader_;
+    // constructed once LoadGameObjects knows the largest model, it decides the index type
+    std::optional<lvk::GeometryArena> geometry_arena_;
+    // owned by the simulation thread once it runs, the render thread only sees snapshots
+    lvk::Scene scene_;
     std::vector<lvk::GameObject> game_objects_;
+    lvk::CameraPose camera_;
+    lvk::TransformState previous_state_;
+    lvk::TripleBuffer<lvk::SceneSnapshot> snapshots_;
     uint32_t engine_event_;
     std::atomic<bool> quit_{false};
+    // toggled with F2, the first toggle compiles the variant while the solid one keeps drawing
+    std::atomic<bool> wireframe_{false};
 };
 
 void EngineImplDeleter::operator()(EngineImpl *ptr)
@@ -85,12 +155,30 @@ void EngineImplDeleter::operator()(EngineImpl *ptr)
     delete ptr;
 }
 
+void EngineImpl::PinThread(const char *name, uint32_t core)
+{
+    if (!lvk::JobSystem::PinCurrentThread(core))
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("failed to pin the {} thread to core {}", name, core);
+    }
+}
+
 void EngineImpl::Run()
 {
+    if (options_.pin_threads)
+    {
+        PinThread("event", EVENT_CORE);
+    }
 
     LoadGameObjects();
-    window_.Show();
+    if (window_)
+    {
+        window_->Show();
+    }
 
+    // the first frame already has something to draw
+    PublishSnapshot(0, std::chrono::steady_clock::now());
+    std::thread simulation_thread([this](){RunSimulation();});
     std::thread render_thread([this](){RunRender();});
     SDL_Event event;
     while (!quit_)
@@ -103,11 +191,16 @@ void EngineImpl::Run()
         else if(event.type == SDL_WINDOWEVENT)
         {
         }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F2 && !event.key.repeat)
+        {
+            wireframe_ = !wireframe_;
+        }
         else if (event.type == engine_event_)
         {
         }
     }
     render_thread.join();
+    simulation_thread.join();
 }
 
 void EngineImpl::LoadGameObjects()
@@ -167,49 +260,250 @@ void EngineImpl::LoadGameObjects()
         20, 21, 22, 22, 23, 20
     };
 
-    game_objects_.emplace_back(MakeGameObject(std::make_shared<lvk::Model>(Model::FromIndex(hardware_, gpu_allocator_, command_pool_, cube_vertices, cube_indices))));
+    // everything is read before the arena exists, the largest model decides its index type
+    auto extension = std::filesystem::path(options_.model).extension();
+    bool gltf = extension == ".glb" || extension == ".gltf";
+    std::optional<lvk::MeshFile> mesh_file;
+    std::optional<lvk::MeshData> obj_mesh;
+    auto max_vertex_count = static_cast<uint32_t>(cube_vertices.size());
+    if (gltf)
+    {
+        max_vertex_count = lvk::GetGltfMaxMeshVertexCount(options_.model);
+    }
+    else if (!options_.model.empty() && (extension == ".lvkmesh" || !options_.mesh_cache.empty()))
+    {
+        // the cache hands out the file it validated, mapping it again would scan every index twice
+        mesh_file.emplace(extension == ".lvkmesh" ? lvk::MeshFile(options_.model) : lvk::MeshCache(options_.mesh_cache, &jobs_).Get(options_.model));
+        max_vertex_count = static_cast<uint32_t>(mesh_file->GetVertices().size());
+    }
+    else if (!options_.model.empty())
+    {
+        obj_mesh = lvk::LoadObj(options_.model, &jobs_);
+        lvk::OptimizeMesh(*obj_mesh);
+        max_vertex_count = static_cast<uint32_t>(obj_mesh->vertices.size());
+    }
+    ConstructGeometryArena(max_vertex_count);
+
+    if (options_.model.empty())
+    {
+        auto cube = MakeGameObject(scene_, std::make_shared<lvk::Model>(Model::FromIndex(*geometry_arena_, uploader_, cube_vertices, cube_indices)));
+        cube.SetScale({0.5f, 0.5f, 0.5f});
+        cube.SetTranslation({0.f, 0.2f, 0.f});
+        game_objects_.push_back(cube);
+    }
+    else
+    {
+        // spins where the cube did, the pivot moves the content's center onto the root
+        auto root = MakeGameObject(scene_, nullptr);
+        auto pivot = MakeGameObject(scene_, nullptr, root.GetEntity());
+        if (gltf)
+        {
+            lvk::InstantiateGltf(scene_, lvk::LoadGltf(options_.model, *geometry_arena_, uploader_), pivot.GetEntity());
+        }
+        else if (mesh_file)
+        {
+            MakeGameObject(scene_, std::make_shared<lvk::Model>(Model::FromMeshFile(*geometry_arena_, uploader_, *mesh_file, options_.mesh_lod)), pivot.GetEntity());
+        }
+        else
+        {
+            MakeGameObject(scene_, std::make_shared<lvk::Model>(Model::FromIndex(*geometry_arena_, uploader_, obj_mesh->vertices, obj_mesh->indices)), pivot.GetEntity());
+        }
+
+        // scaled to the same bounding sphere as the cube
+        scene_.UpdateWorldMatrices();
+        glm::vec3 min(std::numeric_limits<float>::max());
+        glm::vec3 max(std::numeric_limits<float>::lowest());
+        auto models = scene_.GetModels();
+        auto world_matrices = scene_.GetWorldMatrices();
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            if (models[i] == nullptr)
+            {
+                continue;
+            }
+            const auto &bounds = models[i]->GetBounds();
+            for (int corner = 0; corner < 8; corner++)
+            {
+                glm::vec3 local((corner & 1) ? bounds.max.x : bounds.min.x, (corner & 2) ? bounds.max.y : bounds.min.y, (corner & 4) ? bounds.max.z : bounds.min.z);
+                auto world = glm::vec3(world_matrices[i] * glm::vec4(local, 1.f));
+                min = glm::min(min, world);
+                max = glm::max(max, world);
+            }
+        }
+        auto radius = min.x <= max.x ? glm::length(max - min) * 0.5f : 0.f;
+        pivot.SetTranslation(radius > 0.f ? -(min + max) * 0.5f : glm::vec3(0.f));
+        root.SetScale(glm::vec3(radius > 0.f ? 0.433f / radius : 1.f));
+        root.SetTranslation({0.f, 0.2f, 0.f});
+        game_objects_.push_back(root);
+    }
+    uploader_.Flush();
+    scene_.UpdateWorldMatrices(&jobs_);
+}
+
+void EngineImpl::ConstructGeometryArena(uint32_t max_vertex_count)
+{
+    auto index_type = vk::IndexType::eUint32;
+    if (options_.short_indices)
+    {
+        if (max_vertex_count <= lvk::GeometryArena::GetMaxVertexCount(vk::IndexType::eUint16))
+        {
+            index_type = vk::IndexType::eUint16;
+        }
+        else
+        {
+            // one arena holds every model, a single large one keeps all of them at 32 bit
+            BOOST_LOG_TRIVIAL(warning) << fmt::format("--short-indices: the largest model has {} vertices, more than 16 bit indices address, using 32 bit indices", max_vertex_count);
+        }
+    }
+    geometry_arena_.emplace(hardware_, gpu_allocator_, options_.packed_vertices ? VertexFormat::PACKED : VertexFormat::FULL, index_type);
+}
+
+void EngineImpl::UpdateGameObjects(float delta_time)
+{
+    // 6 degrees per second around x and y
+    auto spin = glm::radians(-6.f) * delta_time;
+    for (auto &object : game_objects_)
+    {
+        auto rotation = object.GetRotation();
+        rotation.y = glm::mod(rotation.y + spin, glm::two_pi<float>());
+        rotation.x = glm::mod(rotation.x + spin, glm::two_pi<float>());
+        object.SetRotation(rotation);
+    }
+
+    // only the animated objects and their children are recomputed
+    scene_.UpdateWorldMatrices(&jobs_);
+}
+
+void EngineImpl::RunSimulation()
+{
+    auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / options_.tick_rate));
+    auto due = std::chrono::steady_clock::now();
+    uint64_t tick = 0;
+    while (!quit_)
+    {
+        due += step;
+        std::this_thread::sleep_until(due);
+
+        // late steps run back to back to catch up, but after a long stall the lost time is dropped
+        auto now = std::chrono::steady_clock::now();
+        if (now - due > MAX_CATCH_UP_STEPS * step)
+        {
+            due = now;
+        }
+
+        previous_state_.Capture(scene_, camera_);
+        UpdateGameObjects(std::chrono::duration<float>(step).count());
+        PublishSnapshot(++tick, due);
+    }
+}
+
+void EngineImpl::PublishSnapshot(uint64_t tick, std::chrono::steady_clock::time_point due)
+{
+    auto step = std::chrono::duration<double>(1.0 / options_.tick_rate);
+    snapshots_.Back().Capture(scene_, previous_state_, camera_, tick, due, step);
+    snapshots_.Publish();
 }
 
 void EngineImpl::RunRender()
 {
-    lvk::RenderSystem render_system(hardware_, renderer_.GetRenderPass());
+    if (options_.pin_threads)
+    {
+        PinThread("render", RENDER_CORE);
+    }
+
+    lvk::RenderSystem render_system(hardware_, gpu_allocator_, *geometry_arena_, renderer_.GetRenderPass(), shader_bundle_, pipeline_cache_, jobs_, options_.gpu_culling, options_.record_threads);
+    lvk::SceneInterpolator interpolator;
+    pipeline_cache_.LogStats();
+    SavePipelineCache();
+
+    std::optional<lvk::ShaderWatcher> shader_watcher;
+    if (!options_.watch_shaders.empty())
+    {
+        shader_watcher.emplace(options_.watch_shaders, LVK_GLSLC_EXECUTABLE);
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto last_cache_save = start_time;
     while(!quit_)
     {
+        if (shader_watcher)
+        {
+            render_system.ReloadShaders(shader_watcher->TakeCompiled());
+        }
+        render_system.SetPipelineDesc({.polygon_mode = wireframe_ ? vk::PolygonMode::eLine : vk::PolygonMode::eFill});
+
         using namespace std::placeholders;
-        renderer_.DrawFrame(std::bind(&EngineImpl::DrawFrame, this, std::ref(render_system), _1));
+        renderer_.DrawFrame(std::bind(&EngineImpl::DrawFrame, this, std::ref(render_system), std::ref(interpolator), _1));
+
+        if (std::chrono::steady_clock::now() - last_cache_save > PIPELINE_CACHE_SAVE_INTERVAL)
+        {
+            SavePipelineCache();
+            last_cache_save = std::chrono::steady_clock::now();
+        }
+
+        if (options_.max_frames > 0 && renderer_.GetFrameCounter() >= options_.max_frames)
+        {
+            Quit();
+        }
     }
     hardware_.GetDevice().waitIdle();
+    SavePipelineCache();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    auto frames = renderer_.GetFrameCounter();
+    BOOST_LOG_TRIVIAL(info) << fmt::format("{} rendered {} frames in {:.3f}s, {:.3f} ms/frame, {:.1f} fps",
+        renderer_.IsHeadless() ? "headless" : "window",
+        frames,
+        elapsed.count(),
+        frames > 0 ? elapsed.count() * 1000.0 / frames : 0.0,
+        elapsed.count() > 0 ? frames / elapsed.count() : 0.0);
+    BOOST_LOG_TRIVIAL(info) << fmt::format("last frame culling: {} visible, {} culled", render_system.GetCullingStats().visible, render_system.GetCullingStats().culled);
+}
+
+void EngineImpl::SavePipelineCache()
+{
+    // losing the cache only costs the next start some time, it is no reason to stop
+    try
+    {
+        pipeline_cache_.Save();
+    }
+    catch (const std::exception &e)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("failed to save the pipeline cache: {}", e.what());
+    }
 }
 
-void EngineImpl::DrawFrame(lvk::RenderSystem &render_system, const FrameContext &context)
+void EngineImpl::Quit()
+{
+    quit_ = true;
+
+    // wake up the event loop which may be blocked in WaitEvent
+    SDL_Event event{};
+    event.type = SDL_QUIT;
+    SDL_PushEvent(&event);
+}
+
+void EngineImpl::DrawFrame(lvk::RenderSystem &render_system, lvk::SceneInterpolator &interpolator, const FrameContext &context)
 {
     context.command_buffer.reset();
     context.command_buffer.begin({});
 
+    // the frame fence was waited, ranges freed MAX_FRAMES_IN_FLIGHT frames ago are reusable
+    geometry_arena_->NextFrame();
+
+    // viewport and scissor are dynamic state of the secondary command buffers drawing into the pass
     auto window_extent = context.extent;
-    auto &render_pass = context.render_pass;
-    // set viewport
-    vk::Viewport viewport
-    {
-        .x = 0,
-        .y = 0,
-        .width = static_cast<float>(window_extent.width),
-        .height = static_cast<float>(window_extent.height),
-        .minDepth = 0.0f,
-        .maxDepth = 1.0f
-    };
-    vk::ArrayProxy<const vk::Viewport> viewports(viewport);
-    context.command_buffer.setViewport(0, viewports);
 
-    // set scissor
-    vk::Rect2D scissor
-    {
-        .offset = {0, 0},
-        .extent = window_extent,
-    };
+    // pick up finished uploads before any draw may use them
+    uploader_.Acquire(context.command_buffer);
+
+    // the newest simulation step, interpolated towards now. Never waits for the simulation
+    snapshots_.Acquire();
+    const auto &snapshot = snapshots_.Front();
+    const auto &scene = interpolator.Apply(snapshot, snapshot.InterpolationFactor(std::chrono::steady_clock::now()), &jobs_);
 
-    vk::ArrayProxy<const vk::Rect2D> scissors(scissor);
-    context.command_buffer.setScissor(0, scissors);
+    // culling may record compute work, which has to happen before the render pass begins
+    render_system.PrepareFrame(context, scene, interpolator.GetCamera());
 
     // begin renderpass
     vk::ClearColorValue clear_color(std::array<float, 4>{0.1f, 0.1f, 0.1f, 1.0f});
@@ -228,9 +522,10 @@ void EngineImpl::DrawFrame(lvk::RenderSystem &render_system, const FrameContext
         .pClearValues = &clear_value
     };
 
-    context.command_buffer.beginRenderPass(render_pass_begin_info, vk::SubpassContents::eInline);
+    // every draw is recorded into secondary command buffers by the render system
+    context.command_buffer.beginRenderPass(render_pass_begin_info, vk::SubpassContents::eSecondaryCommandBuffers);
 
-    render_system.RenderObjects(context, game_objects_);
+    render_system.RenderObjects(context);
 
     context.command_buffer.endRenderPass();
 
@@ -241,7 +536,11 @@ void EngineImpl::DrawFrame(lvk::RenderSystem &render_system, const FrameContext
 
 namespace lvk
 {
-Engine::Engine() : impl_(new detail::EngineImpl)
+Engine::Engine() : Engine(EngineOptions{})
+{
+}
+
+Engine::Engine(const EngineOptions &options) : impl_(new detail::EngineImpl(options))
 {
     static auto last_frame_time = std::chrono::high_resolution_clock::now();
 }
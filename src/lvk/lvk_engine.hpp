@@ -6,9 +6,50 @@
 
 // std
 #include <memory>
+#include <cstdint>
+#include <string>
 
 namespace lvk
 {
+
+struct EngineOptions
+{
+    // render into offscreen images without creating any SDL window, surface or swapchain
+    bool headless{false};
+    uint32_t width{800};
+    uint32_t height{600};
+    // stop after this many frames, 0 means run until quit
+    uint64_t max_frames{0};
+    // pick the gpu whose name contains this string or whose uuid equals it, empty picks the highest scored one
+    std::string device;
+    // cull and compact draws in a compute pass, falls back to the cpu when unsupported
+    bool gpu_culling{true};
+    // most chunks of draws recorded into secondary command buffers at once, 0 picks one per job thread
+    uint32_t record_threads{0};
+    // job system workers, 0 picks one per core minus the render thread
+    uint32_t worker_threads{0};
+    // fixed simulation steps per second, rendering interpolates between the last two
+    uint32_t tick_rate{60};
+    // vulkan pipeline cache kept across runs, empty keeps it in memory only
+    std::string pipeline_cache{"pipeline_cache.bin"};
+    // shader bundle replacing embedded shaders of the same name, written by shaderpack, empty uses the embedded ones only
+    std::string shader_bundle;
+    // glsl source directory to watch, changed shaders are recompiled and swapped in while running, empty disables it
+    std::string watch_shaders;
+    // .obj, .lvkmesh, .glb or .gltf file shown instead of the cube, scaled to the cube's size
+    std::string model;
+    // .obj models are converted to .lvkmesh in this directory once and uploaded from there until they change, empty loads them directly
+    std::string mesh_cache{"mesh_cache"};
+    // lod of an .lvkmesh model to draw, past the coarsest one draws the coarsest
+    uint32_t mesh_lod{0};
+    // store vertices as half float positions and unorm8 colors, 12 instead of 24 bytes each
+    bool packed_vertices{false};
+    // 16 bit indices when every model has at most 65536 vertices, 32 bit otherwise
+    bool short_indices{false};
+    // pin the event loop to core 0, the render thread to core 1 and the workers to the following ones
+    bool pin_threads{false};
+};
+
 namespace detail
 {
 
@@ -24,6 +65,7 @@ class Engine : public boost::noncopyable
 {
 public:
     Engine();
+    explicit Engine(const EngineOptions &options);
 
 public:
     void Run();
@@ -3,6 +3,7 @@
 
 // module
 #include "lvk_model.hpp"
+#include "lvk_scene.hpp"
 
 // GLM
 #include <glm/glm.hpp>
@@ -10,36 +11,44 @@
 namespace lvk
 {
 
-
-class GameObject : public boost::noncopyable
+// Thin handle over a Scene entity, the components live in the scene's arrays.
+// Cheap to copy, prefer iterating the scene directly for bulk work.
+class GameObject
 {
 public:
 
-    GameObject(size_t id, std::shared_ptr<lvk::Model> model);
-    GameObject(GameObject &&other) noexcept;
+    GameObject(lvk::Scene &scene, lvk::Scene::Entity entity);
+
+    lvk::Scene::Entity GetEntity() const { return entity_; }
+    bool IsAlive() const { return scene_->IsAlive(entity_); }
 
-    const std::shared_ptr<lvk::Model> &GetModel() const { return model_; }
+    const lvk::Model *GetModel() const { return scene_->GetModels()[Index()]; }
+    // local transform, relative to the parent
     glm::mat4 ModelMatrix() const;
+    // as of the last Scene::UpdateWorldMatrices
+    const glm::mat4 &WorldMatrix() const { return scene_->GetWorldMatrices()[Index()]; }
 
-    glm::vec3 GetTranslation() const { return translation_; }
-    void SetTranslation(const glm::vec3 &translation) { translation_ = translation; }
+    glm::vec3 GetTranslation() const { return scene_->GetTranslations()[Index()]; }
+    void SetTranslation(const glm::vec3 &translation) { scene_->SetTranslation(entity_, translation); }
 
-    glm::vec3 GetScale() const { return scale_; }
-    void SetScale(const glm::vec3 &scale) { scale_ = scale; }
+    glm::vec3 GetScale() const { return scene_->GetScales()[Index()]; }
+    void SetScale(const glm::vec3 &scale) { scene_->SetScale(entity_, scale); }
 
-    glm::vec3 GetRotation() const { return rotation_; }
-    void SetRotation(const glm::vec3 &rotation) { rotation_ = rotation; }
+    glm::vec3 GetRotation() const { return scene_->GetRotations()[Index()]; }
+    void SetRotation(const glm::vec3 &rotation) { scene_->SetRotation(entity_, rotation); }
 
+    lvk::Scene::Entity GetParent() const { return scene_->GetParent(entity_); }
+    void SetParent(const GameObject &parent) { scene_->SetParent(entity_, parent.entity_); }
+
+private:
+    uint32_t Index() const { return scene_->GetDenseIndex(entity_); }
 
 private:
-    size_t id_;
-    std::shared_ptr<lvk::Model> model_;
-    glm::vec3 translation_{0.f, 0.f, 0.5f};
-    glm::vec3 scale_{1.f, 1.f, 1.f};
-    glm::vec3 rotation_{0.f, 0.f, 0.f};
+    lvk::Scene *scene_;
+    lvk::Scene::Entity entity_;
 };
 
-GameObject MakeGameObject(std::shared_ptr<lvk::Model> model);
+GameObject MakeGameObject(lvk::Scene &scene, std::shared_ptr<lvk::Model> model, lvk::Scene::Entity parent = {});
 
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,150 @@
+#include "lvk_geometry_arena.hpp"
+
+// module
+#include "lvk_hardware.hpp"
+#include "lvk_allocator.hpp"
+#include "lvk_vertex.hpp"
+
+// std
+#include <limits>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+GeometryArena::GeometryArena(const lvk::Hardware &hardware,
+                             const lvk::Allocator &allocator,
+                             lvk::VertexFormat vertex_format,
+                             vk::IndexType index_type,
+                             uint32_t vertex_capacity,
+                             uint32_t index_capacity) :
+    hardware_(&hardware),
+    allocator_(&allocator),
+    vertex_format_(vertex_format),
+    index_type_(index_type),
+    vertex_stride_(GetVertexInput(vertex_format).stride),
+    index_size_(lvk::GetIndexSize(index_type)),
+    vertex_ranges_(vertex_capacity),
+    index_ranges_(index_capacity),
+    vertex_buffer_(ConstructBuffer(vertex_capacity, vertex_stride_, vk::BufferUsageFlagBits::eVertexBuffer)),
+    index_buffer_(ConstructBuffer(index_capacity, index_size_, vk::BufferUsageFlagBits::eIndexBuffer))
+{}
+
+lvk::Buffer GeometryArena::ConstructBuffer(uint32_t capacity, vk::DeviceSize element_size, vk::BufferUsageFlags usage)
+{
+    return lvk::Buffer(
+        *allocator_,
+        {.size = capacity * element_size, .usage = usage | vk::BufferUsageFlagBits::eTransferDst, .sharingMode = vk::SharingMode::eExclusive},
+        {.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE});
+}
+
+uint32_t GeometryArena::GetMaxVertexCount(vk::IndexType index_type)
+{
+    return index_type == vk::IndexType::eUint16 ? 1u << 16 : std::numeric_limits<uint32_t>::max();
+}
+
+GeometryArena::Handle GeometryArena::Allocate(uint32_t vertex_count, uint32_t index_count)
+{
+    // indices are relative to the model's first vertex
+    if (index_count > 0 && vertex_count > GetMaxVertexCount(index_type_))
+    {
+        throw std::runtime_error(fmt::format("geometry arena uses 16 bit indices, which address 65536 vertices, request: {}", vertex_count));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Range range{.vertex_count = vertex_count, .index_count = index_count};
+    if (vertex_count > 0)
+    {
+        auto first_vertex = vertex_ranges_.Allocate(vertex_count);
+        if (!first_vertex)
+        {
+            throw std::runtime_error(fmt::format("geometry arena out of vertex space, request: {} used: {} largest free: {}", vertex_count, vertex_ranges_.GetUsed(), vertex_ranges_.GetLargestFreeBlock()));
+        }
+        range.first_vertex = *first_vertex;
+    }
+
+    if (index_count > 0)
+    {
+        auto first_index = index_ranges_.Allocate(index_count);
+        if (!first_index)
+        {
+            if (vertex_count > 0)
+            {
+                vertex_ranges_.Free(range.first_vertex);
+            }
+            throw std::runtime_error(fmt::format("geometry arena out of index space, request: {} used: {} largest free: {}", index_count, index_ranges_.GetUsed(), index_ranges_.GetLargestFreeBlock()));
+        }
+        range.first_index = *first_index;
+    }
+
+    Handle handle;
+    if (!free_slots_.empty())
+    {
+        handle = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(slots_.size());
+        slots_.emplace_back();
+    }
+
+    slots_[handle] = Slot{.range = range, .live = true};
+    return handle;
+}
+
+void GeometryArena::Free(Handle handle)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // frames in flight may still read the range
+    retired_[retire_index_].push_back(handle);
+}
+
+GeometryArena::Range GeometryArena::GetRange(Handle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_.at(handle).range;
+}
+
+void GeometryArena::NextFrame()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    retire_index_ = (retire_index_ + 1) % retired_.size();
+    for (auto handle : retired_[retire_index_])
+    {
+        ReleaseSlot(handle);
+    }
+    retired_[retire_index_].clear();
+}
+
+void GeometryArena::ReleaseSlot(Handle handle)
+{
+    auto &slot = slots_[handle];
+    if (slot.range.vertex_count > 0)
+    {
+        vertex_ranges_.Free(slot.range.first_vertex);
+    }
+    if (slot.range.index_count > 0)
+    {
+        index_ranges_.Free(slot.range.first_index);
+    }
+    slot = Slot{};
+    free_slots_.push_back(handle);
+}
+
+void GeometryArena::BindBuffers(const vk::raii::CommandBuffer &command_buffer) const
+{
+    uint64_t offset = 0;
+    vk::ArrayProxy<const vk::Buffer> buffers(vertex_buffer_);
+    vk::ArrayProxy<vk::DeviceSize> offsets(offset);
+    command_buffer.bindVertexBuffers(0, buffers, offsets);
+    command_buffer.bindIndexBuffer(index_buffer_, 0, index_type_);
+}
+
+}
@@ -0,0 +1,104 @@
+#ifndef _LVK_GEOMETRY_ARENA_H
+#define _LVK_GEOMETRY_ARENA_H
+
+// module
+#include "lvk_definitions.hpp"
+#include "lvk_buffer.hpp"
+#include "lvk_range_allocator.hpp"
+#include "lvk_vertex.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <array>
+#include <mutex>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace lvk
+{
+class Hardware;
+class Allocator;
+
+// One device local vertex buffer and one index buffer shared by every model.
+// Models own a Handle to a range inside them and draw with vertexOffset/firstIndex,
+// so the whole scene binds geometry once. Every model is stored in the arena's vertex
+// format and index type, with 16 bit indices models are limited to 65536 vertices.
+class GeometryArena : public boost::noncopyable
+{
+public:
+    using Handle = uint32_t;
+
+    struct Range
+    {
+        uint32_t first_vertex{0};
+        uint32_t vertex_count{0};
+        uint32_t first_index{0};
+        uint32_t index_count{0};
+    };
+
+    GeometryArena(const lvk::Hardware &hardware,
+                  const lvk::Allocator &allocator,
+                  lvk::VertexFormat vertex_format = lvk::VertexFormat::FULL,
+                  vk::IndexType index_type = vk::IndexType::eUint32,
+                  uint32_t vertex_capacity = 1 << 20,
+                  uint32_t index_capacity = 1 << 22);
+
+    // throws when out of space or vertex_count is too large for the index type
+    Handle Allocate(uint32_t vertex_count, uint32_t index_count);
+    // the range stays valid until MAX_FRAMES_IN_FLIGHT more frames have started
+    void Free(Handle handle);
+    Range GetRange(Handle handle) const;
+
+    // call once per frame after the frame fence was waited
+    void NextFrame();
+
+    void BindBuffers(const vk::raii::CommandBuffer &command_buffer) const;
+
+    const lvk::Buffer &GetVertexBuffer() const { return vertex_buffer_; }
+    const lvk::Buffer &GetIndexBuffer() const { return index_buffer_; }
+    lvk::VertexFormat GetVertexFormat() const { return vertex_format_; }
+    vk::IndexType GetIndexType() const { return index_type_; }
+    // bytes per vertex and per index
+    vk::DeviceSize GetVertexStride() const { return vertex_stride_; }
+    vk::DeviceSize GetIndexSize() const { return index_size_; }
+
+    // largest indexed model an arena with this index type takes
+    static uint32_t GetMaxVertexCount(vk::IndexType index_type);
+
+private:
+    struct Slot
+    {
+        Range range;
+        bool live{false};
+    };
+
+    lvk::Buffer ConstructBuffer(uint32_t capacity, vk::DeviceSize element_size, vk::BufferUsageFlags usage);
+    void ReleaseSlot(Handle handle);
+
+private:
+    const lvk::Hardware *hardware_;
+    const lvk::Allocator *allocator_;
+    lvk::VertexFormat vertex_format_;
+    vk::IndexType index_type_;
+    vk::DeviceSize vertex_stride_;
+    vk::DeviceSize index_size_;
+
+    mutable std::mutex mutex_;
+    RangeAllocator vertex_ranges_;
+    RangeAllocator index_ranges_;
+    lvk::Buffer vertex_buffer_;
+    lvk::Buffer index_buffer_;
+
+    std::vector<Slot> slots_;
+    std::vector<Handle> free_slots_;
+    std::array<std::vector<Handle>, MAX_FRAMES_IN_FLIGHT + 1> retired_;
+    size_t retire_index_{0};
+};
+
+}
+#endif
@@ -0,0 +1,829 @@
+#include "lvk_gltf_loader.hpp"
+
+// module
+#include "lvk_geometry_arena.hpp"
+#include "lvk_mapped_file.hpp"
+#include "lvk_mesh_optimizer.hpp"
+#include "lvk_uploader.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+
+// boost
+#include <boost/log/trivial.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// glm
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/euler_angles.hpp>
+
+namespace lvk
+{
+
+using boost::property_tree::ptree;
+
+constexpr uint32_t GLB_MAGIC = 0x46546c67;      // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4e4f534a; // "JSON"
+constexpr uint32_t GLB_CHUNK_BIN = 0x004e4942;  // "BIN\0"
+constexpr uint32_t GLB_VERSION = 2;
+
+constexpr uint32_t COMPONENT_BYTE = 5120;
+constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+constexpr uint32_t COMPONENT_SHORT = 5122;
+constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125;
+constexpr uint32_t COMPONENT_FLOAT = 5126;
+constexpr uint32_t MODE_TRIANGLES = 4;
+
+struct GlbHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t length;
+};
+
+struct GlbChunkHeader
+{
+    uint32_t length;
+    uint32_t type;
+};
+
+// where an accessor's elements are in a mapped buffer
+struct Accessor
+{
+    // null without a buffer view, every element is zero then
+    const std::byte *data{nullptr};
+    size_t count{0};
+    size_t stride{0};
+    uint32_t component_type{0};
+    uint32_t component_count{0};
+    bool normalized{false};
+    std::vector<float> min;
+    std::vector<float> max;
+};
+
+struct Primitive
+{
+    Accessor positions;
+    std::optional<Accessor> colors;
+    std::optional<Accessor> normals;
+    std::optional<Accessor> indices;
+};
+
+static size_t ComponentSize(uint32_t component_type)
+{
+    switch (component_type)
+    {
+    case COMPONENT_BYTE:
+    case COMPONENT_UNSIGNED_BYTE:
+        return 1;
+    case COMPONENT_SHORT:
+    case COMPONENT_UNSIGNED_SHORT:
+        return 2;
+    case COMPONENT_UNSIGNED_INT:
+    case COMPONENT_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static uint32_t ComponentCount(std::string_view type)
+{
+    if (type == "SCALAR")
+    {
+        return 1;
+    }
+    if (type.size() == 4 && type.substr(0, 3) == "VEC" && type[3] >= '2' && type[3] <= '4')
+    {
+        return static_cast<uint32_t>(type[3] - '0');
+    }
+    // matrices aren't vertex attributes we read
+    return 0;
+}
+
+static std::vector<const ptree *> GetArray(const ptree &tree, const char *key)
+{
+    std::vector<const ptree *> items;
+    if (auto child = tree.get_child_optional(key))
+    {
+        for (const auto &[name, item] : *child)
+        {
+            items.push_back(&item);
+        }
+    }
+    return items;
+}
+
+static std::vector<float> GetFloats(const ptree &tree, const char *key)
+{
+    std::vector<float> values;
+    for (const auto *item : GetArray(tree, key))
+    {
+        values.push_back(item->get_value<float>());
+    }
+    return values;
+}
+
+// reads one component, normalized integers map to [0, 1] or [-1, 1]
+static float ReadComponent(const std::byte *data, uint32_t component_type, bool normalized)
+{
+    switch (component_type)
+    {
+    case COMPONENT_FLOAT:
+    {
+        float value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case COMPONENT_UNSIGNED_BYTE:
+    {
+        auto value = static_cast<float>(std::to_integer<uint8_t>(*data));
+        return normalized ? value / 255.f : value;
+    }
+    case COMPONENT_BYTE:
+    {
+        auto value = static_cast<float>(static_cast<int8_t>(std::to_integer<uint8_t>(*data)));
+        return normalized ? std::max(value / 127.f, -1.f) : value;
+    }
+    case COMPONENT_UNSIGNED_SHORT:
+    {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return normalized ? value / 65535.f : static_cast<float>(value);
+    }
+    case COMPONENT_SHORT:
+    {
+        int16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return normalized ? std::max(value / 32767.f, -1.f) : static_cast<float>(value);
+    }
+    default:
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return static_cast<float>(value);
+    }
+    }
+}
+
+// the first three components, positions are nearly always tightly packed floats
+static glm::vec3 ReadVec3(const Accessor &accessor, size_t index)
+{
+    if (accessor.data == nullptr)
+    {
+        return glm::vec3(0.f);
+    }
+
+    const auto *element = accessor.data + index * accessor.stride;
+    glm::vec3 value;
+    if (accessor.component_type == COMPONENT_FLOAT)
+    {
+        std::memcpy(&value, element, sizeof(value));
+        return value;
+    }
+    auto component_size = ComponentSize(accessor.component_type);
+    for (int i = 0; i < 3; i++)
+    {
+        value[i] = ReadComponent(element + i * component_size, accessor.component_type, accessor.normalized);
+    }
+    return value;
+}
+
+template <typename T>
+static void CopyIndices(const Accessor &accessor, uint32_t first_vertex, uint32_t *indices)
+{
+    for (size_t i = 0; i < accessor.count; i++)
+    {
+        T index;
+        std::memcpy(&index, accessor.data + i * accessor.stride, sizeof(index));
+        indices[i] = first_vertex + index;
+    }
+}
+
+template <typename T>
+static uint32_t MaxIndex(const Accessor &accessor)
+{
+    T max_index = 0;
+    for (size_t i = 0; i < accessor.count; i++)
+    {
+        T index;
+        std::memcpy(&index, accessor.data + i * accessor.stride, sizeof(index));
+        max_index = std::max(max_index, index);
+    }
+    return max_index;
+}
+
+static uint32_t MaxIndex(const Accessor &accessor)
+{
+    if (accessor.data == nullptr)
+    {
+        return 0;
+    }
+    switch (accessor.component_type)
+    {
+    case COMPONENT_UNSIGNED_BYTE:
+        return MaxIndex<uint8_t>(accessor);
+    case COMPONENT_UNSIGNED_SHORT:
+        return MaxIndex<uint16_t>(accessor);
+    default:
+        return MaxIndex<uint32_t>(accessor);
+    }
+}
+
+static lvk::Bounds BoundsFromBox(const glm::vec3 &min, const glm::vec3 &max)
+{
+    lvk::Bounds bounds{.min = min, .max = max};
+    bounds.center = (min + max) * 0.5f;
+    bounds.radius = glm::length(max - min) * 0.5f;
+    return bounds;
+}
+
+class GltfReader
+{
+public:
+    GltfReader(const std::filesystem::path &path, lvk::GeometryArena *arena, lvk::Uploader *uploader) :
+        path_(path),
+        arena_(arena),
+        uploader_(uploader),
+        file_(path)
+    {}
+
+    // from the accessor counts alone, buffers aren't touched
+    uint32_t ReadMaxMeshVertexCount()
+    {
+        ParseContainer();
+        accessors_ = GetArray(json_, "accessors");
+
+        uint64_t max_vertex_count = 0;
+        for (const auto *json_mesh : GetArray(json_, "meshes"))
+        {
+            uint64_t vertex_count = 0;
+            for (const auto *json_primitive : GetArray(*json_mesh, "primitives"))
+            {
+                auto position = json_primitive->get_optional<size_t>("attributes.POSITION");
+                if (json_primitive->get<uint32_t>("mode", MODE_TRIANGLES) == MODE_TRIANGLES && position && *position < accessors_.size())
+                {
+                    vertex_count += accessors_[*position]->get<uint64_t>("count", 0);
+                }
+            }
+            max_vertex_count = std::max(max_vertex_count, vertex_count);
+        }
+        return static_cast<uint32_t>(std::min<uint64_t>(max_vertex_count, std::numeric_limits<uint32_t>::max()));
+    }
+
+    lvk::GltfScene Read()
+    {
+        ParseContainer();
+        auto nodes = GetArray(json_, "nodes");
+        auto meshes = GetArray(json_, "meshes");
+        accessors_ = GetArray(json_, "accessors");
+        buffer_views_ = GetArray(json_, "bufferViews");
+
+        lvk::GltfScene scene;
+        scene.models.resize(meshes.size());
+        ReadNodes(nodes, scene);
+
+        MapBuffers();
+        for (auto &node : scene.nodes)
+        {
+            if (!node.model)
+            {
+                continue;
+            }
+            auto mesh = *node.model;
+            if (mesh >= meshes.size())
+            {
+                throw Error(fmt::format("node {} references mesh {} of {}", node.name, mesh, meshes.size()));
+            }
+            if (!scene.models[mesh] && !empty_meshes_.contains(mesh))
+            {
+                scene.models[mesh] = ReadMesh(*meshes[mesh], mesh);
+            }
+            if (!scene.models[mesh])
+            {
+                node.model.reset();
+            }
+        }
+        return scene;
+    }
+
+private:
+    std::runtime_error Error(std::string_view what) const
+    {
+        return std::runtime_error(fmt::format("gltf loader: {}: {}", path_.string(), what));
+    }
+
+    // splits a .glb into its json and binary chunks, anything else is taken as json
+    void ParseContainer()
+    {
+        auto data = file_.GetData();
+        std::string_view json(reinterpret_cast<const char *>(data.data()), data.size());
+
+        GlbHeader header{};
+        if (data.size() >= sizeof(header))
+        {
+            std::memcpy(&header, data.data(), sizeof(header));
+        }
+        if (header.magic == GLB_MAGIC)
+        {
+            if (header.version != GLB_VERSION)
+            {
+                throw Error(fmt::format("unsupported glb version {}", header.version));
+            }
+            if (header.length > data.size())
+            {
+                throw Error(fmt::format("truncated, {} of {} bytes", data.size(), header.length));
+            }
+
+            json = {};
+            for (size_t offset = sizeof(header); offset + sizeof(GlbChunkHeader) <= header.length;)
+            {
+                GlbChunkHeader chunk;
+                std::memcpy(&chunk, data.data() + offset, sizeof(chunk));
+                offset += sizeof(chunk);
+                if (chunk.length > header.length - offset)
+                {
+                    throw Error("glb chunk runs past the end of the file");
+                }
+                if (chunk.type == GLB_CHUNK_JSON && json.empty())
+                {
+                    json = std::string_view(reinterpret_cast<const char *>(data.data() + offset), chunk.length);
+                }
+                else if (chunk.type == GLB_CHUNK_BIN && glb_binary_.empty())
+                {
+                    glb_binary_ = data.subspan(offset, chunk.length);
+                }
+                // chunks are 4 byte aligned
+                offset += (chunk.length + 3) & ~size_t{3};
+            }
+        }
+
+        // the json is small next to the buffers, parsing it is not worth optimizing
+        try
+        {
+            std::istringstream stream{std::string(json)};
+            boost::property_tree::read_json(stream, json_);
+        }
+        catch (const boost::property_tree::json_parser_error &e)
+        {
+            throw Error(fmt::format("invalid json, {} at line {}", e.message(), e.line()));
+        }
+
+        auto version = json_.get<std::string>("asset.version", "");
+        if (version.substr(0, 2) != "2.")
+        {
+            throw Error(fmt::format("unsupported glTF version '{}'", version));
+        }
+    }
+
+    void MapBuffers()
+    {
+        for (const auto *buffer : GetArray(json_, "buffers"))
+        {
+            auto uri = buffer->get_optional<std::string>("uri");
+            std::span<const std::byte> data;
+            if (!uri)
+            {
+                // the glb binary chunk may be padded past the buffer
+                data = glb_binary_;
+            }
+            else if (uri->starts_with("data:"))
+            {
+                throw Error("data uris are unsupported, use a .glb or separate buffer files");
+            }
+            else
+            {
+                auto &file = external_files_.emplace_back(path_.parent_path() / *uri);
+                data = file.GetData();
+            }
+
+            auto length = buffer->get<size_t>("byteLength", 0);
+            if (length > data.size())
+            {
+                throw Error(fmt::format("buffer {} has {} bytes, {} are declared", buffers_.size(), data.size(), length));
+            }
+            buffers_.push_back(data.first(length));
+        }
+    }
+
+    void ReadNodes(const std::vector<const ptree *> &nodes, lvk::GltfScene &scene)
+    {
+        // the default scene's roots, or every node nobody has as a child without scenes
+        std::vector<uint32_t> roots;
+        auto scenes = GetArray(json_, "scenes");
+        if (!scenes.empty())
+        {
+            auto scene_index = json_.get<size_t>("scene", 0);
+            if (scene_index >= scenes.size())
+            {
+                throw Error(fmt::format("default scene {} of {}", scene_index, scenes.size()));
+            }
+            for (const auto *root : GetArray(*scenes[scene_index], "nodes"))
+            {
+                roots.push_back(root->get_value<uint32_t>());
+            }
+        }
+        else
+        {
+            std::vector<bool> is_child(nodes.size(), false);
+            for (const auto *node : nodes)
+            {
+                for (const auto *child : GetArray(*node, "children"))
+                {
+                    auto child_index = child->get_value<size_t>();
+                    if (child_index < nodes.size())
+                    {
+                        is_child[child_index] = true;
+                    }
+                }
+            }
+            for (uint32_t i = 0; i < nodes.size(); i++)
+            {
+                if (!is_child[i])
+                {
+                    roots.push_back(i);
+                }
+            }
+        }
+
+        // depth first, a node is emitted before its children are pushed
+        struct Pending
+        {
+            uint32_t node;
+            std::optional<uint32_t> parent;
+        };
+        std::vector<Pending> pending;
+        for (auto it = roots.rbegin(); it != roots.rend(); it++)
+        {
+            pending.push_back({*it, std::nullopt});
+        }
+        std::vector<bool> visited(nodes.size(), false);
+        while (!pending.empty())
+        {
+            auto [node_index, parent] = pending.back();
+            pending.pop_back();
+            if (node_index >= nodes.size() || visited[node_index])
+            {
+                throw Error(fmt::format("node {} doesn't exist or has several parents", node_index));
+            }
+            visited[node_index] = true;
+
+            const auto &json_node = *nodes[node_index];
+            auto &node = scene.nodes.emplace_back(ReadNode(json_node, node_index));
+            node.parent = parent;
+
+            auto index = static_cast<uint32_t>(scene.nodes.size() - 1);
+            auto children = GetArray(json_node, "children");
+            for (auto it = children.rbegin(); it != children.rend(); it++)
+            {
+                pending.push_back({(*it)->get_value<uint32_t>(), index});
+            }
+        }
+    }
+
+    lvk::GltfNode ReadNode(const ptree &json_node, uint32_t node_index) const
+    {
+        lvk::GltfNode node;
+        node.name = json_node.get<std::string>("name", fmt::format("node {}", node_index));
+        if (auto mesh = json_node.get_optional<uint32_t>("mesh"))
+        {
+            node.model = *mesh;
+        }
+
+        glm::mat3 rotation(1.f);
+        auto matrix = GetFloats(json_node, "matrix");
+        if (matrix.size() == 16)
+        {
+            // column major like glm, shear is dropped
+            auto transform = glm::make_mat4(matrix.data());
+            node.translation = glm::vec3(transform[3]);
+            for (int i = 0; i < 3; i++)
+            {
+                node.scale[i] = glm::length(glm::vec3(transform[i]));
+                rotation[i] = node.scale[i] > 0.f ? glm::vec3(transform[i]) / node.scale[i] : glm::vec3(0.f);
+            }
+            // mirroring goes into the scale, a rotation can't hold it
+            if (glm::determinant(rotation) < 0.f)
+            {
+                node.scale.x = -node.scale.x;
+                rotation[0] = -rotation[0];
+            }
+        }
+        else
+        {
+            auto translation = GetFloats(json_node, "translation");
+            auto quaternion = GetFloats(json_node, "rotation");
+            auto scale = GetFloats(json_node, "scale");
+            if (translation.size() == 3)
+            {
+                node.translation = {translation[0], translation[1], translation[2]};
+            }
+            if (quaternion.size() == 4)
+            {
+                // glTF stores x y z w, glm::quat takes w first
+                rotation = glm::mat3_cast(glm::normalize(glm::quat(quaternion[3], quaternion[0], quaternion[1], quaternion[2])));
+            }
+            if (scale.size() == 3)
+            {
+                node.scale = {scale[0], scale[1], scale[2]};
+            }
+        }
+
+        // Scene composes rotations as y, then x, then z
+        glm::extractEulerAngleYXZ(glm::mat4(rotation), node.rotation.y, node.rotation.x, node.rotation.z);
+        return node;
+    }
+
+    Accessor ReadAccessor(size_t index) const
+    {
+        if (index >= accessors_.size())
+        {
+            throw Error(fmt::format("accessor {} of {}", index, accessors_.size()));
+        }
+        const auto &json_accessor = *accessors_[index];
+        if (json_accessor.get_child_optional("sparse"))
+        {
+            throw Error(fmt::format("accessor {} is sparse, sparse accessors are unsupported", index));
+        }
+
+        Accessor accessor;
+        accessor.count = json_accessor.get<size_t>("count", 0);
+        accessor.component_type = json_accessor.get<uint32_t>("componentType", 0);
+        accessor.component_count = ComponentCount(json_accessor.get<std::string>("type", ""));
+        accessor.normalized = json_accessor.get<bool>("normalized", false);
+        accessor.min = GetFloats(json_accessor, "min");
+        accessor.max = GetFloats(json_accessor, "max");
+        auto element_size = ComponentSize(accessor.component_type) * accessor.component_count;
+        if (element_size == 0)
+        {
+            throw Error(fmt::format("accessor {} has an unsupported type", index));
+        }
+
+        auto view_index = json_accessor.get_optional<size_t>("bufferView");
+        if (!view_index)
+        {
+            return accessor;
+        }
+        if (*view_index >= buffer_views_.size())
+        {
+            throw Error(fmt::format("buffer view {} of {}", *view_index, buffer_views_.size()));
+        }
+        const auto &view = *buffer_views_[*view_index];
+        auto buffer_index = view.get<size_t>("buffer", 0);
+        auto view_offset = view.get<size_t>("byteOffset", 0);
+        auto view_length = view.get<size_t>("byteLength", 0);
+        if (buffer_index >= buffers_.size() || view_offset > buffers_[buffer_index].size() || view_length > buffers_[buffer_index].size() - view_offset)
+        {
+            throw Error(fmt::format("buffer view {} lies outside of its buffer", *view_index));
+        }
+
+        auto offset = json_accessor.get<size_t>("byteOffset", 0);
+        accessor.stride = view.get<size_t>("byteStride", element_size);
+        if (accessor.count > 0 && (accessor.stride < element_size || offset + (accessor.count - 1) * accessor.stride + element_size > view_length))
+        {
+            throw Error(fmt::format("accessor {} runs past its buffer view", index));
+        }
+        accessor.data = buffers_[buffer_index].data() + view_offset + offset;
+        return accessor;
+    }
+
+    std::shared_ptr<lvk::Model> ReadMesh(const ptree &json_mesh, uint32_t mesh_index)
+    {
+        std::vector<Primitive> primitives;
+        size_t vertex_count = 0;
+        size_t index_count = 0;
+        glm::vec3 min(std::numeric_limits<float>::max());
+        glm::vec3 max(std::numeric_limits<float>::lowest());
+        for (const auto *json_primitive : GetArray(json_mesh, "primitives"))
+        {
+            auto mode = json_primitive->get<uint32_t>("mode", MODE_TRIANGLES);
+            auto position = json_primitive->get_optional<size_t>("attributes.POSITION");
+            if (mode != MODE_TRIANGLES || !position)
+            {
+                BOOST_LOG_TRIVIAL(warning) << fmt::format("gltf loader: skipped a primitive of mesh {} with mode {}{}", mesh_index, mode, position ? "" : " and no positions");
+                continue;
+            }
+
+            auto &primitive = primitives.emplace_back();
+            primitive.positions = ReadAccessor(*position);
+            if (primitive.positions.component_count != 3)
+            {
+                throw Error(fmt::format("positions of mesh {} aren't vec3", mesh_index));
+            }
+            if (auto color = json_primitive->get_optional<size_t>("attributes.COLOR_0"))
+            {
+                primitive.colors = ReadAccessor(*color);
+            }
+            if (auto normal = json_primitive->get_optional<size_t>("attributes.NORMAL"))
+            {
+                primitive.normals = ReadAccessor(*normal);
+            }
+            for (const auto &attribute : {primitive.colors, primitive.normals})
+            {
+                if (attribute && (attribute->component_count < 3 || attribute->count < primitive.positions.count))
+                {
+                    throw Error(fmt::format("a color or normal accessor of mesh {} doesn't match its positions", mesh_index));
+                }
+            }
+
+            if (auto indices = json_primitive->get_optional<size_t>("indices"))
+            {
+                primitive.indices = ReadAccessor(*indices);
+                auto type = primitive.indices->component_type;
+                if (primitive.indices->component_count != 1 || (type != COMPONENT_UNSIGNED_BYTE && type != COMPONENT_UNSIGNED_SHORT && type != COMPONENT_UNSIGNED_INT))
+                {
+                    throw Error(fmt::format("indices of mesh {} aren't unsigned integers", mesh_index));
+                }
+                // checked before anything is staged, the writers can't fail halfway
+                if (primitive.indices->count > 0 && MaxIndex(*primitive.indices) >= primitive.positions.count)
+                {
+                    throw Error(fmt::format("indices of mesh {} reference missing vertices", mesh_index));
+                }
+            }
+
+            // the spec requires position bounds, they save a pass over the positions
+            if (primitive.positions.min.size() == 3 && primitive.positions.max.size() == 3)
+            {
+                min = glm::min(min, glm::vec3(primitive.positions.min[0], primitive.positions.min[1], primitive.positions.min[2]));
+                max = glm::max(max, glm::vec3(primitive.positions.max[0], primitive.positions.max[1], primitive.positions.max[2]));
+            }
+            else
+            {
+                for (size_t i = 0; i < primitive.positions.count; i++)
+                {
+                    auto position_value = ReadVec3(primitive.positions, i);
+                    min = glm::min(min, position_value);
+                    max = glm::max(max, position_value);
+                }
+            }
+
+            vertex_count += primitive.positions.count;
+            // primitives without indices are merged with the others, they get sequential ones
+            index_count += primitive.indices ? primitive.indices->count : primitive.positions.count;
+        }
+
+        if (vertex_count == 0 || index_count == 0)
+        {
+            empty_meshes_.insert(mesh_index);
+            return nullptr;
+        }
+        if (vertex_count > std::numeric_limits<uint32_t>::max() || index_count > std::numeric_limits<uint32_t>::max())
+        {
+            throw Error(fmt::format("mesh {} is too large for 32 bit indices", mesh_index));
+        }
+
+        auto decode_indices = [&](std::span<uint32_t> indices)
+        {
+            uint32_t first_vertex = 0;
+            auto *index = indices.data();
+            for (const auto &primitive : primitives)
+            {
+                if (!primitive.indices)
+                {
+                    for (uint32_t i = 0; i < primitive.positions.count; i++)
+                    {
+                        *index++ = first_vertex + i;
+                    }
+                }
+                else if (primitive.indices->data == nullptr)
+                {
+                    std::fill_n(index, primitive.indices->count, first_vertex);
+                    index += primitive.indices->count;
+                }
+                else
+                {
+                    switch (primitive.indices->component_type)
+                    {
+                    case COMPONENT_UNSIGNED_BYTE:
+                        CopyIndices<uint8_t>(*primitive.indices, first_vertex, index);
+                        break;
+                    case COMPONENT_UNSIGNED_SHORT:
+                        CopyIndices<uint16_t>(*primitive.indices, first_vertex, index);
+                        break;
+                    default:
+                        CopyIndices<uint32_t>(*primitive.indices, first_vertex, index);
+                        break;
+                    }
+                    index += primitive.indices->count;
+                }
+                first_vertex += static_cast<uint32_t>(primitive.positions.count);
+            }
+        };
+
+        // indices are small next to the vertices, they are decoded and optimized ahead. The
+        // vertices still go straight into staging, in the order the indices first use them
+        std::vector<uint32_t> indices(index_count);
+        decode_indices(indices);
+        std::vector<glm::vec3> positions;
+        positions.reserve(vertex_count);
+        for (const auto &primitive : primitives)
+        {
+            for (size_t i = 0; i < primitive.positions.count; i++)
+            {
+                positions.push_back(ReadVec3(primitive.positions, i));
+            }
+        }
+        std::vector<uint32_t> remap(vertex_count);
+        auto report = lvk::OptimizeIndices(indices, positions, remap);
+
+        auto write_vertices = [&](std::span<Vertex> vertices)
+        {
+            size_t first_vertex = 0;
+            for (const auto &primitive : primitives)
+            {
+                for (size_t i = 0; i < primitive.positions.count; i++)
+                {
+                    auto target = remap[first_vertex + i];
+                    if (target == lvk::UNREFERENCED_VERTEX)
+                    {
+                        continue;
+                    }
+                    glm::vec3 color(1.f);
+                    if (primitive.colors)
+                    {
+                        color = ReadVec3(*primitive.colors, i);
+                    }
+                    else if (primitive.normals)
+                    {
+                        color = ReadVec3(*primitive.normals, i) * 0.5f + 0.5f;
+                    }
+                    vertices[target] = Vertex{.posision = positions[first_vertex + i], .color = color};
+                }
+                first_vertex += primitive.positions.count;
+            }
+        };
+
+        return std::make_shared<lvk::Model>(lvk::Model::FromWriters(
+            *arena_,
+            *uploader_,
+            report.vertex_count,
+            static_cast<uint32_t>(index_count),
+            write_vertices,
+            [&](std::span<uint32_t> staging) { std::copy(indices.begin(), indices.end(), staging.begin()); },
+            BoundsFromBox(min, max)));
+    }
+
+private:
+    std::filesystem::path path_;
+    lvk::GeometryArena *arena_;
+    lvk::Uploader *uploader_;
+
+    lvk::MappedFile file_;
+    std::vector<lvk::MappedFile> external_files_;
+    std::span<const std::byte> glb_binary_;
+    std::vector<std::span<const std::byte>> buffers_;
+
+    ptree json_;
+    std::vector<const ptree *> accessors_;
+    std::vector<const ptree *> buffer_views_;
+    std::unordered_set<uint32_t> empty_meshes_;
+};
+
+lvk::GltfScene LoadGltf(const std::filesystem::path &path, lvk::GeometryArena &arena, lvk::Uploader &uploader)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto scene = GltfReader(path, &arena, &uploader).Read();
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    auto model_count = std::count_if(scene.models.begin(), scene.models.end(), [](const auto &model) { return model != nullptr; });
+    BOOST_LOG_TRIVIAL(info) << fmt::format("gltf loader: {} loaded in {:.1f} ms, {} models, {} nodes", path.string(), elapsed.count(), model_count, scene.nodes.size());
+    return scene;
+}
+
+uint32_t GetGltfMaxMeshVertexCount(const std::filesystem::path &path)
+{
+    return GltfReader(path, nullptr, nullptr).ReadMaxMeshVertexCount();
+}
+
+std::vector<lvk::Entity> InstantiateGltf(lvk::Scene &scene, const lvk::GltfScene &gltf, lvk::Entity parent)
+{
+    std::vector<lvk::Entity> entities;
+    entities.reserve(gltf.nodes.size());
+    for (const auto &node : gltf.nodes)
+    {
+        auto model = node.model ? gltf.models[*node.model] : nullptr;
+        auto entity = scene.Create(model, node.parent ? entities[*node.parent] : parent);
+        scene.SetTranslation(entity, node.translation);
+        scene.SetRotation(entity, node.rotation);
+        scene.SetScale(entity, node.scale);
+        entities.push_back(entity);
+    }
+    return entities;
+}
+
+}
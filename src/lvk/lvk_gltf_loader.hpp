@@ -0,0 +1,64 @@
+#ifndef _LVK_GLTF_LOADER_H
+#define _LVK_GLTF_LOADER_H
+
+// module
+#include "lvk_model.hpp"
+#include "lvk_scene.hpp"
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+class GeometryArena;
+class Uploader;
+
+struct GltfNode
+{
+    std::string name;
+    // index into GltfScene::nodes, parents come before their children
+    std::optional<uint32_t> parent;
+    // index into GltfScene::models
+    std::optional<uint32_t> model;
+    // relative to the parent, rotation as Scene's euler angles
+    glm::vec3 translation{0.f};
+    glm::vec3 rotation{0.f};
+    glm::vec3 scale{1.f};
+};
+
+struct GltfScene
+{
+    // one per glTF mesh with its triangle primitives merged, null for meshes the scene
+    // doesn't use or that have no triangles
+    std::vector<std::shared_ptr<lvk::Model>> models;
+    // the nodes of the default scene
+    std::vector<GltfNode> nodes;
+};
+
+// glTF 2.0 loader for .glb files, and .gltf files with their buffers in separate files.
+// Buffers are memory mapped and accessors are read in place. Indices are decoded and run
+// through the mesh optimizer first, vertices are converted straight into the uploader's
+// staging memory in the optimized order: positions, COLOR_0 or else the normal mapped to
+// [0, 1] as the vertex color, and 8, 16 or 32 bit indices widened to 32. Materials,
+// textures, skins, animations and cameras are ignored, so are primitives that aren't
+// triangle lists. Node matrices are decomposed, shear is lost. Throws on malformed files
+// and sparse accessors.
+lvk::GltfScene LoadGltf(const std::filesystem::path &path, lvk::GeometryArena &arena, lvk::Uploader &uploader);
+
+// vertices of the file's largest mesh with its triangle primitives merged, from the json
+// alone. Lets a caller pick the arena's index type before LoadGltf uploads anything
+uint32_t GetGltfMaxMeshVertexCount(const std::filesystem::path &path);
+
+// creates an entity per node below parent, returned in the order of GltfScene::nodes
+std::vector<lvk::Entity> InstantiateGltf(lvk::Scene &scene, const lvk::GltfScene &gltf, lvk::Entity parent = {});
+
+}
+#endif
@@ -0,0 +1,451 @@
+#include "lvk_gpu_culling.hpp"
+
+// module
+#include "lvk_hardware.hpp"
+#include "lvk_allocator.hpp"
+#include "lvk_shader.hpp"
+#include "lvk_shader_bundle.hpp"
+#include "lvk_model.hpp"
+#include "lvk_scene.hpp"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+constexpr uint32_t INITIAL_OBJECT_CAPACITY = 256;
+constexpr uint32_t INITIAL_MESH_CAPACITY = 16;
+constexpr uint32_t CULL_GROUP_SIZE = 64;
+constexpr uint32_t NO_MESH = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t BINDING_COUNT = 7;
+
+static_assert(sizeof(GpuCulling::Mesh) == 32, "must match Mesh in culling.glsl");
+static_assert(sizeof(GpuCulling::ObjectUpdate) == 80, "must match ObjectUpdate in culling.glsl");
+static_assert(sizeof(GpuCulling::CullConstants) == 104, "must match CullConstants in culling.glsl");
+
+GpuCulling::GpuCulling(const lvk::Hardware &hardware, const lvk::Allocator &allocator, const lvk::ShaderBundle &shaders, lvk::PipelineCache &pipeline_cache) :
+    hardware_(&hardware),
+    allocator_(&allocator),
+    descriptor_set_layout_(ConstructDescriptorSetLayout(hardware)),
+    descriptor_pool_(ConstructDescriptorPool(hardware)),
+    pipeline_layout_(ConstructPipelineLayout(hardware)),
+    scatter_pipeline_(hardware, pipeline_layout_, lvk::Shader(hardware, "main", shaders.Get("culling/scatter.comp"), vk::ShaderStageFlagBits::eCompute), pipeline_cache),
+    cull_pipeline_(hardware, pipeline_layout_, lvk::Shader(hardware, "main", shaders.Get("culling/cull.comp"), vk::ShaderStageFlagBits::eCompute), pipeline_cache),
+    max_draw_indirect_count_(hardware.GetPhysicalDevice().getProperties().limits.maxDrawIndirectCount),
+    frames_(ConstructFrameResources(hardware))
+{
+    ReserveObjects(INITIAL_OBJECT_CAPACITY);
+}
+
+GpuCulling::GpuCulling(GpuCulling &&other) noexcept :
+    hardware_(other.hardware_),
+    allocator_(other.allocator_),
+    descriptor_set_layout_(std::move(other.descriptor_set_layout_)),
+    descriptor_pool_(std::move(other.descriptor_pool_)),
+    pipeline_layout_(std::move(other.pipeline_layout_)),
+    scatter_pipeline_(std::move(other.scatter_pipeline_)),
+    cull_pipeline_(std::move(other.cull_pipeline_)),
+    max_draw_indirect_count_(other.max_draw_indirect_count_),
+    world_buffer_(std::move(other.world_buffer_)),
+    object_mesh_buffer_(std::move(other.object_mesh_buffer_)),
+    object_capacity_(other.object_capacity_),
+    scene_size_(other.scene_size_),
+    retired_(std::move(other.retired_)),
+    retire_index_(other.retire_index_),
+    frames_(std::move(other.frames_)),
+    frame_counter_(other.frame_counter_),
+    mesh_slots_(std::move(other.mesh_slots_)),
+    free_mesh_ids_(std::move(other.free_mesh_ids_)),
+    mesh_count_(other.mesh_count_),
+    culling_stats_(other.culling_stats_)
+{}
+
+bool GpuCulling::IsSupported(const lvk::Hardware &hardware)
+{
+    const auto &features = hardware.GetEnabledFeatures();
+    return hardware.IsExtensionEnabled(EXT_NAME_VK_KHR_draw_indirect_count) && features.multiDrawIndirect && features.drawIndirectFirstInstance;
+}
+
+void GpuCulling::Prepare(const FrameContext &context, const lvk::Scene &scene, const lvk::Frustum &frustum)
+{
+    auto &frame = frames_[context.frame_index];
+    // the frame's fence was waited, its counts are final
+    if (frame.submitted)
+    {
+        ReadCullingStats(frame);
+    }
+
+    retire_index_ = (retire_index_ + 1) % retired_.size();
+    retired_[retire_index_].clear();
+    frame_counter_++;
+
+    auto object_count = static_cast<uint32_t>(scene.Size());
+    bool full_update = ReserveObjects(object_count) || scene.Size() != scene_size_;
+    scene_size_ = scene.Size();
+
+    AssignMeshIds(scene);
+    ReserveFrame(frame, object_count, mesh_count_);
+    WriteMeshes(frame);
+    auto update_count = WriteUpdates(frame, scene, full_update);
+    UpdateDescriptorSet(frame);
+    frame.object_count = object_count;
+    frame.submitted = true;
+
+    const auto &command_buffer = context.command_buffer;
+    // the last frame's draws may still read the persistent buffers this frame overwrites
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader,
+        vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader,
+        {}, nullptr, nullptr, nullptr);
+    command_buffer.fillBuffer(*frame.count_buffer, 0, sizeof(DrawCounts), 0);
+
+    vk::MemoryBarrier fill_barrier
+    {
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+    };
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, fill_barrier, nullptr, nullptr);
+
+    CullConstants constants
+    {
+        .planes = frustum.planes,
+        .object_count = object_count,
+        .update_count = update_count
+    };
+    command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipeline_layout_, 0, {*frame.descriptor_set}, nullptr);
+    command_buffer.pushConstants<CullConstants>(*pipeline_layout_, vk::ShaderStageFlagBits::eCompute, 0, constants);
+
+    if (update_count > 0)
+    {
+        scatter_pipeline_.BindPipeline(command_buffer);
+        command_buffer.dispatch((update_count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+        vk::MemoryBarrier scatter_barrier
+        {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead
+        };
+        command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, scatter_barrier, nullptr, nullptr);
+    }
+
+    if (object_count > 0)
+    {
+        cull_pipeline_.BindPipeline(command_buffer);
+        command_buffer.dispatch((object_count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+    }
+
+    // the counts are also read back by the host once the frame's fence is signaled
+    vk::MemoryBarrier cull_barrier
+    {
+        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eHostRead
+    };
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eHost,
+        {}, cull_barrier, nullptr, nullptr);
+}
+
+void GpuCulling::Draw(const vk::raii::CommandBuffer &command_buffer, uint32_t frame_index) const
+{
+    const auto &frame = frames_[frame_index];
+    if (frame.object_count == 0)
+    {
+        return;
+    }
+
+    // every object produces at most one draw
+    auto max_draw_count = std::min(frame.object_count, max_draw_indirect_count_);
+    const vk::Buffer &count_buffer = *frame.count_buffer;
+    command_buffer.drawIndexedIndirectCountKHR(*frame.indexed_draw_buffer, 0, count_buffer, 0, max_draw_count, sizeof(vk::DrawIndexedIndirectCommand));
+    command_buffer.drawIndirectCountKHR(*frame.vertex_draw_buffer, 0, count_buffer, sizeof(uint32_t), max_draw_count, sizeof(vk::DrawIndirectCommand));
+}
+
+void GpuCulling::AssignMeshIds(const lvk::Scene &scene)
+{
+    // one pass over the models, not the objects
+    auto models = scene.GetUniqueModels();
+    for (const auto *model : models)
+    {
+        auto [it, inserted] = mesh_slots_.try_emplace(model, MeshSlot{.id = 0, .last_seen = frame_counter_});
+        it->second.last_seen = frame_counter_;
+        if (!inserted)
+        {
+            continue;
+        }
+
+        if (!free_mesh_ids_.empty())
+        {
+            it->second.id = free_mesh_ids_.back();
+            free_mesh_ids_.pop_back();
+        }
+        else
+        {
+            it->second.id = mesh_count_++;
+        }
+    }
+
+    // a model leaves the scene only with its last entity, and every destroy reports all objects as changed
+    std::erase_if(mesh_slots_, [&](const auto &entry)
+    {
+        if (entry.second.last_seen == frame_counter_)
+        {
+            return false;
+        }
+        free_mesh_ids_.push_back(entry.second.id);
+        return true;
+    });
+}
+
+void GpuCulling::WriteMeshes(FrameResources &frame)
+{
+    auto *meshes = static_cast<Mesh *>(frame.mesh_buffer->GetMappedData());
+    std::fill(meshes, meshes + mesh_count_, Mesh{});
+    for (const auto &[model, slot] : mesh_slots_)
+    {
+        // not resident yet, the entry is rewritten every frame so it shows up once the upload lands
+        if (!model->IsResident())
+        {
+            continue;
+        }
+
+        auto range = model->GetRange();
+        const auto &bounds = model->GetBounds();
+        meshes[slot.id] = Mesh
+        {
+            .sphere = glm::vec4(bounds.center, bounds.radius),
+            .index_count = range.index_count,
+            .first_index = range.first_index,
+            .vertex_offset = static_cast<int32_t>(range.first_vertex),
+            .vertex_count = range.vertex_count
+        };
+    }
+    frame.mesh_buffer->FlushMemory(0, VK_WHOLE_SIZE);
+}
+
+uint32_t GpuCulling::WriteUpdates(FrameResources &frame, const lvk::Scene &scene, bool full_update)
+{
+    auto models = scene.GetModels();
+    auto world_matrices = scene.GetWorldMatrices();
+    auto *updates = static_cast<ObjectUpdate *>(frame.update_buffer->GetMappedData());
+    auto write = [&](uint32_t slot, uint32_t i)
+    {
+        updates[slot] = ObjectUpdate
+        {
+            .world = world_matrices[i],
+            .index = i,
+            .mesh = models[i] != nullptr ? mesh_slots_.at(models[i]).id : NO_MESH
+        };
+    };
+
+    uint32_t update_count = 0;
+    if (full_update)
+    {
+        for (uint32_t i = 0; i < scene.Size(); i++)
+        {
+            write(update_count++, i);
+        }
+    }
+    else
+    {
+        for (auto i : scene.GetChangedIndices())
+        {
+            write(update_count++, i);
+        }
+    }
+
+    if (update_count > 0)
+    {
+        frame.update_buffer->FlushMemory(0, update_count * sizeof(ObjectUpdate));
+    }
+    return update_count;
+}
+
+void GpuCulling::ReadCullingStats(const FrameResources &frame)
+{
+    frame.count_buffer->InvalidateMemory(0, sizeof(DrawCounts));
+    DrawCounts counts;
+    std::memcpy(counts.data(), frame.count_buffer->GetMappedData(), sizeof(DrawCounts));
+    culling_stats_ = CullingStats{.visible = counts[0] + counts[1], .culled = counts[2]};
+}
+
+bool GpuCulling::ReserveObjects(uint32_t count)
+{
+    if (count <= object_capacity_ && world_buffer_)
+    {
+        return false;
+    }
+
+    // the old contents are not copied over, the caller refills everything
+    auto capacity = std::max({count, object_capacity_ * 2, INITIAL_OBJECT_CAPACITY});
+    if (world_buffer_)
+    {
+        retired_[retire_index_].push_back(std::move(*world_buffer_));
+        retired_[retire_index_].push_back(std::move(*object_mesh_buffer_));
+    }
+    world_buffer_.emplace(ConstructBuffer(capacity * sizeof(glm::mat4), vk::BufferUsageFlagBits::eStorageBuffer, false));
+    object_mesh_buffer_.emplace(ConstructBuffer(capacity * sizeof(uint32_t), vk::BufferUsageFlagBits::eStorageBuffer, false));
+    object_capacity_ = capacity;
+    BOOST_LOG_TRIVIAL(debug) << fmt::format("gpu culling object capacity: {}", capacity);
+    return true;
+}
+
+void GpuCulling::ReserveFrame(FrameResources &frame, uint32_t object_count, uint32_t mesh_count)
+{
+    // the frame's fence was waited, its old buffers are no longer read by the gpu
+    if (object_count > frame.object_capacity || !frame.update_buffer)
+    {
+        auto capacity = std::max({object_count, frame.object_capacity * 2, INITIAL_OBJECT_CAPACITY});
+        frame.update_buffer.emplace(ConstructBuffer(capacity * sizeof(ObjectUpdate), vk::BufferUsageFlagBits::eStorageBuffer, true));
+        frame.indexed_draw_buffer.emplace(ConstructBuffer(capacity * sizeof(vk::DrawIndexedIndirectCommand), vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer, false));
+        frame.vertex_draw_buffer.emplace(ConstructBuffer(capacity * sizeof(vk::DrawIndirectCommand), vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer, false));
+        frame.object_capacity = capacity;
+    }
+
+    if (mesh_count > frame.mesh_capacity || !frame.mesh_buffer)
+    {
+        auto capacity = std::max({mesh_count, frame.mesh_capacity * 2, INITIAL_MESH_CAPACITY});
+        frame.mesh_buffer.emplace(ConstructBuffer(capacity * sizeof(Mesh), vk::BufferUsageFlagBits::eStorageBuffer, true));
+        frame.mesh_capacity = capacity;
+    }
+}
+
+void GpuCulling::UpdateDescriptorSet(const FrameResources &frame)
+{
+    // cheap enough to rewrite every frame, any buffer may have been replaced
+    std::array<vk::DescriptorBufferInfo, BINDING_COUNT> buffer_infos
+    {
+        vk::DescriptorBufferInfo{.buffer = *world_buffer_, .offset = 0, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo{.buffer = *object_mesh_buffer_, .offset = 0, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo{.buffer = *frame.mesh_buffer, .offset = 0, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo{.buffer = *frame.update_buffer, .offset = 0, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo{.buffer = *frame.indexed_draw_buffer, .offset = 0, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo{.buffer = *frame.vertex_draw_buffer, .offset = 0, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo{.buffer = *frame.count_buffer, .offset = 0, .range = VK_WHOLE_SIZE},
+    };
+
+    std::array<vk::WriteDescriptorSet, BINDING_COUNT> writes;
+    for (uint32_t i = 0; i < BINDING_COUNT; i++)
+    {
+        writes[i] = vk::WriteDescriptorSet
+        {
+            .dstSet = *frame.descriptor_set,
+            .dstBinding = i,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &buffer_infos[i]
+        };
+    }
+    hardware_->GetDevice().updateDescriptorSets(writes, nullptr);
+}
+
+lvk::Buffer GpuCulling::ConstructBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, bool host_visible) const
+{
+    VmaAllocationCreateInfo alloc_info{.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE};
+    if (host_visible)
+    {
+        alloc_info = VmaAllocationCreateInfo{.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, .usage = VMA_MEMORY_USAGE_AUTO};
+    }
+    return lvk::Buffer(*allocator_, vk::BufferCreateInfo{.size = size, .usage = usage, .sharingMode = vk::SharingMode::eExclusive}, alloc_info);
+}
+
+std::array<GpuCulling::FrameResources, MAX_FRAMES_IN_FLIGHT> GpuCulling::ConstructFrameResources(const lvk::Hardware &hardware)
+{
+    std::array<vk::DescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts;
+    layouts.fill(*descriptor_set_layout_);
+    vk::DescriptorSetAllocateInfo allocate_info
+    {
+        .descriptorPool = *descriptor_pool_,
+        .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
+        .pSetLayouts = layouts.data()
+    };
+    auto descriptor_sets = hardware.GetDevice().allocateDescriptorSets(allocate_info);
+
+    std::array<FrameResources, MAX_FRAMES_IN_FLIGHT> frames;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        frames[i].descriptor_set = std::move(descriptor_sets[i]);
+        // read back by the host, so random access rather than sequential write
+        frames[i].count_buffer.emplace(
+            *allocator_,
+            vk::BufferCreateInfo{.size = sizeof(DrawCounts), .usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, .sharingMode = vk::SharingMode::eExclusive},
+            VmaAllocationCreateInfo{.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, .usage = VMA_MEMORY_USAGE_AUTO});
+        ReserveFrame(frames[i], INITIAL_OBJECT_CAPACITY, INITIAL_MESH_CAPACITY);
+    }
+    return frames;
+}
+
+vk::raii::DescriptorSetLayout GpuCulling::ConstructDescriptorSetLayout(const lvk::Hardware &hardware)
+{
+    std::array<vk::DescriptorSetLayoutBinding, BINDING_COUNT> bindings;
+    for (uint32_t i = 0; i < BINDING_COUNT; i++)
+    {
+        bindings[i] = vk::DescriptorSetLayoutBinding
+        {
+            .binding = i,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute
+        };
+    }
+
+    vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info
+    {
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    };
+
+    return vk::raii::DescriptorSetLayout(hardware.GetDevice(), descriptor_set_layout_create_info);
+}
+
+vk::raii::DescriptorPool GpuCulling::ConstructDescriptorPool(const lvk::Hardware &hardware)
+{
+    vk::DescriptorPoolSize pool_size
+    {
+        .type = vk::DescriptorType::eStorageBuffer,
+        .descriptorCount = BINDING_COUNT * MAX_FRAMES_IN_FLIGHT
+    };
+
+    // raii descriptor sets free themselves
+    vk::DescriptorPoolCreateInfo descriptor_pool_create_info
+    {
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = MAX_FRAMES_IN_FLIGHT,
+        .poolSizeCount = 1,
+        .pPoolSizes = &pool_size
+    };
+
+    return vk::raii::DescriptorPool(hardware.GetDevice(), descriptor_pool_create_info);
+}
+
+vk::raii::PipelineLayout GpuCulling::ConstructPipelineLayout(const lvk::Hardware &hardware)
+{
+    vk::PushConstantRange push_constant_range
+    {
+        .stageFlags = vk::ShaderStageFlagBits::eCompute,
+        .offset = 0,
+        .size = sizeof(CullConstants),
+    };
+
+    vk::PipelineLayoutCreateInfo pipeline_layout_create_info
+    {
+        .setLayoutCount = 1,
+        .pSetLayouts = &*descriptor_set_layout_,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range
+    };
+
+    return vk::raii::PipelineLayout(hardware.GetDevice(), pipeline_layout_create_info);
+}
+
+}
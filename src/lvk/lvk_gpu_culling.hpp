@@ -0,0 +1,158 @@
+#ifndef _LVK_GPU_CULLING_H
+#define _LVK_GPU_CULLING_H
+
+// module
+#include "lvk_definitions.hpp"
+#include "lvk_buffer.hpp"
+#include "lvk_compute_pipeline.hpp"
+#include "lvk_culling.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+class Hardware;
+class Allocator;
+class Model;
+class Scene;
+class PipelineCache;
+class ShaderBundle;
+
+// Frustum culling and draw compaction on the gpu. World matrices and mesh ids live
+// in persistent device buffers indexed by the scene's dense index, each frame only
+// the entries the scene reports as changed are scattered into them. A compute pass
+// then tests every object and appends one draw per visible object to compacted
+// indirect buffers, which are drawn with vkCmdDraw*IndirectCountKHR. The cpu cost
+// per frame depends on the number of changed objects and models, not the scene size.
+// Layouts mirror shaders/culling/culling.glsl.
+class GpuCulling : public boost::noncopyable
+{
+public:
+    GpuCulling(const lvk::Hardware &hardware, const lvk::Allocator &allocator, const lvk::ShaderBundle &shaders, lvk::PipelineCache &pipeline_cache);
+    GpuCulling(GpuCulling &&other) noexcept;
+
+    // VK_KHR_draw_indirect_count plus the features the compacted draws rely on
+    static bool IsSupported(const lvk::Hardware &hardware);
+
+    // records the culling passes, must be outside of a render pass
+    // world matrices are taken as they are, call Scene::UpdateWorldMatrices first
+    void Prepare(const FrameContext &context, const lvk::Scene &scene, const lvk::Frustum &frustum);
+    // records the compacted draws, inside the render pass with geometry and the graphics pipeline bound
+    void Draw(const vk::raii::CommandBuffer &command_buffer, uint32_t frame_index) const;
+
+    // indexed by dense index, the vertex shader reads it with gl_InstanceIndex
+    const lvk::Buffer &GetWorldBuffer() const { return *world_buffer_; }
+    // read back from the last completed use of the frame's resources, so it lags MAX_FRAMES_IN_FLIGHT frames
+    const CullingStats &GetCullingStats() const { return culling_stats_; }
+
+public:
+    struct Mesh
+    {
+        glm::vec4 sphere{0.f};
+        uint32_t index_count{0};
+        uint32_t first_index{0};
+        int32_t vertex_offset{0};
+        uint32_t vertex_count{0};
+    };
+
+    struct ObjectUpdate
+    {
+        glm::mat4 world{1.f};
+        uint32_t index{0};
+        uint32_t mesh{0};
+        uint32_t pad[2]{};
+    };
+
+    struct CullConstants
+    {
+        std::array<glm::vec4, 6> planes;
+        uint32_t object_count{0};
+        uint32_t update_count{0};
+    };
+
+    // [0] indexed draws, [1] non indexed draws, [2] culled objects
+    using DrawCounts = std::array<uint32_t, 3>;
+
+private:
+    // everything the gpu reads or writes only while the frame is in flight
+    struct FrameResources
+    {
+        std::optional<lvk::Buffer> update_buffer;
+        std::optional<lvk::Buffer> indexed_draw_buffer;
+        std::optional<lvk::Buffer> vertex_draw_buffer;
+        uint32_t object_capacity{0};
+        std::optional<lvk::Buffer> mesh_buffer;
+        uint32_t mesh_capacity{0};
+        std::optional<lvk::Buffer> count_buffer;
+        vk::raii::DescriptorSet descriptor_set{nullptr};
+        uint32_t object_count{0};
+        bool submitted{false};
+    };
+
+    struct MeshSlot
+    {
+        uint32_t id;
+        uint64_t last_seen;
+    };
+
+    vk::raii::DescriptorSetLayout ConstructDescriptorSetLayout(const lvk::Hardware &hardware);
+    vk::raii::DescriptorPool ConstructDescriptorPool(const lvk::Hardware &hardware);
+    vk::raii::PipelineLayout ConstructPipelineLayout(const lvk::Hardware &hardware);
+    std::array<FrameResources, MAX_FRAMES_IN_FLIGHT> ConstructFrameResources(const lvk::Hardware &hardware);
+    lvk::Buffer ConstructBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, bool host_visible) const;
+
+    // true when the persistent buffers were reallocated and have to be refilled
+    bool ReserveObjects(uint32_t count);
+    void ReserveFrame(FrameResources &frame, uint32_t object_count, uint32_t mesh_count);
+    void AssignMeshIds(const lvk::Scene &scene);
+    void WriteMeshes(FrameResources &frame);
+    uint32_t WriteUpdates(FrameResources &frame, const lvk::Scene &scene, bool full_update);
+    void UpdateDescriptorSet(const FrameResources &frame);
+    void ReadCullingStats(const FrameResources &frame);
+
+private:
+    const lvk::Hardware *hardware_;
+    const lvk::Allocator *allocator_;
+    vk::raii::DescriptorSetLayout descriptor_set_layout_;
+    vk::raii::DescriptorPool descriptor_pool_;
+    vk::raii::PipelineLayout pipeline_layout_;
+    lvk::ComputePipeline scatter_pipeline_;
+    lvk::ComputePipeline cull_pipeline_;
+    uint32_t max_draw_indirect_count_;
+
+    // persistent, indexed by dense index
+    std::optional<lvk::Buffer> world_buffer_;
+    std::optional<lvk::Buffer> object_mesh_buffer_;
+    uint32_t object_capacity_{0};
+    size_t scene_size_{0};
+    // replaced persistent buffers, frames in flight may still read them
+    std::array<std::vector<lvk::Buffer>, MAX_FRAMES_IN_FLIGHT + 1> retired_;
+    size_t retire_index_{0};
+
+    std::array<FrameResources, MAX_FRAMES_IN_FLIGHT> frames_;
+    uint64_t frame_counter_{0};
+
+    // stable ids so unchanged objects keep pointing at the right mesh entry
+    std::unordered_map<const lvk::Model *, MeshSlot> mesh_slots_;
+    std::vector<uint32_t> free_mesh_ids_;
+    uint32_t mesh_count_{0};
+
+    CullingStats culling_stats_;
+};
+
+}
+#endif
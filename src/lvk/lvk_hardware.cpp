@@ -3,6 +3,11 @@
 // std
 #include <unordered_set>
 #include <array>
+#include <algorithm>
+#include <cctype>
+
+// boost
+#include <boost/log/trivial.hpp>
 
 // fmtlib
 #include <fmt/format.h>
@@ -11,64 +16,243 @@ namespace lvk
 {
 
 const std::vector<std::string_view> REQUIRED_DEVICE_EXTENSION { EXT_NAME_VK_KHR_swapchain };
-const std::vector<std::string_view> OPTIONAL_DEVICE_EXTENSION { EXT_NAME_VK_KHR_portability_subset };
+const std::vector<std::string_view> OPTIONAL_DEVICE_EXTENSION { EXT_NAME_VK_KHR_portability_subset, EXT_NAME_VK_KHR_draw_indirect_count };
+
+Hardware::Hardware(const vk::raii::Instance &instance, const vk::raii::SurfaceKHR &surface, std::string_view device_override) :
+    surface_(&surface),
+    physical_device_(ConstructPhysicalDevice(instance, device_override)),
+    enabled_features_(ConstructEnabledFeatures()),
+    enabled_extensions_(ConstructEnabledExtensions()),
+    device_(ConstructDevice()),
+    queue_mutexes_(ConstructQueueMutexes())
+{}
 
-Hardware::Hardware(const vk::raii::Instance &instance, const vk::raii::SurfaceKHR &surface) :
-    physical_device_(ConstructPhysicalDevice(instance, surface)),
+Hardware::Hardware(const vk::raii::Instance &instance, std::string_view device_override) :
+    surface_(nullptr),
+    physical_device_(ConstructPhysicalDevice(instance, device_override)),
+    enabled_features_(ConstructEnabledFeatures()),
+    enabled_extensions_(ConstructEnabledExtensions()),
     device_(ConstructDevice()),
-    surface_(surface)
+    queue_mutexes_(ConstructQueueMutexes())
 {}
 
 Hardware::Hardware(Hardware &&other) noexcept :
+    surface_(other.surface_),
     physical_device_(std::move(other.physical_device_)),
+    enabled_features_(other.enabled_features_),
+    enabled_extensions_(std::move(other.enabled_extensions_)),
     device_(std::move(other.device_)),
-    surface_(other.surface_)
+    queue_mutexes_(std::move(other.queue_mutexes_))
 {}
 
-vk::raii::PhysicalDevice Hardware::ConstructPhysicalDevice(const vk::raii::Instance &instance, const vk::raii::SurfaceKHR &surface) const
+vk::raii::PhysicalDevice Hardware::ConstructPhysicalDevice(const vk::raii::Instance &instance, std::string_view device_override) const
 {
+    std::optional<vk::raii::PhysicalDevice> best_device;
+    uint64_t best_score = 0;
+
     for (auto &physical_device : instance.enumeratePhysicalDevices())
     {
         auto properties = physical_device.getProperties();
-        auto features = physical_device.getFeatures();
+        std::string name(properties.deviceName.data());
+        auto uuid = GetDeviceUUID(physical_device);
 
-        if (properties.deviceType != vk::PhysicalDeviceType::eDiscreteGpu)
+        if (auto reason = CheckPhysicalDevice(physical_device); reason)
         {
+            BOOST_LOG_TRIVIAL(info) << fmt::format("device {} [{}] {} rejected: {}", name, uuid, vk::to_string(properties.deviceType), *reason);
             continue;
         }
 
-        if (!features.tessellationShader)
+        auto score = ScorePhysicalDevice(physical_device);
+        BOOST_LOG_TRIVIAL(info) << fmt::format("device {} [{}] {} score: {}", name, uuid, vk::to_string(properties.deviceType), score);
+
+        if (!device_override.empty())
         {
+            if (MatchDeviceOverride(name, uuid, device_override))
+            {
+                BOOST_LOG_TRIVIAL(info) << fmt::format("device {} [{}] chosen: matches override \"{}\"", name, uuid, device_override);
+                return std::move(physical_device);
+            }
             continue;
         }
 
-        if (properties.apiVersion < VK_API_VERSION_1_1)
+        if (!best_device || score > best_score)
         {
-            continue;
+            best_device.emplace(std::move(physical_device));
+            best_score = score;
         }
+    }
+
+    if (!device_override.empty())
+    {
+        throw std::runtime_error(fmt::format("no suitable gpu matches \"{}\"", device_override));
+    }
+
+    if (!best_device)
+    {
+        throw std::runtime_error("no suitable gpu found");
+    }
+
+    BOOST_LOG_TRIVIAL(info) << fmt::format("device {} [{}] chosen: highest score {}", best_device->getProperties().deviceName.data(), GetDeviceUUID(*best_device), best_score);
+    return std::move(*best_device);
+}
 
-        auto required_extensions = CheckExtensionSupported(physical_device, REQUIRED_DEVICE_EXTENSION);
-        if (required_extensions.size() != REQUIRED_DEVICE_EXTENSION.size())
+std::optional<std::string> Hardware::CheckPhysicalDevice(const vk::raii::PhysicalDevice &physical_device) const
+{
+    auto properties = physical_device.getProperties();
+    if (properties.apiVersion < VK_API_VERSION_1_1)
+    {
+        return fmt::format("api version {}.{} is lower than 1.1", VK_API_VERSION_MAJOR(properties.apiVersion), VK_API_VERSION_MINOR(properties.apiVersion));
+    }
+
+    if (!GetFirstQueueIndex(physical_device, vk::QueueFlagBits::eGraphics))
+    {
+        return "no graphics queue family";
+    }
+
+    // swapchain and surface support only matter when there is something to present to
+    if (IsHeadless())
+    {
+        return {};
+    }
+
+    auto required_extensions = CheckExtensionSupported(physical_device, REQUIRED_DEVICE_EXTENSION);
+    if (required_extensions.size() != REQUIRED_DEVICE_EXTENSION.size())
+    {
+        return "missing required device extensions";
+    }
+
+    if (!GetPresentQueueIndex(physical_device, *surface_))
+    {
+        return "no queue family can present to the surface";
+    }
+
+    if (physical_device.getSurfacePresentModesKHR(**surface_).empty())
+    {
+        return "no surface present mode";
+    }
+
+    if (physical_device.getSurfaceFormatsKHR(**surface_).empty())
+    {
+        return "no surface format";
+    }
+
+    return {};
+}
+
+uint64_t Hardware::ScorePhysicalDevice(const vk::raii::PhysicalDevice &physical_device) const
+{
+    auto properties = physical_device.getProperties();
+    auto features = physical_device.getFeatures();
+    auto memory_properties = physical_device.getMemoryProperties();
+    auto queue_families = physical_device.getQueueFamilyProperties();
+
+    // the device type picks the tier, the bonuses below add up to at most 4700 and only
+    // order devices within one tier
+    constexpr uint64_t DEVICE_TYPE_TIER = 1'000'000;
+    uint64_t score = 0;
+    switch (properties.deviceType)
+    {
+        case vk::PhysicalDeviceType::eDiscreteGpu:
+            score += 4 * DEVICE_TYPE_TIER;
+            break;
+        case vk::PhysicalDeviceType::eIntegratedGpu:
+            score += 3 * DEVICE_TYPE_TIER;
+            break;
+        case vk::PhysicalDeviceType::eVirtualGpu:
+            score += 2 * DEVICE_TYPE_TIER;
+            break;
+        case vk::PhysicalDeviceType::eCpu:
+            score += 1 * DEVICE_TYPE_TIER;
+            break;
+        default:
+            break;
+    }
+
+    // 100 points per GiB of the largest device local heap, up to 40 GiB
+    vk::DeviceSize device_local_size = 0;
+    for (uint32_t i = 0; i < memory_properties.memoryHeapCount; i++)
+    {
+        if (memory_properties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal)
         {
-            continue;
+            device_local_size = std::max(device_local_size, memory_properties.memoryHeaps[i].size);
         }
+    }
+    score += std::min<uint64_t>(device_local_size / (1024 * 1024 * 1024) * 100, 4000);
+
+    // async queues let uploads and compute overlap rendering
+    auto has_family = [&](vk::QueueFlags include, vk::QueueFlags exclude)
+    {
+        return std::any_of(queue_families.begin(), queue_families.end(), [&](const auto &family) { return (family.queueFlags & include) == include && !(family.queueFlags & exclude); });
+    };
+    if (has_family(vk::QueueFlagBits::eTransfer, vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))
+    {
+        score += 200;
+    }
+    if (has_family(vk::QueueFlagBits::eCompute, vk::QueueFlagBits::eGraphics))
+    {
+        score += 200;
+    }
+
+    if (features.multiDrawIndirect)
+    {
+        score += 100;
+    }
+    if (features.drawIndirectFirstInstance)
+    {
+        score += 100;
+    }
+    if (properties.apiVersion >= VK_API_VERSION_1_2)
+    {
+        score += 100;
+    }
 
-        auto present_modes = physical_device.getSurfacePresentModesKHR(*surface);
-        if (present_modes.empty())
+    return score;
+}
+
+std::string Hardware::GetDeviceUUID(const vk::raii::PhysicalDevice &physical_device)
+{
+    if (physical_device.getProperties().apiVersion < VK_API_VERSION_1_1)
+    {
+        return "unknown";
+    }
+
+    auto chain = physical_device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+    const auto &uuid = chain.get<vk::PhysicalDeviceIDProperties>().deviceUUID;
+
+    std::string result;
+    for (size_t i = 0; i < uuid.size(); i++)
+    {
+        if (i == 4 || i == 6 || i == 8 || i == 10)
         {
-            continue;
+            result += '-';
         }
+        result += fmt::format("{:02x}", uuid[i]);
+    }
+    return result;
+}
 
-        auto surface_formats = physical_device.getSurfaceFormatsKHR(*surface);
-        if (surface_formats.empty())
+bool Hardware::MatchDeviceOverride(std::string_view name, std::string_view uuid, std::string_view device_override)
+{
+    auto normalize = [](std::string_view text, bool strip_dash)
+    {
+        std::string result;
+        for (auto c : text)
         {
-            continue;
+            if (strip_dash && c == '-')
+            {
+                continue;
+            }
+            result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
         }
+        return result;
+    };
 
-        return std::move(physical_device);
+    if (normalize(uuid, true) == normalize(device_override, true))
+    {
+        return true;
     }
 
-    throw std::runtime_error("no suitable gpu found");
+    return normalize(name, false).find(normalize(device_override, false)) != std::string::npos;
 }
 
 std::vector<std::string> Hardware::CheckExtensionSupported(const vk::raii::PhysicalDevice &physical_device, const std::vector<std::string_view> &desired_extensions) const
@@ -89,14 +273,35 @@ std::vector<std::string> Hardware::CheckExtensionSupported(const vk::raii::Physi
     return result;
 }
 
-vk::raii::Device Hardware::ConstructDevice() const
+vk::PhysicalDeviceFeatures Hardware::ConstructEnabledFeatures() const
+{
+    // nothing here is required, users check GetEnabledFeatures and fall back
+    auto supported = physical_device_.getFeatures();
+    return vk::PhysicalDeviceFeatures
+    {
+        .multiDrawIndirect = supported.multiDrawIndirect,
+        .drawIndirectFirstInstance = supported.drawIndirectFirstInstance,
+        .fillModeNonSolid = supported.fillModeNonSolid,
+    };
+}
+
+std::vector<std::string> Hardware::ConstructEnabledExtensions() const
 {
-    auto required_extensions = CheckExtensionSupported(physical_device_, REQUIRED_DEVICE_EXTENSION);
+    auto extensions = IsHeadless() ? std::vector<std::string>{} : CheckExtensionSupported(physical_device_, REQUIRED_DEVICE_EXTENSION);
     auto optional_extensions = CheckExtensionSupported(physical_device_, OPTIONAL_DEVICE_EXTENSION);
-    
+    extensions.insert(extensions.end(), optional_extensions.begin(), optional_extensions.end());
+    return extensions;
+}
+
+bool Hardware::IsExtensionEnabled(std::string_view extension) const
+{
+    return std::find(enabled_extensions_.begin(), enabled_extensions_.end(), extension) != enabled_extensions_.end();
+}
+
+vk::raii::Device Hardware::ConstructDevice() const
+{
     std::vector<const char *> enable_extensions;
-    std::transform(required_extensions.begin(), required_extensions.end(), std::back_inserter(enable_extensions), [](auto &&ext){ return ext.c_str(); });
-    std::transform(optional_extensions.begin(), optional_extensions.end(), std::back_inserter(enable_extensions), [](auto &&ext){ return ext.c_str(); });
+    std::transform(enabled_extensions_.begin(), enabled_extensions_.end(), std::back_inserter(enable_extensions), [](auto &&ext){ return ext.c_str(); });
 
     auto queue_families = physical_device_.getQueueFamilyProperties();
     std::vector<vk::DeviceQueueCreateInfo> device_queue_create_infos;
@@ -106,8 +311,6 @@ vk::raii::Device Hardware::ConstructDevice() const
         device_queue_create_infos.push_back(vk::DeviceQueueCreateInfo{.queueFamilyIndex = i,.queueCount = 1,.pQueuePriorities = &device_queue_priorities[i]});
     }
 
-    vk::PhysicalDeviceFeatures physical_device_features{};
-
     vk::DeviceCreateInfo device_create_info
     {
         .queueCreateInfoCount = static_cast<uint32_t>(device_queue_create_infos.size()),
@@ -116,7 +319,7 @@ vk::raii::Device Hardware::ConstructDevice() const
         .ppEnabledLayerNames = nullptr,
         .enabledExtensionCount = static_cast<uint32_t>(enable_extensions.size()),
         .ppEnabledExtensionNames = enable_extensions.data(),
-        .pEnabledFeatures = &physical_device_features
+        .pEnabledFeatures = &enabled_features_
     };
 
     return vk::raii::Device(physical_device_, device_create_info);
@@ -139,16 +342,34 @@ std::optional<uint32_t> Hardware::GetQueueIndex(QueueType type) const
     switch (type) 
     {
         case QueueType::PRESENT:
-            return GetPresentQueueIndex(physical_device_, surface_.get());
+            if (IsHeadless())
+            {
+                return {};
+            }
+            return GetPresentQueueIndex(physical_device_, *surface_);
             break;
         case QueueType::GRAPHICS:
             return GetFirstQueueIndex(physical_device_, vk::QueueFlagBits::eGraphics);
             break;
         case QueueType::COMPUTE:
-            throw std::runtime_error("unsupported now");
+            // prefer an async compute family, every graphics family can run compute too
+            if (auto index = GetDedicatedQueueIndex(physical_device_, vk::QueueFlagBits::eCompute, vk::QueueFlagBits::eGraphics); index)
+            {
+                return index;
+            }
+            return GetFirstQueueIndex(physical_device_, vk::QueueFlagBits::eGraphics);
             break;
         case QueueType::TRANSFER:
-            throw std::runtime_error("unsupported now");
+            // prefer a copy engine family, graphics and compute families implicitly support transfer
+            if (auto index = GetDedicatedQueueIndex(physical_device_, vk::QueueFlagBits::eTransfer, vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute); index)
+            {
+                return index;
+            }
+            if (auto index = GetDedicatedQueueIndex(physical_device_, vk::QueueFlagBits::eTransfer, vk::QueueFlagBits::eGraphics); index)
+            {
+                return index;
+            }
+            return GetFirstQueueIndex(physical_device_, vk::QueueFlagBits::eGraphics);
             break;
     }
     return {};
@@ -168,6 +389,35 @@ std::optional<uint32_t> Hardware::GetPresentQueueIndex(const vk::raii::PhysicalD
     return {};
 }
 
+std::unique_lock<std::mutex> Hardware::LockQueue(QueueType type) const
+{
+    return std::unique_lock<std::mutex>(*queue_mutexes_.at(GetQueueIndex(type).value()));
+}
+
+std::vector<std::unique_ptr<std::mutex>> Hardware::ConstructQueueMutexes() const
+{
+    std::vector<std::unique_ptr<std::mutex>> mutexes;
+    for (size_t i = 0; i < physical_device_.getQueueFamilyProperties().size(); i++)
+    {
+        mutexes.push_back(std::make_unique<std::mutex>());
+    }
+    return mutexes;
+}
+
+std::optional<uint32_t> Hardware::GetDedicatedQueueIndex(const vk::raii::PhysicalDevice &physical_device, vk::QueueFlags type, vk::QueueFlags exclude)
+{
+    auto queue_family_properties = physical_device.getQueueFamilyProperties();
+    for (uint32_t i = 0; i < queue_family_properties.size(); i++)
+    {
+        if ((queue_family_properties[i].queueFlags & type) && !(queue_family_properties[i].queueFlags & exclude))
+        {
+            return i;
+        }
+    }
+
+    return {};
+}
+
 std::optional<uint32_t> Hardware::GetFirstQueueIndex(const vk::raii::PhysicalDevice &physical_device, vk::QueueFlags type)
 {
     auto queue_family_properties = physical_device.getQueueFamilyProperties();
@@ -9,6 +9,11 @@
 
 // std
 #include <optional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <string_view>
 
 // vulkan
 #include <vulkan/vulkan.hpp>
@@ -27,28 +32,50 @@ class Hardware : public boost::noncopyable
 public:
     enum class QueueType { PRESENT, GRAPHICS, COMPUTE, TRANSFER };
 
-    Hardware(const vk::raii::Instance &instance, const vk::raii::SurfaceKHR &surface);
+    // device_override picks a device by name substring or uuid instead of the highest score
+    Hardware(const vk::raii::Instance &instance, const vk::raii::SurfaceKHR &surface, std::string_view device_override = {});
+    explicit Hardware(const vk::raii::Instance &instance, std::string_view device_override = {});
     Hardware(Hardware &&other) noexcept;
 
     const vk::raii::Device &GetDevice() const { return device_; }
     const vk::raii::PhysicalDevice &GetPhysicalDevice() const { return physical_device_; }
+    // the subset of optional features that was actually enabled on the device
+    const vk::PhysicalDeviceFeatures &GetEnabledFeatures() const { return enabled_features_; }
+    bool IsExtensionEnabled(std::string_view extension) const;
 
     const std::optional<vk::raii::Queue> GetQueue(QueueType type) const;
     std::optional<uint32_t> GetQueueIndex(QueueType type) const;
 
+    // queues are shared between threads (render, uploads), hold this lock around submit and present
+    std::unique_lock<std::mutex> LockQueue(QueueType type) const;
+
+    bool IsHeadless() const { return surface_ == nullptr; }
+
 private:
-    vk::raii::PhysicalDevice ConstructPhysicalDevice(const vk::raii::Instance &instance, const vk::raii::SurfaceKHR &surface) const;
+    vk::raii::PhysicalDevice ConstructPhysicalDevice(const vk::raii::Instance &instance, std::string_view device_override) const;
+    std::optional<std::string> CheckPhysicalDevice(const vk::raii::PhysicalDevice &physical_device) const;
+    uint64_t ScorePhysicalDevice(const vk::raii::PhysicalDevice &physical_device) const;
+    vk::PhysicalDeviceFeatures ConstructEnabledFeatures() const;
+    std::vector<std::string> ConstructEnabledExtensions() const;
     vk::raii::Device ConstructDevice() const;
+    std::vector<std::unique_ptr<std::mutex>> ConstructQueueMutexes() const;
     std::vector<std::string> CheckExtensionSupported(const vk::raii::PhysicalDevice &physical_device, const std::vector<std::string_view> &desired_extensions) const;
 
 private:
     static std::optional<uint32_t> GetPresentQueueIndex(const vk::raii::PhysicalDevice &physical_device, const vk::raii::SurfaceKHR &surface);
     static std::optional<uint32_t> GetFirstQueueIndex(const vk::raii::PhysicalDevice &physical_device, vk::QueueFlags type);
+    static std::optional<uint32_t> GetDedicatedQueueIndex(const vk::raii::PhysicalDevice &physical_device, vk::QueueFlags type, vk::QueueFlags exclude);
+    static std::string GetDeviceUUID(const vk::raii::PhysicalDevice &physical_device);
+    static bool MatchDeviceOverride(std::string_view name, std::string_view uuid, std::string_view device_override);
 
 private:
-    std::reference_wrapper<const vk::raii::SurfaceKHR> surface_;
+    const vk::raii::SurfaceKHR *surface_;
     vk::raii::PhysicalDevice physical_device_;
+    vk::PhysicalDeviceFeatures enabled_features_;
+    std::vector<std::string> enabled_extensions_;
     vk::raii::Device device_;
+    // one per queue family, only queue 0 of each family is used
+    std::vector<std::unique_ptr<std::mutex>> queue_mutexes_;
 };
 
 }  // namespace lvk
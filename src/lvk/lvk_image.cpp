@@ -0,0 +1,56 @@
+#include "lvk_image.hpp"
+
+// module
+#include "lvk_allocator.hpp"
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+Image::Image(const lvk::Allocator &allocator, vk::ImageCreateInfo create_info, VmaAllocationCreateInfo alloc_info) :
+    allocator_(allocator)
+{
+    VkImage image;
+    auto result = vmaCreateImage(
+        allocator_.get(),
+        reinterpret_cast<vk::ImageCreateInfo::NativeType *>(&create_info),
+        &alloc_info,
+        &image,
+        &allocation_,
+        &allocation_info_);
+
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(fmt::format("vmaCreateImage fail result: {}", result));
+    }
+    image_ = vk::Image(image);
+}
+
+Image::Image(Image &&other) noexcept :
+    allocator_(other.allocator_)
+{
+    std::swap(this->image_, other.image_);
+    std::swap(this->allocation_, other.allocation_);
+    std::swap(this->allocation_info_, other.allocation_info_);
+}
+
+Image &Image::operator=(Image &&other) noexcept
+{
+    allocator_ = other.allocator_;
+    std::swap(this->image_, other.image_);
+    std::swap(this->allocation_, other.allocation_);
+    std::swap(this->allocation_info_, other.allocation_info_);
+    return *this;
+}
+
+Image::~Image()
+{
+    if (allocation_ != VK_NULL_HANDLE)
+    {
+        vmaDestroyImage(allocator_.get(), image_, allocation_);
+    }
+}
+
+}
@@ -0,0 +1,35 @@
+#ifndef _LVK_IMAGE_H
+#define _LVK_IMAGE_H
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// vulkan
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.hpp>
+
+namespace lvk
+{
+class Allocator;
+class Image : public boost::noncopyable
+{
+public:
+    Image(const lvk::Allocator &allocator, vk::ImageCreateInfo create_info, VmaAllocationCreateInfo alloc_info);
+    Image(Image &&other) noexcept;
+    Image &operator=(Image &&other) noexcept;
+
+    ~Image();
+
+    operator vk::Image &() { return image_; }
+    operator const vk::Image &() const { return image_; }
+
+private:
+    std::reference_wrapper<const lvk::Allocator> allocator_;
+
+private:
+    VmaAllocation allocation_{VK_NULL_HANDLE};
+    VmaAllocationInfo allocation_info_;
+    vk::Image image_;
+};
+}
+#endif
@@ -29,7 +29,14 @@ VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBits
 }
 
 Instance::Instance(const vk::raii::Context &context, const lvk::SDLWindow &window) :
-    instance_(ConstructInstance(context, window))
+    instance_(ConstructInstance(context, &window))
+    #ifndef NDEBUG
+    ,debug_messenger_(instance_, {.messageSeverity = ENABLE_MESSAGE_SEVERITY, .messageType = ENABLE_MESSAGE_TYPE, .pfnUserCallback = &DebugCallback})
+    #endif
+{}
+
+Instance::Instance(const vk::raii::Context &context) :
+    instance_(ConstructInstance(context, nullptr))
     #ifndef NDEBUG
     ,debug_messenger_(instance_, {.messageSeverity = ENABLE_MESSAGE_SEVERITY, .messageType = ENABLE_MESSAGE_TYPE, .pfnUserCallback = &DebugCallback})
     #endif
@@ -52,7 +59,7 @@ Instance &Instance::operator=(Instance &&other) noexcept
     return *this;
 }
 
-vk::raii::Instance Instance::ConstructInstance(const vk::raii::Context &context, const lvk::SDLWindow &window)
+vk::raii::Instance Instance::ConstructInstance(const vk::raii::Context &context, const lvk::SDLWindow *window)
 {
     #ifndef NDEBUG
     std::vector<const char *> REQUIRED_LAYERS{ LAYER_NAME_VK_LAYER_KHRONOS_validation.data() };
@@ -65,9 +72,12 @@ vk::raii::Instance Instance::ConstructInstance(const vk::raii::Context &context,
     std::unordered_set<std::string_view> OPTIONAL_LAYERS {};
     std::unordered_set<std::string_view> OPTIONAL_EXTENSIONS{ EXT_NAME_VK_KHR_get_physical_device_properties2.data(), EXT_NAME_VK_KHR_portability_enumeration.data() };
 
-    auto window_extensions = window.GetVulkanInstanceExtensions();
-
-    std::copy(window_extensions.begin(), window_extensions.end(), std::inserter(REQUIRED_EXTENSIONS, REQUIRED_EXTENSIONS.end()));
+    // headless instance does not need any surface extension
+    if (window != nullptr)
+    {
+        auto window_extensions = window->GetVulkanInstanceExtensions();
+        std::copy(window_extensions.begin(), window_extensions.end(), std::inserter(REQUIRED_EXTENSIONS, REQUIRED_EXTENSIONS.end()));
+    }
 
     auto enable_layers = REQUIRED_LAYERS;
     // check optional layers
@@ -17,6 +17,7 @@ class Instance : public boost::noncopyable
 {
 public:
     Instance(const vk::raii::Context &context, const lvk::SDLWindow &window);
+    explicit Instance(const vk::raii::Context &context);
     Instance(Instance &&other) noexcept;
     Instance &operator=(Instance &&other) noexcept;
 
@@ -28,7 +29,7 @@ public:
 
     uint32_t GetApiVersion() const { return api_version_; }
 private:
-    vk::raii::Instance ConstructInstance(const vk::raii::Context &context, const lvk::SDLWindow &window);
+    vk::raii::Instance ConstructInstance(const vk::raii::Context &context, const lvk::SDLWindow *window);
 
 private:
     uint32_t api_version_ = VK_API_VERSION_1_1;
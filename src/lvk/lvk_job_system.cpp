@@ -0,0 +1,427 @@
+#include "lvk_job_system.hpp"
+
+// std
+#include <algorithm>
+#include <exception>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+// which pool and worker the current thread belongs to, pushes from a worker go to its own deque
+static thread_local JobSystem *current_system = nullptr;
+static thread_local uint32_t current_worker = 0;
+
+JobSystem::JobSystem(uint32_t worker_count, std::optional<uint32_t> first_core)
+{
+    auto core_count = std::max(1u, std::thread::hardware_concurrency());
+    if (worker_count == 0)
+    {
+        worker_count = std::max(1u, core_count - 1);
+    }
+
+    // every deque exists before the first worker may try to steal from it
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        std::optional<uint32_t> core;
+        if (first_core)
+        {
+            core = (*first_core + i) % core_count;
+        }
+        workers_[i]->thread = std::thread([this, i, core]() { WorkerLoop(i, core); });
+    }
+    BOOST_LOG_TRIVIAL(info) << fmt::format("job system: {} workers{}", worker_count, first_core ? fmt::format(", pinned from core {}", *first_core) : "");
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_)
+    {
+        worker->thread.join();
+    }
+}
+
+void JobSystem::Run(Job job, JobCounter *counter)
+{
+    if (counter)
+    {
+        counter->count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    Push(Task{std::move(job), counter});
+}
+
+void JobSystem::RunBackground(Job job, JobCounter *counter)
+{
+    if (counter)
+    {
+        counter->count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard lock(background_mutex_);
+        background_.push_back(Task{std::move(job), counter});
+    }
+
+    background_queued_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+}
+
+void JobSystem::RunAfter(JobCounter &dependency, Job job, JobCounter *counter)
+{
+    // counted from now on, so waiting on it also waits for the dependency
+    if (counter)
+    {
+        counter->count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Finish decrements under the same lock, the continuation can't be missed
+    {
+        std::lock_guard lock(dependency.mutex_);
+        if (dependency.count_.load(std::memory_order_acquire) > 0)
+        {
+            dependency.continuations_.push_back(JobCounter::Continuation{std::move(job), counter});
+            return;
+        }
+    }
+    Push(Task{std::move(job), counter});
+}
+
+void JobSystem::Wait(JobCounter &counter)
+{
+    // workers help with anything, nested waits can't starve the pool that way
+    bool is_worker = current_system == this;
+    while (!counter.IsDone())
+    {
+        // read before looking, a job queued after the last look changes it
+        auto generation = generation_.load(std::memory_order_acquire);
+        Task task;
+        if (is_worker ? TryPop(task) : TryPopFor(counter, task))
+        {
+            Execute(task);
+            continue;
+        }
+
+        std::unique_lock lock(sleep_mutex_);
+        waiting_count_++;
+        waiting_.wait(lock, [&]() { return counter.IsDone() || generation_.load(std::memory_order_acquire) != generation; });
+        waiting_count_--;
+    }
+
+    // the last Finish may still hold the lock, the counter can't go away before it let go
+    std::lock_guard lock(counter.mutex_);
+}
+
+void JobSystem::ParallelFor(uint32_t begin, uint32_t end, uint32_t grain, const RangeJob &job)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+
+    auto count = end - begin;
+    auto chunk_count = std::clamp(count / std::max(1u, grain), 1u, GetThreadCount());
+    auto chunk_size = (count + chunk_count - 1) / chunk_count;
+    if (chunk_count == 1)
+    {
+        job(begin, end);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(chunk_count);
+    auto run_chunk = [&](uint32_t chunk)
+    {
+        try
+        {
+            auto chunk_begin = begin + std::min(count, chunk * chunk_size);
+            auto chunk_end = begin + std::min(count, (chunk + 1) * chunk_size);
+            job(chunk_begin, chunk_end);
+        }
+        catch (...)
+        {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    JobCounter counter;
+    for (uint32_t chunk = 1; chunk < chunk_count; chunk++)
+    {
+        Run([&run_chunk, chunk]() { run_chunk(chunk); }, &counter);
+    }
+    run_chunk(0);
+    Wait(counter);
+
+    for (const auto &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+bool JobSystem::PinCurrentThread(uint32_t core)
+{
+    if (core >= std::thread::hardware_concurrency())
+    {
+        return false;
+    }
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core, &cpu_set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#elif defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) != 0;
+#else
+    return false;
+#endif
+}
+
+void JobSystem::Push(Task task)
+{
+    if (current_system == this)
+    {
+        auto &worker = *workers_[current_worker];
+        std::lock_guard lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    else
+    {
+        std::lock_guard lock(injected_mutex_);
+        injected_.push_back(std::move(task));
+    }
+
+    queued_.fetch_add(1, std::memory_order_release);
+    Signal();
+    wake_.notify_one();
+}
+
+bool JobSystem::TryPop(Task &task)
+{
+    if (queued_.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    auto take = [&](std::mutex &mutex, std::deque<Task> &tasks, bool back)
+    {
+        std::lock_guard lock(mutex);
+        if (tasks.empty())
+        {
+            return false;
+        }
+        if (back)
+        {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    };
+
+    // newest own job first, it is the most likely to still be in cache
+    uint32_t first_victim = 0;
+    if (current_system == this)
+    {
+        auto &worker = *workers_[current_worker];
+        if (take(worker.mutex, worker.tasks, true))
+        {
+            return true;
+        }
+        first_victim = current_worker + 1;
+    }
+    if (take(injected_mutex_, injected_, false))
+    {
+        return true;
+    }
+
+    // steal the oldest job, usually the largest piece of a recursive split
+    auto worker_count = static_cast<uint32_t>(workers_.size());
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        auto victim = (first_victim + i) % worker_count;
+        if (current_system == this && victim == current_worker)
+        {
+            continue;
+        }
+        auto &worker = *workers_[victim];
+        if (take(worker.mutex, worker.tasks, false))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::TryPopFor(const JobCounter &counter, Task &task)
+{
+    if (queued_.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    auto take = [&](std::mutex &mutex, std::deque<Task> &tasks)
+    {
+        std::lock_guard lock(mutex);
+        auto it = std::find_if(tasks.begin(), tasks.end(), [&](const Task &queued) { return queued.counter == &counter; });
+        if (it == tasks.end())
+        {
+            return false;
+        }
+        task = std::move(*it);
+        tasks.erase(it);
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    };
+
+    if (take(injected_mutex_, injected_))
+    {
+        return true;
+    }
+    for (auto &worker : workers_)
+    {
+        if (take(worker->mutex, worker->tasks))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::TryPopBackground(Task &task)
+{
+    if (background_queued_.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    std::lock_guard lock(background_mutex_);
+    if (background_.empty())
+    {
+        return false;
+    }
+    task = std::move(background_.front());
+    background_.pop_front();
+    background_queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void JobSystem::Execute(Task &task)
+{
+    try
+    {
+        task.job();
+    }
+    catch (const std::exception &e)
+    {
+        BOOST_LOG_TRIVIAL(error) << fmt::format("job system: job threw: {}", e.what());
+    }
+    catch (...)
+    {
+        BOOST_LOG_TRIVIAL(error) << "job system: job threw an unknown exception";
+    }
+
+    if (task.counter)
+    {
+        Finish(*task.counter);
+    }
+}
+
+void JobSystem::Finish(JobCounter &counter)
+{
+    std::vector<JobCounter::Continuation> ready;
+    {
+        std::lock_guard lock(counter.mutex_);
+        if (counter.count_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+        ready.swap(counter.continuations_);
+    }
+
+    // their counters were incremented by RunAfter already
+    for (auto &continuation : ready)
+    {
+        Push(Task{std::move(continuation.job), continuation.counter});
+    }
+
+    // counter may be gone once a waiting thread saw it at zero, Signal doesn't touch it
+    Signal();
+}
+
+void JobSystem::Signal()
+{
+    // taking the lock orders the change before a sleeping thread checks it again
+    bool waiting = false;
+    {
+        std::lock_guard lock(sleep_mutex_);
+        generation_.fetch_add(1, std::memory_order_release);
+        waiting = waiting_count_ > 0;
+    }
+    if (waiting)
+    {
+        waiting_.notify_all();
+    }
+}
+
+void JobSystem::WorkerLoop(uint32_t index, std::optional<uint32_t> core)
+{
+    current_system = this;
+    current_worker = index;
+    if (core && !PinCurrentThread(*core))
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("job system: failed to pin worker {} to core {}", index, *core);
+    }
+
+    while (true)
+    {
+        // only workers take background jobs, and only once nothing else is queued
+        Task task;
+        if (TryPop(task) || TryPopBackground(task))
+        {
+            Execute(task);
+            continue;
+        }
+
+        auto has_jobs = [&]() { return queued_.load(std::memory_order_acquire) > 0 || background_queued_.load(std::memory_order_acquire) > 0; };
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [&]() { return stop_ || has_jobs(); });
+        if (stop_ && !has_jobs())
+        {
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,130 @@
+#ifndef _LVK_JOB_SYSTEM_H
+#define _LVK_JOB_SYSTEM_H
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace lvk
+{
+
+// Counts the jobs started against it that haven't finished yet, RunAfter holds jobs back
+// until it drops to zero. It may only be destroyed after a Wait on it returned.
+class JobCounter : public boost::noncopyable
+{
+public:
+    bool IsDone() const { return count_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    struct Continuation
+    {
+        std::function<void()> job;
+        JobCounter *counter;
+    };
+
+    std::atomic<uint32_t> count_{0};
+    std::mutex mutex_;
+    std::vector<Continuation> continuations_;
+};
+
+// Fixed pool of worker threads sharing jobs through work stealing. Every worker pushes
+// and pops its own jobs at the back of its deque and steals from the front of the
+// others when it runs dry, jobs started from outside the pool go to a shared queue.
+// Workers waiting on a counter run other jobs meanwhile, so jobs may start and wait
+// for jobs of their own. Other threads only run the jobs of the counter they wait on,
+// a long job never lands on the render thread. Once nothing fits, waiting threads sleep
+// until a job is queued or the counter dropped to zero. Background jobs only run on
+// workers that ran dry, waiting threads never pick them up.
+class JobSystem : public boost::noncopyable
+{
+public:
+    using Job = std::function<void()>;
+    using RangeJob = std::function<void(uint32_t begin, uint32_t end)>;
+
+    // 0 workers picks one per core minus one for the calling thread. With first_core set,
+    // worker i is pinned to core first_core + i, wrapping around the available cores
+    explicit JobSystem(uint32_t worker_count = 0, std::optional<uint32_t> first_core = std::nullopt);
+    // finishes every queued job before joining the workers
+    ~JobSystem();
+
+    // counter is incremented now and decremented once the job returned. Exceptions escaping
+    // a job are logged and dropped, use ParallelFor when they have to reach the caller
+    void Run(Job job, JobCounter *counter = nullptr);
+    // for long jobs that must not stall a waiting thread, like pipeline compiles. Taken by
+    // workers with nothing else queued, a worker running one is busy until it returned
+    void RunBackground(Job job, JobCounter *counter = nullptr);
+    // queues job once dependency dropped to zero, right away when it already has
+    void RunAfter(JobCounter &dependency, Job job, JobCounter *counter = nullptr);
+    // runs queued jobs on the calling thread until counter dropped to zero, only the ones
+    // counted by it unless called from a worker
+    void Wait(JobCounter &counter);
+    // splits [begin, end) into at most one chunk per thread of at least grain items each and
+    // returns once every chunk ran, the calling thread takes the first one. The first exception
+    // thrown by any chunk is rethrown here
+    void ParallelFor(uint32_t begin, uint32_t end, uint32_t grain, const RangeJob &job);
+
+    // workers plus the thread calling Wait or ParallelFor
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(workers_.size()) + 1; }
+
+    // false where thread affinity isn't supported or the core doesn't exist
+    static bool PinCurrentThread(uint32_t core);
+
+private:
+    struct Task
+    {
+        Job job;
+        JobCounter *counter;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    void Push(Task task);
+    bool TryPop(Task &task);
+    bool TryPopFor(const JobCounter &counter, Task &task);
+    bool TryPopBackground(Task &task);
+    void Execute(Task &task);
+    void Finish(JobCounter &counter);
+    void Signal();
+    void WorkerLoop(uint32_t index, std::optional<uint32_t> core);
+
+private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex injected_mutex_;
+    std::deque<Task> injected_;
+    std::mutex background_mutex_;
+    std::deque<Task> background_;
+
+    // jobs pushed and not yet popped, idle workers sleep while it is zero
+    std::atomic<uint32_t> queued_{0};
+    std::atomic<uint32_t> background_queued_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_{false};
+
+    // bumped under sleep_mutex_ on every push and every counter dropping to zero,
+    // threads sleeping in Wait check their counter again when it changed
+    std::atomic<uint64_t> generation_{0};
+    std::condition_variable waiting_;
+    uint32_t waiting_count_{0};
+};
+
+}
+#endif
@@ -0,0 +1,135 @@
+#include "lvk_mapped_file.hpp"
+
+// std
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::filesystem::path &path) :
+    path_(path)
+{
+    file_handle_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE)
+    {
+        file_handle_ = nullptr;
+        throw std::runtime_error(fmt::format("failed to open {}", path.string()));
+    }
+
+    LARGE_INTEGER size{};
+    GetFileSizeEx(file_handle_, &size);
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0)
+    {
+        // empty files can't be mapped, an empty span is all there is to read
+        return;
+    }
+
+    mapping_handle_ = CreateFileMappingW(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    auto *view = mapping_handle_ ? MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr)
+    {
+        if (mapping_handle_)
+        {
+            CloseHandle(mapping_handle_);
+        }
+        CloseHandle(file_handle_);
+        throw std::runtime_error(fmt::format("failed to map {}", path.string()));
+    }
+    data_ = static_cast<const std::byte *>(view);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+    path_(std::move(other.path_)),
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    file_handle_(std::exchange(other.file_handle_, nullptr)),
+    mapping_handle_(std::exchange(other.mapping_handle_, nullptr))
+{}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_)
+    {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_)
+    {
+        CloseHandle(file_handle_);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path &path) :
+    path_(path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error(fmt::format("failed to open {}", path.string()));
+    }
+
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        throw std::runtime_error(fmt::format("failed to stat {}", path.string()));
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ == 0)
+    {
+        // empty files can't be mapped, an empty span is all there is to read
+        close(fd);
+        return;
+    }
+
+    // the mapping keeps the file referenced, the descriptor isn't needed anymore
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error(fmt::format("failed to map {}", path.string()));
+    }
+    data_ = static_cast<const std::byte *>(data);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+    path_(std::move(other.path_)),
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0))
+{}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+        munmap(const_cast<std::byte *>(data_), size_);
+    }
+}
+
+#endif
+
+}
@@ -0,0 +1,40 @@
+#ifndef _LVK_MAPPED_FILE_H
+#define _LVK_MAPPED_FILE_H
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace lvk
+{
+
+// Read only memory mapping of a whole file. The data is page aligned and stays valid
+// until the mapping is destroyed, pages are only read from disk when first touched.
+class MappedFile : public boost::noncopyable
+{
+public:
+    // throws when the file can't be opened or mapped
+    explicit MappedFile(const std::filesystem::path &path);
+    MappedFile(MappedFile &&other) noexcept;
+    ~MappedFile();
+
+    std::span<const std::byte> GetData() const { return {data_, size_}; }
+    size_t Size() const { return size_; }
+    const std::filesystem::path &GetPath() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+    const std::byte *data_{nullptr};
+    size_t size_{0};
+#if defined(_WIN32)
+    void *file_handle_{nullptr};
+    void *mapping_handle_{nullptr};
+#endif
+};
+
+}
+#endif
@@ -0,0 +1,205 @@
+#include "lvk_mesh_cache.hpp"
+
+// module
+#include "lvk_job_system.hpp"
+#include "lvk_mapped_file.hpp"
+#include "lvk_mesh_file.hpp"
+#include "lvk_mesh_lod.hpp"
+#include "lvk_mesh_optimizer.hpp"
+#include "lvk_obj_loader.hpp"
+
+// std
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+// blocks hashed as separate jobs
+constexpr size_t HASH_BLOCK_SIZE = 16 << 20;
+constexpr uint64_t HASH_PRIME_1 = 0x9e3779b185ebca87ull;
+constexpr uint64_t HASH_PRIME_2 = 0xc2b2ae3d27d4eb4full;
+// part of the cache key, bump when converted files change without the layout changing
+constexpr uint64_t CONVERTER_VERSION = 2;
+
+static uint64_t RotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t HashCombine(uint64_t hash, uint64_t value)
+{
+    return RotateLeft(hash ^ (value * HASH_PRIME_1), 31) * HASH_PRIME_2;
+}
+
+// a word at a time, only meant to tell versions of the same file apart
+static uint64_t HashBlock(const std::byte *data, size_t size)
+{
+    uint64_t hash = size;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = HashCombine(hash, word);
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, size - i);
+    hash = HashCombine(hash, tail);
+
+    // spreads the last words over every bit
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME_2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+// fnv-1a
+static uint64_t HashString(const std::string &text)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : text)
+    {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t HashFileContent(const std::filesystem::path &path, lvk::JobSystem *jobs)
+{
+    lvk::MappedFile file(path);
+    auto data = file.GetData();
+    auto block_count = static_cast<uint32_t>((data.size() + HASH_BLOCK_SIZE - 1) / HASH_BLOCK_SIZE);
+    std::vector<uint64_t> block_hashes(block_count);
+    auto hash_blocks = [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            auto offset = i * HASH_BLOCK_SIZE;
+            block_hashes[i] = HashBlock(data.data() + offset, std::min(HASH_BLOCK_SIZE, data.size() - offset));
+        }
+    };
+    if (jobs != nullptr)
+    {
+        jobs->ParallelFor(0, block_count, 1, hash_blocks);
+    }
+    else
+    {
+        hash_blocks(0, block_count);
+    }
+
+    uint64_t hash = data.size();
+    for (auto block_hash : block_hashes)
+    {
+        hash = HashCombine(hash, block_hash);
+    }
+    return hash;
+}
+
+static void ConvertMesh(const std::filesystem::path &source, const std::filesystem::path &output, uint32_t lod_count, lvk::JobSystem *jobs, uint64_t source_hash)
+{
+    auto extension = source.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension != ".obj")
+    {
+        throw std::runtime_error(fmt::format("mesh cache: can't convert {}, only .obj sources are supported", source.string()));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto mesh = lvk::LoadObj(source, jobs);
+    lvk::OptimizeMesh(mesh);
+    auto lods = lvk::BuildLods(mesh.vertices, mesh.indices, lod_count);
+    // coarser lods keep lod 0's triangle order but reference far fewer vertices, reorder them for their own reuse
+    auto vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+    for (size_t lod = 1; lod < lods.size(); lod++)
+    {
+        lvk::OptimizeVertexCache(lods[lod].indices, vertex_count);
+    }
+    lvk::WriteMeshFile(output, mesh.vertices, lods, source_hash);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_LOG_TRIVIAL(info) << fmt::format("mesh cache: converted {} to {} in {:.1f} ms, {} lods, {} to {} triangles",
+                                           source.string(), output.string(), elapsed.count(), lods.size(),
+                                           lods.front().indices.size() / 3, lods.back().indices.size() / 3);
+}
+
+void ConvertMesh(const std::filesystem::path &source, const std::filesystem::path &output, uint32_t lod_count, lvk::JobSystem *jobs)
+{
+    ConvertMesh(source, output, lod_count, jobs, HashFileContent(source, jobs));
+}
+
+MeshCache::MeshCache(std::filesystem::path directory, lvk::JobSystem *jobs, uint32_t lod_count) :
+    directory_(std::move(directory)),
+    jobs_(jobs),
+    lod_count_(lod_count)
+{
+    std::filesystem::create_directories(directory_);
+}
+
+lvk::MeshFile MeshCache::Get(const std::filesystem::path &source)
+{
+    auto content_hash = GetContentHash(source);
+    auto key = HashCombine(HashCombine(HashCombine(content_hash, lvk::MeshFile::GetLayoutHash()), lod_count_), CONVERTER_VERSION);
+    auto output = directory_ / fmt::format("{:016x}.lvkmesh", key);
+    if (std::filesystem::exists(output))
+    {
+        try
+        {
+            lvk::MeshFile file(output);
+            if (file.GetSourceHash() == content_hash)
+            {
+                return file;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            // written by an older build, converted again below
+            BOOST_LOG_TRIVIAL(info) << fmt::format("mesh cache: {}", e.what());
+        }
+    }
+
+    ConvertMesh(source, output, lod_count_, jobs_, content_hash);
+    return lvk::MeshFile(output);
+}
+
+uint64_t MeshCache::GetContentHash(const std::filesystem::path &source)
+{
+    auto size = static_cast<uint64_t>(std::filesystem::file_size(source));
+    auto modified = static_cast<int64_t>(std::filesystem::last_write_time(source).time_since_epoch().count());
+    auto stamp_path = directory_ / fmt::format("{:016x}.stamp", HashString(std::filesystem::absolute(source).lexically_normal().string()));
+
+    // the stamp holds size, modification time and content hash of the source when it was last hashed
+    {
+        std::ifstream stamp(stamp_path);
+        uint64_t stamp_size = 0;
+        int64_t stamp_modified = 0;
+        uint64_t stamp_hash = 0;
+        if (stamp >> stamp_size >> stamp_modified >> stamp_hash && stamp_size == size && stamp_modified == modified)
+        {
+            return stamp_hash;
+        }
+    }
+
+    auto content_hash = HashFileContent(source, jobs_);
+    std::ofstream stamp(stamp_path, std::ios::trunc);
+    stamp << size << ' ' << modified << ' ' << content_hash << '\n';
+    if (!stamp)
+    {
+        // only costs hashing the source again next time
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("mesh cache: failed to write {}", stamp_path.string());
+    }
+    return content_hash;
+}
+
+}
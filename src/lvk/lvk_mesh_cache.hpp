@@ -0,0 +1,50 @@
+#ifndef _LVK_MESH_CACHE_H
+#define _LVK_MESH_CACHE_H
+
+// module
+#include "lvk_mesh_file.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <cstdint>
+#include <filesystem>
+
+namespace lvk
+{
+class JobSystem;
+
+constexpr uint32_t DEFAULT_MESH_LOD_COUNT = 4;
+
+// 64 bit hash of a file's content, fixed size blocks are hashed in parallel on the job
+// system when one is given and combined in order, so the result doesn't depend on it
+uint64_t HashFileContent(const std::filesystem::path &path, lvk::JobSystem *jobs = nullptr);
+
+// loads an .obj source, builds up to lod_count lods and writes them to output as .lvkmesh
+void ConvertMesh(const std::filesystem::path &source, const std::filesystem::path &output, uint32_t lod_count = DEFAULT_MESH_LOD_COUNT, lvk::JobSystem *jobs = nullptr);
+
+// Directory of converted meshes named after the hash of their source's content, the vertex
+// layout and the lod count, so a source is only converted again once one of them changed,
+// wherever it was moved to. The content hash of every source is remembered in a stamp next
+// to the meshes and only recomputed when the source's size or modification time changed.
+class MeshCache : public boost::noncopyable
+{
+public:
+    explicit MeshCache(std::filesystem::path directory, lvk::JobSystem *jobs = nullptr, uint32_t lod_count = DEFAULT_MESH_LOD_COUNT);
+
+    // an up to date .lvkmesh for source, converting it first when there is none. Already
+    // validated, ready to upload. Throws when source can't be read or converted
+    lvk::MeshFile Get(const std::filesystem::path &source);
+
+private:
+    uint64_t GetContentHash(const std::filesystem::path &source);
+
+private:
+    std::filesystem::path directory_;
+    lvk::JobSystem *jobs_;
+    uint32_t lod_count_;
+};
+
+}
+#endif
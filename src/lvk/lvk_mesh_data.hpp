@@ -0,0 +1,22 @@
+#ifndef _LVK_MESH_DATA_H
+#define _LVK_MESH_DATA_H
+
+// module
+#include "lvk_vertex.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lvk
+{
+
+// Indexed triangle list on the cpu, what the loaders produce and Model::FromIndex uploads
+struct MeshData
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+}
+#endif
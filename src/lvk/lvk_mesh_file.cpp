@@ -0,0 +1,227 @@
+#include "lvk_mesh_file.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+// "LVKM"
+constexpr uint32_t MESH_FILE_MAGIC = 0x4d4b564c;
+constexpr uint32_t MESH_FILE_VERSION = 1;
+// streams start aligned to this, the mapping itself is page aligned
+constexpr uint64_t STREAM_ALIGNMENT = 16;
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t layout_hash;
+    uint64_t source_hash;
+    // from the start of the file
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint32_t vertex_count;
+    uint32_t lod_count;
+    std::array<float, 3> bounds_min;
+    std::array<float, 3> bounds_max;
+    std::array<float, 3> bounds_center;
+    float bounds_radius;
+};
+
+// follows the header, one per lod
+struct MeshFileLod
+{
+    // into the index stream, which holds every lod back to back
+    uint32_t first_index;
+    uint32_t index_count;
+    float error;
+    uint32_t reserved;
+};
+
+static uint64_t AlignStream(uint64_t offset)
+{
+    return (offset + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1);
+}
+
+MeshFile::MeshFile(const std::filesystem::path &path) :
+    file_(path)
+{
+    auto data = file_.GetData();
+    MeshFileHeader header;
+    if (data.size() < sizeof(header))
+    {
+        throw std::runtime_error(fmt::format("mesh file: {} is truncated", path.string()));
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != MESH_FILE_MAGIC || header.version != MESH_FILE_VERSION)
+    {
+        throw std::runtime_error(fmt::format("mesh file: {} is no .lvkmesh of version {}", path.string(), MESH_FILE_VERSION));
+    }
+    if (header.layout_hash != GetLayoutHash())
+    {
+        throw std::runtime_error(fmt::format("mesh file: {} was written for another vertex layout", path.string()));
+    }
+
+    // everything is checked against the file size before anything points into it. Counts are
+    // compared to what is left behind an offset, sums of header fields could wrap around
+    auto malformed = [&]() { return std::runtime_error(fmt::format("mesh file: {} is malformed", path.string())); };
+    auto size = static_cast<uint64_t>(data.size());
+    if (header.lod_count == 0 || header.lod_count > (size - sizeof(header)) / sizeof(MeshFileLod))
+    {
+        throw malformed();
+    }
+    auto lod_table_end = sizeof(header) + uint64_t{header.lod_count} * sizeof(MeshFileLod);
+    if (header.vertex_offset % STREAM_ALIGNMENT != 0 || header.vertex_offset < lod_table_end || header.vertex_offset > size ||
+        header.vertex_count > (size - header.vertex_offset) / sizeof(Vertex))
+    {
+        throw malformed();
+    }
+    auto vertex_end = header.vertex_offset + uint64_t{header.vertex_count} * sizeof(Vertex);
+    if (header.index_offset % STREAM_ALIGNMENT != 0 || header.index_offset < vertex_end || header.index_offset > size)
+    {
+        throw malformed();
+    }
+
+    const auto *indices = reinterpret_cast<const uint32_t *>(data.data() + header.index_offset);
+    auto index_capacity = (data.size() - header.index_offset) / sizeof(uint32_t);
+    for (uint32_t i = 0; i < header.lod_count; i++)
+    {
+        MeshFileLod lod;
+        std::memcpy(&lod, data.data() + sizeof(header) + i * sizeof(MeshFileLod), sizeof(lod));
+        if (lod.first_index > index_capacity || lod.index_count > index_capacity - lod.first_index)
+        {
+            throw std::runtime_error(fmt::format("mesh file: lod {} of {} runs past the end of the file", i, path.string()));
+        }
+        // draws index into the shared arena without robustness, an index past the vertices would read other models
+        std::span<const uint32_t> lod_indices(indices + lod.first_index, lod.index_count);
+        if (std::any_of(lod_indices.begin(), lod_indices.end(), [&](uint32_t index) { return index >= header.vertex_count; }))
+        {
+            throw std::runtime_error(fmt::format("mesh file: lod {} of {} is malformed, it indexes past its {} vertices", i, path.string(), header.vertex_count));
+        }
+        lods_.push_back({.indices = lod_indices, .error = lod.error});
+    }
+
+    vertices_ = {reinterpret_cast<const Vertex *>(data.data() + header.vertex_offset), header.vertex_count};
+    bounds_.min = {header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]};
+    bounds_.max = {header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]};
+    bounds_.center = {header.bounds_center[0], header.bounds_center[1], header.bounds_center[2]};
+    bounds_.radius = header.bounds_radius;
+    source_hash_ = header.source_hash;
+}
+
+// the mapping doesn't move, the spans into it stay valid
+MeshFile::MeshFile(MeshFile &&other) noexcept :
+    file_(std::move(other.file_)),
+    vertices_(other.vertices_),
+    lods_(std::move(other.lods_)),
+    bounds_(other.bounds_),
+    source_hash_(other.source_hash_)
+{
+}
+
+std::span<const uint32_t> MeshFile::GetIndices(uint32_t lod) const
+{
+    if (lod >= lods_.size())
+    {
+        throw std::runtime_error(fmt::format("mesh file: lod {} of {}", lod, lods_.size()));
+    }
+    return lods_[lod].indices;
+}
+
+float MeshFile::GetLodError(uint32_t lod) const
+{
+    if (lod >= lods_.size())
+    {
+        throw std::runtime_error(fmt::format("mesh file: lod {} of {}", lod, lods_.size()));
+    }
+    return lods_[lod].error;
+}
+
+uint64_t MeshFile::GetLayoutHash()
+{
+    return FullVertexLayout::HASH;
+}
+
+void WriteMeshFile(const std::filesystem::path &path, std::span<const Vertex> vertices, std::span<const lvk::MeshLod> lods, uint64_t source_hash)
+{
+    if (lods.empty())
+    {
+        throw std::runtime_error(fmt::format("mesh file: {} needs at least one lod", path.string()));
+    }
+
+    std::vector<MeshFileLod> table;
+    uint64_t index_count = 0;
+    for (const auto &lod : lods)
+    {
+        table.push_back({.first_index = static_cast<uint32_t>(index_count), .index_count = static_cast<uint32_t>(lod.indices.size()), .error = lod.error, .reserved = 0});
+        index_count += lod.indices.size();
+    }
+    if (vertices.size() > std::numeric_limits<uint32_t>::max() || index_count > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error(fmt::format("mesh file: {} is too large for 32 bit counts", path.string()));
+    }
+
+    auto bounds = vertices.empty() ? lvk::Bounds{} : ComputeBounds(&vertices[0].posision, vertices.size(), sizeof(Vertex));
+    MeshFileHeader header
+    {
+        .magic = MESH_FILE_MAGIC,
+        .version = MESH_FILE_VERSION,
+        .layout_hash = MeshFile::GetLayoutHash(),
+        .source_hash = source_hash,
+        .vertex_offset = AlignStream(sizeof(MeshFileHeader) + table.size() * sizeof(MeshFileLod)),
+        .index_offset = 0,
+        .vertex_count = static_cast<uint32_t>(vertices.size()),
+        .lod_count = static_cast<uint32_t>(table.size()),
+        .bounds_min = {bounds.min.x, bounds.min.y, bounds.min.z},
+        .bounds_max = {bounds.max.x, bounds.max.y, bounds.max.z},
+        .bounds_center = {bounds.center.x, bounds.center.y, bounds.center.z},
+        .bounds_radius = bounds.radius
+    };
+    header.index_offset = AlignStream(header.vertex_offset + vertices.size_bytes());
+
+    if (path.has_parent_path())
+    {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error(fmt::format("failed to open {}", temporary_path.string()));
+        }
+
+        std::array<char, STREAM_ALIGNMENT> padding{};
+        auto pad_to = [&](uint64_t offset)
+        {
+            file.write(padding.data(), static_cast<std::streamsize>(offset - static_cast<uint64_t>(file.tellp())));
+        };
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(MeshFileLod)));
+        pad_to(header.vertex_offset);
+        file.write(reinterpret_cast<const char *>(vertices.data()), static_cast<std::streamsize>(vertices.size_bytes()));
+        pad_to(header.index_offset);
+        for (const auto &lod : lods)
+        {
+            file.write(reinterpret_cast<const char *>(lod.indices.data()), static_cast<std::streamsize>(lod.indices.size() * sizeof(uint32_t)));
+        }
+        file.flush();
+        if (!file)
+        {
+            throw std::runtime_error(fmt::format("failed to write {}", temporary_path.string()));
+        }
+    }
+    std::filesystem::rename(temporary_path, path);
+}
+
+}
@@ -0,0 +1,65 @@
+#ifndef _LVK_MESH_FILE_H
+#define _LVK_MESH_FILE_H
+
+// module
+#include "lvk_culling.hpp"
+#include "lvk_mapped_file.hpp"
+#include "lvk_mesh_lod.hpp"
+#include "lvk_vertex.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace lvk
+{
+
+// A .lvkmesh file: a header with the format version, the vertex layout hash, the bounds and
+// the hash of the source it was converted from, a lod table, then the vertex stream and the
+// index streams of every lod, all in the layout the geometry arena takes. Nothing is parsed,
+// the streams are uploaded straight out of the mapping. Written by WriteMeshFile, usually
+// through meshconv or the MeshCache.
+class MeshFile : public boost::noncopyable
+{
+public:
+    // throws when the file is malformed, older than this build's format or written for
+    // another vertex layout
+    explicit MeshFile(const std::filesystem::path &path);
+    MeshFile(MeshFile &&other) noexcept;
+
+    std::span<const Vertex> GetVertices() const { return vertices_; }
+    // throws for lods past GetLodCount
+    std::span<const uint32_t> GetIndices(uint32_t lod = 0) const;
+    uint32_t GetLodCount() const { return static_cast<uint32_t>(lods_.size()); }
+    // see MeshLod::error
+    float GetLodError(uint32_t lod) const;
+    const lvk::Bounds &GetBounds() const { return bounds_; }
+    uint64_t GetSourceHash() const { return source_hash_; }
+
+    // FullVertexLayout's, files written with another layout are rejected
+    static uint64_t GetLayoutHash();
+
+private:
+    struct Lod
+    {
+        std::span<const uint32_t> indices;
+        float error;
+    };
+
+    lvk::MappedFile file_;
+    std::span<const Vertex> vertices_;
+    std::vector<Lod> lods_;
+    lvk::Bounds bounds_;
+    uint64_t source_hash_{0};
+};
+
+// lods[0] is the full mesh, every lod indexes vertices. Written next to path and renamed,
+// a reader never sees a partial file
+void WriteMeshFile(const std::filesystem::path &path, std::span<const Vertex> vertices, std::span<const lvk::MeshLod> lods, uint64_t source_hash);
+
+}
+#endif
@@ -0,0 +1,86 @@
+#include "lvk_mesh_lod.hpp"
+
+// module
+#include "lvk_culling.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace lvk
+{
+
+// cells along the longest side of the bounds for the first lod after the full mesh
+constexpr uint32_t FIRST_GRID_RESOLUTION = 256;
+// a lod keeps at most this share of the previous one's triangles, finer grids are skipped
+constexpr float MAX_KEPT_TRIANGLES = 0.75f;
+// not worth another lod below this
+constexpr size_t MIN_LOD_TRIANGLES = 64;
+
+std::vector<lvk::MeshLod> BuildLods(std::span<const Vertex> vertices, std::span<const uint32_t> indices, uint32_t max_lod_count)
+{
+    std::vector<lvk::MeshLod> lods;
+    if (max_lod_count == 0)
+    {
+        return lods;
+    }
+    lods.push_back({.indices = {indices.begin(), indices.end()}, .error = 0.f});
+    if (vertices.empty())
+    {
+        return lods;
+    }
+
+    auto bounds = ComputeBounds(&vertices[0].posision, vertices.size(), sizeof(Vertex));
+    auto extent = bounds.max - bounds.min;
+    auto longest_side = std::max({extent.x, extent.y, extent.z});
+    if (longest_side <= 0.f)
+    {
+        return lods;
+    }
+
+    std::vector<uint32_t> representatives(vertices.size());
+    std::unordered_map<uint64_t, uint32_t> cells;
+    for (uint32_t resolution = FIRST_GRID_RESOLUTION; resolution > 0 && lods.size() < max_lod_count; resolution /= 2)
+    {
+        const auto &previous = lods.back().indices;
+        if (previous.size() / 3 < MIN_LOD_TRIANGLES)
+        {
+            break;
+        }
+
+        // the first vertex in a cell stands in for all of them
+        auto cell_size = longest_side / static_cast<float>(resolution);
+        cells.clear();
+        for (uint32_t i = 0; i < vertices.size(); i++)
+        {
+            auto cell = glm::min(glm::floor((vertices[i].posision - bounds.min) / cell_size), glm::vec3(static_cast<float>(resolution)));
+            auto key = static_cast<uint64_t>(cell.x) | static_cast<uint64_t>(cell.y) << 21 | static_cast<uint64_t>(cell.z) << 42;
+            representatives[i] = cells.try_emplace(key, i).first->second;
+        }
+
+        lvk::MeshLod lod{.indices = {}, .error = cell_size};
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            auto a = representatives[indices[i]];
+            auto b = representatives[indices[i + 1]];
+            auto c = representatives[indices[i + 2]];
+            if (a != b && b != c && c != a)
+            {
+                lod.indices.insert(lod.indices.end(), {a, b, c});
+            }
+        }
+
+        if (lod.indices.empty())
+        {
+            break;
+        }
+        if (lod.indices.size() <= previous.size() * MAX_KEPT_TRIANGLES)
+        {
+            lods.push_back(std::move(lod));
+        }
+    }
+    return lods;
+}
+
+}
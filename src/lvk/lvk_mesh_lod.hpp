@@ -0,0 +1,30 @@
+#ifndef _LVK_MESH_LOD_H
+#define _LVK_MESH_LOD_H
+
+// module
+#include "lvk_vertex.hpp"
+
+// std
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lvk
+{
+
+struct MeshLod
+{
+    std::vector<uint32_t> indices;
+    // size of the grid cells vertices were merged in, 0 for the full detail mesh
+    float error{0.f};
+};
+
+// The full detail mesh followed by coarser versions built by vertex clustering: vertices
+// falling into the same grid cell are merged into the first of them and the triangles that
+// collapse are dropped. Every lod indexes the original vertices, so they share one vertex
+// stream. Each lod halves the grid resolution, grids that barely remove triangles are
+// skipped, it stops at max_lod_count or once a lod is down to a few dozen triangles.
+std::vector<lvk::MeshLod> BuildLods(std::span<const Vertex> vertices, std::span<const uint32_t> indices, uint32_t max_lod_count);
+
+}
+#endif
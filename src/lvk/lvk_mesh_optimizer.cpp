@@ -0,0 +1,464 @@
+#include "lvk_mesh_optimizer.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+
+// Forsyth's tuning, the scores assume a cache a bit larger than the one that is measured
+constexpr uint32_t SCORING_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+// vertices with more triangles left than this score the same
+constexpr uint32_t MAX_SCORED_VALENCE = 32;
+
+constexpr uint32_t NOT_CACHED = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+
+struct ScoreTables
+{
+    std::array<float, SCORING_CACHE_SIZE> cache;
+    std::array<float, MAX_SCORED_VALENCE + 1> valence;
+};
+
+static const ScoreTables &GetScoreTables()
+{
+    static const ScoreTables tables = []()
+    {
+        ScoreTables tables{};
+        for (uint32_t position = 0; position < SCORING_CACHE_SIZE; position++)
+        {
+            // the last triangle's vertices score a bit lower, so the next triangle doesn't just
+            // continue a strip and reuse only two of them
+            tables.cache[position] = position < 3
+                ? LAST_TRIANGLE_SCORE
+                : std::pow(1.f - static_cast<float>(position - 3) / (SCORING_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        for (uint32_t valence = 1; valence <= MAX_SCORED_VALENCE; valence++)
+        {
+            // finishes off vertices with few triangles left instead of leaving them stranded
+            tables.valence[valence] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(valence), -VALENCE_BOOST_POWER);
+        }
+        return tables;
+    }();
+    return tables;
+}
+
+static float VertexScore(const ScoreTables &tables, uint32_t cache_position, uint32_t remaining)
+{
+    if (remaining == 0)
+    {
+        return -1.f;
+    }
+    auto score = cache_position == NOT_CACHED ? 0.f : tables.cache[cache_position];
+    return score + tables.valence[std::min(remaining, MAX_SCORED_VALENCE)];
+}
+
+// fifo cache of cache_size entries: a vertex is still cached while fewer than cache_size
+// vertices were loaded after it, returns whether it had to be loaded
+static bool LoadVertex(std::vector<uint32_t> &timestamps, uint32_t &timestamp, uint32_t cache_size, uint32_t vertex)
+{
+    if (timestamp - timestamps[vertex] > cache_size)
+    {
+        timestamps[vertex] = timestamp++;
+        return true;
+    }
+    return false;
+}
+
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices, uint32_t vertex_count, uint32_t cache_size)
+{
+    VertexCacheStats stats;
+    if (indices.size() < 3)
+    {
+        return stats;
+    }
+
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    std::vector<uint8_t> referenced(vertex_count, 0);
+    uint32_t timestamp = cache_size + 1;
+    size_t transformed = 0;
+    size_t referenced_count = 0;
+    for (auto index : indices)
+    {
+        transformed += LoadVertex(timestamps, timestamp, cache_size, index);
+        referenced_count += referenced[index] == 0;
+        referenced[index] = 1;
+    }
+
+    stats.acmr = static_cast<float>(transformed) / static_cast<float>(indices.size() / 3);
+    stats.atvr = static_cast<float>(transformed) / static_cast<float>(referenced_count);
+    return stats;
+}
+
+void OptimizeVertexCache(std::span<uint32_t> indices, uint32_t vertex_count)
+{
+    auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+    if (triangle_count == 0)
+    {
+        return;
+    }
+    const auto &tables = GetScoreTables();
+
+    // the triangles around every vertex, the first remaining[v] of them aren't emitted yet
+    std::vector<uint32_t> first_triangle(vertex_count + 1, 0);
+    for (size_t i = 0; i < size_t{triangle_count} * 3; i++)
+    {
+        first_triangle[indices[i] + 1]++;
+    }
+    std::vector<uint32_t> remaining(vertex_count);
+    for (uint32_t v = 0; v < vertex_count; v++)
+    {
+        remaining[v] = first_triangle[v + 1];
+        first_triangle[v + 1] += first_triangle[v];
+    }
+    std::vector<uint32_t> adjacency(size_t{triangle_count} * 3);
+    {
+        std::vector<uint32_t> next(first_triangle.begin(), first_triangle.end() - 1);
+        for (uint32_t t = 0; t < triangle_count; t++)
+        {
+            for (int corner = 0; corner < 3; corner++)
+            {
+                adjacency[next[indices[t * 3 + corner]]++] = t;
+            }
+        }
+    }
+
+    std::vector<uint32_t> cache_position(vertex_count, NOT_CACHED);
+    std::vector<float> vertex_score(vertex_count);
+    for (uint32_t v = 0; v < vertex_count; v++)
+    {
+        vertex_score[v] = VertexScore(tables, NOT_CACHED, remaining[v]);
+    }
+    auto triangle_score = [&](uint32_t t)
+    {
+        return vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+    };
+
+    auto best = NO_TRIANGLE;
+    auto best_score = std::numeric_limits<float>::lowest();
+    for (uint32_t t = 0; t < triangle_count; t++)
+    {
+        auto score = triangle_score(t);
+        if (score > best_score)
+        {
+            best = t;
+            best_score = score;
+        }
+    }
+
+    std::vector<uint32_t> output(size_t{triangle_count} * 3);
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    std::array<uint32_t, SCORING_CACHE_SIZE + 3> cache;
+    std::array<uint32_t, SCORING_CACHE_SIZE + 3> new_cache;
+    uint32_t cache_count = 0;
+    uint32_t input_cursor = 0;
+    for (uint32_t emitted_count = 0; emitted_count < triangle_count; emitted_count++)
+    {
+        if (best == NO_TRIANGLE)
+        {
+            // nothing is left around the cache, carry on with the next triangle in input order
+            while (emitted[input_cursor])
+            {
+                input_cursor++;
+            }
+            best = input_cursor;
+        }
+
+        auto t = best;
+        emitted[t] = 1;
+        std::array<uint32_t, 3> corners{indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]};
+        std::copy(corners.begin(), corners.end(), output.begin() + size_t{emitted_count} * 3);
+
+        // the triangle's vertices move to the front of the cache and the others shift back
+        uint32_t new_count = 0;
+        for (auto v : corners)
+        {
+            auto *triangles = &adjacency[first_triangle[v]];
+            auto live = std::find(triangles, triangles + remaining[v], t);
+            std::swap(*live, triangles[--remaining[v]]);
+            if (std::find(new_cache.begin(), new_cache.begin() + new_count, v) == new_cache.begin() + new_count)
+            {
+                new_cache[new_count++] = v;
+            }
+        }
+        for (uint32_t i = 0; i < cache_count; i++)
+        {
+            auto v = cache[i];
+            if (v != corners[0] && v != corners[1] && v != corners[2])
+            {
+                new_cache[new_count++] = v;
+            }
+        }
+
+        // vertices pushed past the end fall out
+        for (uint32_t i = 0; i < new_count; i++)
+        {
+            auto v = new_cache[i];
+            cache_position[v] = i < SCORING_CACHE_SIZE ? i : NOT_CACHED;
+            vertex_score[v] = VertexScore(tables, cache_position[v], remaining[v]);
+        }
+        cache_count = std::min(new_count, SCORING_CACHE_SIZE);
+        std::copy(new_cache.begin(), new_cache.begin() + cache_count, cache.begin());
+
+        // the next triangle is the best scored one around the cache
+        best = NO_TRIANGLE;
+        best_score = std::numeric_limits<float>::lowest();
+        for (uint32_t i = 0; i < cache_count; i++)
+        {
+            auto v = cache[i];
+            for (uint32_t j = 0; j < remaining[v]; j++)
+            {
+                auto candidate = adjacency[first_triangle[v] + j];
+                auto score = triangle_score(candidate);
+                if (score > best_score)
+                {
+                    best = candidate;
+                    best_score = score;
+                }
+            }
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold)
+{
+    OptimizeOverdraw(indices, vertices.empty() ? nullptr : &vertices[0].posision, vertices.size(), sizeof(Vertex), threshold);
+}
+
+void OptimizeOverdraw(std::span<uint32_t> indices, const glm::vec3 *positions, size_t vertex_count, size_t stride, float threshold)
+{
+    auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+    if (triangle_count == 0)
+    {
+        return;
+    }
+
+    auto position = [&](uint32_t index) -> const glm::vec3 &
+    {
+        return *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const std::byte *>(positions) + index * stride);
+    };
+
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    uint32_t timestamp = VERTEX_CACHE_SIZE + 1;
+    auto load_triangle = [&](uint32_t t)
+    {
+        uint32_t misses = 0;
+        for (int corner = 0; corner < 3; corner++)
+        {
+            misses += LoadVertex(timestamps, timestamp, VERTEX_CACHE_SIZE, indices[t * 3 + corner]);
+        }
+        return misses;
+    };
+    auto flush_cache = [&]()
+    {
+        timestamp += VERTEX_CACHE_SIZE + 1;
+    };
+
+    // a triangle missing all of its vertices usually starts a patch disjoint from what came before
+    std::vector<uint32_t> patches;
+    for (uint32_t t = 0; t < triangle_count; t++)
+    {
+        if (load_triangle(t) == 3 || t == 0)
+        {
+            patches.push_back(t);
+        }
+    }
+    patches.push_back(triangle_count);
+
+    // patches are cut into clusters as soon as the cluster's own acmr comes within threshold
+    // of the patch's, every cluster starts with a cold cache as it may end up anywhere
+    std::vector<uint32_t> clusters;
+    for (size_t patch = 0; patch + 1 < patches.size(); patch++)
+    {
+        auto begin = patches[patch];
+        auto end = patches[patch + 1];
+        flush_cache();
+        uint32_t patch_misses = 0;
+        for (auto t = begin; t < end; t++)
+        {
+            patch_misses += load_triangle(t);
+        }
+        auto target = threshold * static_cast<float>(patch_misses) / static_cast<float>(end - begin);
+
+        flush_cache();
+        auto first_cluster = clusters.size();
+        clusters.push_back(begin);
+        uint32_t misses = 0;
+        uint32_t faces = 0;
+        for (auto t = begin; t < end; t++)
+        {
+            misses += load_triangle(t);
+            faces++;
+            if (static_cast<float>(misses) <= target * static_cast<float>(faces) && t + 1 < end)
+            {
+                clusters.push_back(t + 1);
+                flush_cache();
+                misses = 0;
+                faces = 0;
+            }
+        }
+        // a tail that never got efficient enough is merged into the cluster before it
+        if (faces > 0 && static_cast<float>(misses) > target * static_cast<float>(faces) && clusters.size() > first_cluster + 1)
+        {
+            clusters.pop_back();
+        }
+    }
+    clusters.push_back(triangle_count);
+    auto cluster_count = clusters.size() - 1;
+    if (cluster_count < 2)
+    {
+        return;
+    }
+
+    glm::vec3 mesh_center{0.f};
+    for (auto index : indices.first(size_t{triangle_count} * 3))
+    {
+        mesh_center += position(index);
+    }
+    mesh_center /= static_cast<float>(triangle_count * 3);
+
+    // clusters facing away from the center draw first, the area weighted normal and
+    // centroid stand in for the cluster
+    std::vector<float> facing(cluster_count);
+    for (size_t cluster = 0; cluster < cluster_count; cluster++)
+    {
+        glm::vec3 normal{0.f};
+        glm::vec3 centroid{0.f};
+        float area = 0.f;
+        for (auto t = clusters[cluster]; t < clusters[cluster + 1]; t++)
+        {
+            const auto &p0 = position(indices[t * 3]);
+            const auto &p1 = position(indices[t * 3 + 1]);
+            const auto &p2 = position(indices[t * 3 + 2]);
+            auto triangle_normal = glm::cross(p1 - p0, p2 - p0);
+            auto triangle_area = glm::length(triangle_normal);
+            normal += triangle_normal;
+            centroid += (p0 + p1 + p2) * (triangle_area / 3.f);
+            area += triangle_area;
+        }
+        auto normal_length = glm::length(normal);
+        if (area <= 0.f || normal_length <= 0.f)
+        {
+            facing[cluster] = 0.f;
+            continue;
+        }
+        facing[cluster] = glm::dot(centroid / area - mesh_center, normal / normal_length);
+    }
+
+    std::vector<uint32_t> order(cluster_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return facing[a] > facing[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(size_t{triangle_count} * 3);
+    for (auto cluster : order)
+    {
+        output.insert(output.end(), indices.begin() + size_t{clusters[cluster]} * 3, indices.begin() + size_t{clusters[cluster + 1]} * 3);
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+uint32_t RemapVertexFetch(std::span<uint32_t> indices, std::span<uint32_t> remap)
+{
+    std::fill(remap.begin(), remap.end(), UNREFERENCED_VERTEX);
+    uint32_t vertex_count = 0;
+    for (auto &index : indices)
+    {
+        auto &target = remap[index];
+        if (target == UNREFERENCED_VERTEX)
+        {
+            target = vertex_count++;
+        }
+        index = target;
+    }
+    return vertex_count;
+}
+
+void OptimizeVertexFetch(lvk::MeshData &mesh)
+{
+    // a mesh drawn without indices has its order already
+    if (mesh.indices.empty())
+    {
+        return;
+    }
+
+    std::vector<uint32_t> remap(mesh.vertices.size());
+    std::vector<Vertex> vertices(RemapVertexFetch(mesh.indices, remap));
+    for (size_t i = 0; i < remap.size(); i++)
+    {
+        if (remap[i] != UNREFERENCED_VERTEX)
+        {
+            vertices[remap[i]] = mesh.vertices[i];
+        }
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+static void LogReport(const MeshOptimizationReport &report, size_t triangle_count, std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_LOG_TRIVIAL(info) << fmt::format("mesh optimizer: {} triangles in {:.1f} ms, acmr {:.3f} -> {:.3f}, atvr {:.3f} -> {:.3f}",
+                                           triangle_count, elapsed.count(), report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+}
+
+MeshOptimizationReport OptimizeMesh(lvk::MeshData &mesh)
+{
+    MeshOptimizationReport report{.before = {}, .after = {}, .vertex_count = static_cast<uint32_t>(mesh.vertices.size())};
+    if (mesh.indices.size() < 3)
+    {
+        return report;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+    report.before = AnalyzeVertexCache(mesh.indices, vertex_count);
+    OptimizeVertexCache(mesh.indices, vertex_count);
+    OptimizeOverdraw(mesh.indices, mesh.vertices);
+    OptimizeVertexFetch(mesh);
+    report.vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+    report.after = AnalyzeVertexCache(mesh.indices, report.vertex_count);
+    LogReport(report, mesh.indices.size() / 3, start);
+    return report;
+}
+
+MeshOptimizationReport OptimizeIndices(std::span<uint32_t> indices, std::span<const glm::vec3> positions, std::span<uint32_t> remap)
+{
+    MeshOptimizationReport report{.before = {}, .after = {}, .vertex_count = static_cast<uint32_t>(positions.size())};
+    std::iota(remap.begin(), remap.end(), 0);
+    if (indices.size() < 3)
+    {
+        return report;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    report.before = AnalyzeVertexCache(indices, report.vertex_count);
+    OptimizeVertexCache(indices, report.vertex_count);
+    OptimizeOverdraw(indices, positions.data(), positions.size());
+    report.vertex_count = RemapVertexFetch(indices, remap);
+    report.after = AnalyzeVertexCache(indices, report.vertex_count);
+    LogReport(report, indices.size() / 3, start);
+    return report;
+}
+
+}
@@ -0,0 +1,77 @@
+#ifndef _LVK_MESH_OPTIMIZER_H
+#define _LVK_MESH_OPTIMIZER_H
+
+// module
+#include "lvk_mesh_data.hpp"
+#include "lvk_vertex.hpp"
+
+// std
+#include <cstdint>
+#include <limits>
+#include <span>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+
+// fifo entries AnalyzeVertexCache simulates, about what current gpus reuse within a batch
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+    // vertices transformed per triangle, 3 without any reuse, about 0.5 for a well ordered grid
+    float acmr{0.f};
+    // vertices transformed per vertex referenced, 1 is the best possible
+    float atvr{0.f};
+};
+
+// transforms the indices would cause on a fifo post transform cache of cache_size entries
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices, uint32_t vertex_count, uint32_t cache_size = VERTEX_CACHE_SIZE);
+
+// Reorders triangles for post transform cache reuse with Tom Forsyth's linear speed vertex
+// cache optimisation: triangles are emitted greedily by a score favouring vertices recently
+// used and vertices with few triangles left. Doesn't depend on the exact cache size.
+void OptimizeVertexCache(std::span<uint32_t> indices, uint32_t vertex_count);
+
+// Reorders clusters of a cache optimized index buffer so triangles facing away from the
+// mesh's center come first, drawing the outside before what it hides. Clusters are split
+// wherever their acmr is within threshold of the cache optimized order, so the cache
+// efficiency only drops by up to that factor. After Sander et al., "Fast triangle
+// reordering for vertex locality and reduced overdraw"
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold = 1.05f);
+// the same on positions stride bytes apart, for vertices that aren't laid out as Vertex
+void OptimizeOverdraw(std::span<uint32_t> indices, const glm::vec3 *positions, size_t vertex_count, size_t stride = sizeof(glm::vec3), float threshold = 1.05f);
+
+// remap entry of vertices no index references
+constexpr uint32_t UNREFERENCED_VERTEX = std::numeric_limits<uint32_t>::max();
+
+// Renumbers vertices in the order the indices first reference them and rewrites the indices
+// to match. remap gets each old vertex's new index, UNREFERENCED_VERTEX for the unused ones,
+// returns how many are referenced. For vertices written out later in the new order
+uint32_t RemapVertexFetch(std::span<uint32_t> indices, std::span<uint32_t> remap);
+
+// Reorders vertices into the order the indices first reference them, so vertex fetches walk
+// memory forward, drops unreferenced vertices and rewrites the indices to match
+void OptimizeVertexFetch(lvk::MeshData &mesh);
+
+struct MeshOptimizationReport
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+    // vertices the indices reference afterwards
+    uint32_t vertex_count{0};
+};
+
+// the three above in order, logs the cache stats before and after
+MeshOptimizationReport OptimizeMesh(lvk::MeshData &mesh);
+
+// OptimizeMesh for meshes whose vertices are only written out after the indices are known,
+// like loaders converting straight into staging memory. Needs nothing but the positions,
+// remap and the report's vertex_count come from RemapVertexFetch. Without triangles remap
+// is the identity
+MeshOptimizationReport OptimizeIndices(std::span<uint32_t> indices, std::span<const glm::vec3> positions, std::span<uint32_t> remap);
+
+}
+#endif
@@ -1,144 +1,214 @@
 #include "lvk_model.hpp"
 
 // module
-#include "lvk_hardware.hpp"
-#include "lvk_allocator.hpp"
+#include "lvk_mesh_file.hpp"
+#include "lvk_mesh_optimizer.hpp"
+#include "lvk_obj_loader.hpp"
+
+// std
+#include <algorithm>
+#include <utility>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
 
 namespace lvk
 {
 
+// packed models reaching further from their origin than this many radii get a warning
+constexpr float HALF_PRECISION_WARNING = 8.f;
+
+static lvk::Bounds ComputeVertexBounds(std::span<const Vertex> vertices)
+{
+    if (vertices.empty())
+    {
+        return {};
+    }
+    return ComputeBounds(&vertices[0].posision, vertices.size(), sizeof(Vertex));
+}
+
 Model Model::FromVertex(
-    const lvk::Hardware &hardware,
-    const lvk::Allocator& allocator,
-    const vk::raii::CommandPool &command_pool,
+    lvk::GeometryArena &arena,
+    lvk::Uploader &uploader,
     const std::vector<Vertex> &vertices)
 {
-    auto size = sizeof(Vertex) * vertices.size();
-    lvk::Buffer stage_buffer(
-        allocator, 
-        {.size = size, .usage = vk::BufferUsageFlagBits::eTransferSrc,.sharingMode = vk::SharingMode::eExclusive},
-        {.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,.usage = VMA_MEMORY_USAGE_AUTO});
-
-    lvk::Buffer buffer(
-        allocator, 
-        {.size = size, .usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst, .sharingMode = vk::SharingMode::eExclusive},
-        {.usage =  VMA_MEMORY_USAGE_AUTO,});
-    
-    auto data = stage_buffer.MapMemory();
-    memcpy(data, vertices.data(), size);
-    stage_buffer.UnmapMemory();
-    CopyBuffer(hardware, command_pool, stage_buffer, buffer, size);
-
-    return Model(vertices.size(), size, 0, 0, std::move(buffer));
+    return FromSpans(arena, uploader, vertices, {}, ComputeVertexBounds(vertices));
 }
 
 Model Model::FromIndex(
-    const lvk::Hardware &hardware,
-    const lvk::Allocator& allocator,
-    const vk::raii::CommandPool &command_pool,
+    lvk::GeometryArena &arena,
+    lvk::Uploader &uploader,
     const std::vector<Vertex> &vertices,
     const std::vector<uint32_t> &indices)
 {
-    auto vertices_size = sizeof(Vertex) * vertices.size();
-    auto indices_size = sizeof(uint32_t) * indices.size();
-    lvk::Buffer stage_buffer(
-        allocator, 
-        {.size = vertices_size + indices_size, .usage = vk::BufferUsageFlagBits::eTransferSrc,.sharingMode = vk::SharingMode::eExclusive},
-        {.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,.usage = VMA_MEMORY_USAGE_AUTO});
-
-    lvk::Buffer buffer(
-        allocator,
-        {.size = vertices_size + indices_size, .usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst, .sharingMode = vk::SharingMode::eExclusive},
-        {.usage =  VMA_MEMORY_USAGE_AUTO,});
-
-    auto data = static_cast<std::byte *>(stage_buffer.MapMemory());
-    memcpy(data, vertices.data(), vertices_size + indices_size);
-    data += vertices_size;
-    memcpy(data, indices.data(), indices_size);
-    stage_buffer.UnmapMemory();
-    CopyBuffer(hardware, command_pool, stage_buffer, buffer, vertices_size + indices_size);
-    return Model(vertices.size(), vertices_size, indices.size(), indices_size, std::move(buffer));
+    return FromSpans(arena, uploader, vertices, indices, ComputeVertexBounds(vertices));
 }
 
-void Model::CopyBuffer(
-    const lvk::Hardware &hardware,
-    const vk::raii::CommandPool &command_pool,
-    const lvk::Buffer &src_buffer,
-    const lvk::Buffer & dest_buffer,
-    uint64_t size)
+Model Model::FromWriters(
+    lvk::GeometryArena &arena,
+    lvk::Uploader &uploader,
+    uint32_t vertex_count,
+    uint32_t index_count,
+    const VertexWriter &write_vertices,
+    const IndexWriter &write_indices,
+    const lvk::Bounds &bounds)
 {
-    auto command_buffers = hardware.GetDevice().allocateCommandBuffers(vk::CommandBufferAllocateInfo
+    if (arena.GetVertexFormat() != VertexFormat::FULL || arena.GetIndexType() != vk::IndexType::eUint32)
     {
-        .commandPool = *command_pool,
-        .level = vk::CommandBufferLevel::ePrimary,
-        .commandBufferCount = 1,
-    });
-
-    auto &command_buffer = command_buffers[0];
-    command_buffer.begin(vk::CommandBufferBeginInfo{.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
-    vk::BufferCopy region
-    {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size = size
-    };
-
-    vk::ArrayProxy<const vk::BufferCopy> regions(region);
-    command_buffer.copyBuffer(src_buffer, dest_buffer, regions);
-    command_buffer.end();
-    
-    vk::ArrayProxy<const vk::CommandBuffer> submit_buffers(*command_buffer);
-    vk::SubmitInfo submit_info
+        // the writers produce Vertex and 32 bit indices, they are converted on the way into staging
+        std::vector<Vertex> vertices(vertex_count);
+        std::vector<uint32_t> indices(index_count);
+        write_vertices(vertices);
+        if (index_count > 0)
+        {
+            write_indices(indices);
+        }
+        return FromSpans(arena, uploader, vertices, indices, bounds);
+    }
+
+    auto handle = arena.Allocate(vertex_count, index_count);
+    auto range = arena.GetRange(handle);
+
+    auto ticket = uploader.EnqueueWrite(
+        sizeof(Vertex) * vertex_count,
+        arena.GetVertexBuffer(),
+        sizeof(Vertex) * range.first_vertex,
+        vk::AccessFlagBits::eVertexAttributeRead,
+        vk::PipelineStageFlagBits::eVertexInput,
+        [&](std::span<std::byte> staging)
+        {
+            write_vertices(std::span<Vertex>(reinterpret_cast<Vertex *>(staging.data()), vertex_count));
+        });
+
+    if (index_count > 0)
     {
-        .commandBufferCount = submit_buffers.size(),
-        .pCommandBuffers = submit_buffers.data(),
-    };
-    vk::ArrayProxy<const vk::SubmitInfo> submit_infos(submit_info);
+        ticket = uploader.EnqueueWrite(
+            sizeof(uint32_t) * index_count,
+            arena.GetIndexBuffer(),
+            sizeof(uint32_t) * range.first_index,
+            vk::AccessFlagBits::eIndexRead,
+            vk::PipelineStageFlagBits::eVertexInput,
+            [&](std::span<std::byte> staging)
+            {
+                write_indices(std::span<uint32_t>(reinterpret_cast<uint32_t *>(staging.data()), index_count));
+            });
+    }
 
-    hardware.GetQueue(Hardware::QueueType::GRAPHICS)->submit(submit_infos);
-    hardware.GetDevice().waitIdle();
+    return Model(arena, handle, uploader, ticket, bounds);
 }
 
-Model::Model(uint32_t vertices_count, size_t vertices_size, uint32_t indices_count, size_t indices_size, lvk::Buffer buffer) :
-    vertices_count_(vertices_count),
-    vertices_size_(vertices_size),
-    indices_count_(indices_count),
-    indices_size_(indices_size),
-    buffer_(std::move(buffer))
+Model Model::FromObjFile(
+    lvk::GeometryArena &arena,
+    lvk::Uploader &uploader,
+    const std::filesystem::path &path,
+    lvk::JobSystem *jobs)
 {
+    auto mesh = lvk::LoadObj(path, jobs);
+    lvk::OptimizeMesh(mesh);
+    return FromIndex(arena, uploader, mesh.vertices, mesh.indices);
 }
 
-Model::Model(Model &&other) noexcept :
-    vertices_count_(other.vertices_count_),
-    vertices_size_(other.vertices_size_),
-    indices_count_(other.indices_count_),
-    indices_size_(other.indices_size_),
-    buffer_(std::move(other.buffer_))
+Model Model::FromMeshFile(
+    lvk::GeometryArena &arena,
+    lvk::Uploader &uploader,
+    const lvk::MeshFile &file,
+    uint32_t lod)
 {
+    // staged straight out of the mapping
+    return FromSpans(arena, uploader, file.GetVertices(), file.GetIndices(std::min(lod, file.GetLodCount() - 1)), file.GetBounds());
 }
 
-void Model::Draw(const vk::raii::CommandBuffer &command_buffer)
+Model Model::FromSpans(
+    lvk::GeometryArena &arena,
+    lvk::Uploader &uploader,
+    std::span<const Vertex> vertices,
+    std::span<const uint32_t> indices,
+    const lvk::Bounds &bounds)
 {
-    if (indices_count_ > 0) 
+    auto vertex_format = arena.GetVertexFormat();
+    auto index_type = arena.GetIndexType();
+    if (vertex_format == VertexFormat::PACKED)
     {
-        command_buffer.drawIndexed(indices_count_, 1, 0, 0, 0);
+        // half floats step by about a thousandth of the largest coordinate
+        auto extent = glm::max(glm::abs(bounds.min), glm::abs(bounds.max));
+        auto largest = std::max({extent.x, extent.y, extent.z});
+        if (largest > HALF_PRECISION_WARNING * bounds.radius)
+        {
+            BOOST_LOG_TRIVIAL(warning) << fmt::format("model: positions reach {} for a radius of {}, half float positions will look coarse", largest, bounds.radius);
+        }
     }
-    else 
+
+    auto handle = arena.Allocate(vertices.size(), indices.size());
+    auto range = arena.GetRange(handle);
+
+    auto ticket = uploader.EnqueueWrite(
+        arena.GetVertexStride() * vertices.size(),
+        arena.GetVertexBuffer(),
+        arena.GetVertexStride() * range.first_vertex,
+        vk::AccessFlagBits::eVertexAttributeRead,
+        vk::PipelineStageFlagBits::eVertexInput,
+        [&](std::span<std::byte> staging)
+        {
+            PackVertices(vertices, vertex_format, staging);
+        });
+
+    if (!indices.empty())
     {
-        command_buffer.draw(vertices_count_, 1, 0, 0);
+        ticket = uploader.EnqueueWrite(
+            arena.GetIndexSize() * indices.size(),
+            arena.GetIndexBuffer(),
+            arena.GetIndexSize() * range.first_index,
+            vk::AccessFlagBits::eIndexRead,
+            vk::PipelineStageFlagBits::eVertexInput,
+            [&](std::span<std::byte> staging)
+            {
+                PackIndices(indices, index_type, staging);
+            });
     }
+
+    return Model(arena, handle, uploader, ticket, bounds);
 }
 
-void Model::BindBuffer(const vk::raii::CommandBuffer &command_buffer)
+Model::Model(lvk::GeometryArena &arena, lvk::GeometryArena::Handle handle, const lvk::Uploader &uploader, lvk::Uploader::Ticket upload_ticket, const lvk::Bounds &bounds) :
+    arena_(&arena),
+    handle_(handle),
+    uploader_(&uploader),
+    upload_ticket_(upload_ticket),
+    bounds_(bounds)
 {
-    uint64_t offset = 0;
-    vk::ArrayProxy<const vk::Buffer> buffers(buffer_);
-    vk::ArrayProxy<vk::DeviceSize> offsets(offset);
-    command_buffer.bindVertexBuffers(0, buffers, offsets);
+}
+
+Model::Model(Model &&other) noexcept :
+    arena_(std::exchange(other.arena_, nullptr)),
+    handle_(other.handle_),
+    uploader_(other.uploader_),
+    upload_ticket_(other.upload_ticket_),
+    bounds_(other.bounds_)
+{
+}
+
+Model::~Model()
+{
+    if (arena_ != nullptr)
+    {
+        arena_->Free(handle_);
+    }
+}
 
-    if (indices_count_ > 0)
+void Model::Draw(const vk::raii::CommandBuffer &command_buffer, uint32_t instance_count, uint32_t first_instance) const
+{
+    auto range = GetRange();
+    if (range.index_count > 0) 
+    {
+        command_buffer.drawIndexed(range.index_count, instance_count, range.first_index, range.first_vertex, first_instance);
+    }
+    else 
     {
-        command_buffer.bindIndexBuffer(buffer_, vertices_size_, vk::IndexType::eUint32);
+        command_buffer.draw(range.vertex_count, instance_count, range.first_vertex, first_instance);
     }
 }
-}
\ No newline at end of file
+
+}
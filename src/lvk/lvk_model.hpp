@@ -3,10 +3,15 @@
 
 // module
 #include "lvk_vertex.hpp"
-#include "lvk_buffer.hpp"
+#include "lvk_uploader.hpp"
+#include "lvk_geometry_arena.hpp"
+#include "lvk_culling.hpp"
 
 // std
+#include <filesystem>
+#include <functional>
 #include <optional>
+#include <span>
 
 // boost
 #include <boost/noncopyable.hpp>
@@ -18,54 +23,86 @@
 
 namespace lvk
 {
-class Hardware;
-class Allocator;
+class JobSystem;
+class MeshFile;
+
+// A range of the shared geometry arena, the model owns no buffer of its own
 class Model : public boost::noncopyable
 {
 public:
+    // the data is only staged, the model becomes drawable once the uploader reports it resident
     static Model FromVertex(
-        const lvk::Hardware &hardware,
-        const lvk::Allocator& allocator,
-        const vk::raii::CommandPool &command_pool,
+        lvk::GeometryArena &arena,
+        lvk::Uploader &uploader,
         const std::vector<Vertex> &vertices);
     
+    // uploads the data in the order given. Imported meshes should go through OptimizeMesh
+    // first, the loaders below do that themselves
     static Model FromIndex(
-        const lvk::Hardware &hardware,
-        const lvk::Allocator& allocator,
-        const vk::raii::CommandPool &command_pool,
+        lvk::GeometryArena &arena,
+        lvk::Uploader &uploader,
         const std::vector<Vertex> &vertices,
         const std::vector<uint32_t> &indices);
 
-    /*
+    // vertices and indices are written straight into staging memory, saving a copy for data
+    // that has to be converted anyway. The writers get exactly vertex_count and index_count
+    // elements, with an index_count of 0 the model draws without indices. Arenas in another
+    // format than Vertex and 32 bit indices take a copy to convert from after all
+    using VertexWriter = std::function<void(std::span<Vertex> vertices)>;
+    using IndexWriter = std::function<void(std::span<uint32_t> indices)>;
+    static Model FromWriters(
+        lvk::GeometryArena &arena,
+        lvk::Uploader &uploader,
+        uint32_t vertex_count,
+        uint32_t index_count,
+        const VertexWriter &write_vertices,
+        const IndexWriter &write_indices,
+        const lvk::Bounds &bounds);
+
+    // parses on the job system when one is given, see LoadObj, then runs OptimizeMesh
     static Model FromObjFile(
-        const lvk::Device &device,
-        const lvk::Allocator& allocator,
-        std::string_view path);
-    */
+        lvk::GeometryArena &arena,
+        lvk::Uploader &uploader,
+        const std::filesystem::path &path,
+        lvk::JobSystem *jobs = nullptr);
+
+    // uploads one lod of a converted mesh without any parsing, lods past the coarsest one
+    // pick the coarsest. The file may be closed once this returns
+    static Model FromMeshFile(
+        lvk::GeometryArena &arena,
+        lvk::Uploader &uploader,
+        const lvk::MeshFile &file,
+        uint32_t lod = 0);
 
     Model(Model &&other) noexcept;
+    ~Model();
 
 public:
-    void BindBuffer(const vk::raii::CommandBuffer &command_buffer);
-    void Draw(const vk::raii::CommandBuffer &command_buffer);
+    // expects the arena buffers to be bound, see GeometryArena::BindBuffers
+    void Draw(const vk::raii::CommandBuffer &command_buffer, uint32_t instance_count = 1, uint32_t first_instance = 0) const;
+
+    bool IsResident() const { return uploader_->IsResident(upload_ticket_); }
+    lvk::GeometryArena::Range GetRange() const { return arena_->GetRange(handle_); }
+    const lvk::Bounds &GetBounds() const { return bounds_; }
 
 private:
-    Model(uint32_t vertices_count, size_t vertices_size, uint32_t indices_count, size_t indices_size, lvk::Buffer buffer);
+    // converts into the arena's vertex format and index type while staging
+    static Model FromSpans(
+        lvk::GeometryArena &arena,
+        lvk::Uploader &uploader,
+        std::span<const Vertex> vertices,
+        std::span<const uint32_t> indices,
+        const lvk::Bounds &bounds);
 
-    static void CopyBuffer(
-        const lvk::Hardware &hardware,
-        const vk::raii::CommandPool &command_pool,
-        const lvk::Buffer &src_buffer,
-        const lvk::Buffer & dest_buffer,
-        uint64_t size);
+    Model(lvk::GeometryArena &arena, lvk::GeometryArena::Handle handle, const lvk::Uploader &uploader, lvk::Uploader::Ticket upload_ticket, const lvk::Bounds &bounds);
 
 private:
-    uint32_t vertices_count_{0};
-    size_t vertices_size_{0};
-    uint32_t indices_count_{0};
-    size_t indices_size_{0};
+    lvk::GeometryArena *arena_;
+    lvk::GeometryArena::Handle handle_;
 
-    lvk::Buffer buffer_;
+    const lvk::Uploader *uploader_;
+    lvk::Uploader::Ticket upload_ticket_;
+    lvk::Bounds bounds_;
 };
 }
 
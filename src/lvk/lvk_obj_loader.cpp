@@ -0,0 +1,587 @@
+#include "lvk_obj_loader.hpp"
+
+// module
+#include "lvk_job_system.hpp"
+#include "lvk_mapped_file.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+// smaller chunks aren't worth a job
+constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+// faces take longer to parse than positions and usually come last, more chunks than threads
+// keep every thread busy until the end
+constexpr size_t CHUNKS_PER_THREAD = 4;
+// negative indices count back from the positions parsed so far, a chunk only knows its own.
+// They are stored as RELATIVE_REF plus the chunk relative index until the chunk bases are known
+constexpr int64_t RELATIVE_REF = int64_t{1} << 40;
+constexpr int64_t NO_REF = -1;
+constexpr uint32_t NO_NORMAL = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+constexpr std::array<double, 23> POWERS_OF_TEN
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+struct ObjChunk
+{
+    // starts at a line start, ends after a newline or at the end of the file
+    const char *begin{nullptr};
+    const char *end{nullptr};
+
+    std::vector<glm::vec3> positions;
+    // empty until the chunk saw a colored position, one per position after that
+    std::vector<glm::vec3> colors;
+    std::vector<glm::vec3> normals;
+    // three per triangle, absolute after ResolveChunk
+    std::vector<int64_t> position_refs;
+    std::vector<int64_t> normal_refs;
+
+    // where the chunk's positions, normals and indices start in the whole mesh
+    size_t position_base{0};
+    size_t normal_base{0};
+    size_t index_base{0};
+
+    std::string error;
+    // counted from begin, empty for errors found after parsing
+    std::optional<size_t> error_line;
+};
+
+static bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static void SkipSpaces(const char *&it, const char *end)
+{
+    while (it != end && IsSpace(*it))
+    {
+        it++;
+    }
+}
+
+// a token ends at whitespace, a comment or the end of the line
+static bool AtTokenEnd(const char *it, const char *end)
+{
+    return it == end || IsSpace(*it) || *it == '#';
+}
+
+// decimal and scientific notation. Digits past the 19th are dropped, far below float precision,
+// the result is then scaled by an exact power of ten where there is one
+static bool ParseFloat(const char *&it, const char *end, float &value)
+{
+    const char *p = it;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    int digits = 0;
+    bool any_digit = false;
+    for (; p != end && IsDigit(*p); p++)
+    {
+        any_digit = true;
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            digits += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if (p != end && *p == '.')
+    {
+        for (p++; p != end && IsDigit(*p); p++)
+        {
+            any_digit = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (!any_digit)
+    {
+        return false;
+    }
+
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negative_exponent = false;
+        if (p != end && (*p == '-' || *p == '+'))
+        {
+            negative_exponent = *p == '-';
+            p++;
+        }
+        if (p == end || !IsDigit(*p))
+        {
+            return false;
+        }
+        int64_t written = 0;
+        for (; p != end && IsDigit(*p); p++)
+        {
+            written = std::min<int64_t>(written * 10 + (*p - '0'), 100000);
+        }
+        exponent += negative_exponent ? -written : written;
+    }
+
+    auto result = static_cast<double>(mantissa);
+    if (mantissa != 0 && exponent != 0)
+    {
+        if (exponent > 0 && exponent < static_cast<int64_t>(POWERS_OF_TEN.size()))
+        {
+            result *= POWERS_OF_TEN[exponent];
+        }
+        else if (exponent < 0 && -exponent < static_cast<int64_t>(POWERS_OF_TEN.size()))
+        {
+            result /= POWERS_OF_TEN[-exponent];
+        }
+        else
+        {
+            result *= std::pow(10.0, static_cast<double>(exponent));
+        }
+    }
+    value = static_cast<float>(negative ? -result : result);
+    it = p;
+    return true;
+}
+
+static bool ParseIndex(const char *&it, const char *end, int64_t &value)
+{
+    const char *p = it;
+    bool negative = p != end && *p == '-';
+    if (p != end && (*p == '-' || *p == '+'))
+    {
+        p++;
+    }
+    if (p == end || !IsDigit(*p))
+    {
+        return false;
+    }
+    int64_t result = 0;
+    for (; p != end && IsDigit(*p); p++)
+    {
+        result = std::min<int64_t>(result * 10 + (*p - '0'), RELATIVE_REF / 4);
+    }
+    value = negative ? -result : result;
+    it = p;
+    return true;
+}
+
+// obj indices are 1 based, negative ones count back from the last one parsed
+static bool ToRef(int64_t index, size_t parsed_count, int64_t &ref)
+{
+    if (index > 0)
+    {
+        ref = index - 1;
+    }
+    else if (index < 0)
+    {
+        ref = RELATIVE_REF + static_cast<int64_t>(parsed_count) + index;
+    }
+    return index != 0;
+}
+
+static bool ParseFloats(const char *&it, const char *end, std::span<float> values, size_t &count)
+{
+    count = 0;
+    for (SkipSpaces(it, end); !AtTokenEnd(it, end); SkipSpaces(it, end))
+    {
+        if (count == values.size() || !ParseFloat(it, end, values[count]) || !AtTokenEnd(it, end))
+        {
+            return false;
+        }
+        count++;
+    }
+    return true;
+}
+
+static bool ParsePosition(ObjChunk &chunk, const char *it, const char *end)
+{
+    // x y z, x y z w or x y z r g b
+    std::array<float, 6> values;
+    size_t count;
+    if (!ParseFloats(it, end, values, count) || (count != 3 && count != 4 && count != 6))
+    {
+        chunk.error = "expected 3, 4 or 6 numbers after v";
+        return false;
+    }
+
+    chunk.positions.emplace_back(values[0], values[1], values[2]);
+    if (count == 6)
+    {
+        chunk.colors.resize(chunk.positions.size() - 1, glm::vec3(1.f));
+        chunk.colors.emplace_back(values[3], values[4], values[5]);
+    }
+    else if (!chunk.colors.empty())
+    {
+        chunk.colors.emplace_back(1.f);
+    }
+    return true;
+}
+
+static bool ParseNormal(ObjChunk &chunk, const char *it, const char *end)
+{
+    std::array<float, 3> values;
+    size_t count;
+    if (!ParseFloats(it, end, values, count) || count != 3)
+    {
+        chunk.error = "expected 3 numbers after vn";
+        return false;
+    }
+    chunk.normals.emplace_back(values[0], values[1], values[2]);
+    return true;
+}
+
+static bool ParseFace(ObjChunk &chunk, const char *it, const char *end)
+{
+    // p, p/t, p//n or p/t/n per corner, texture coordinates aren't part of a Vertex
+    std::array<int64_t, 2> first{};
+    std::array<int64_t, 2> previous{};
+    uint32_t corner_count = 0;
+    for (SkipSpaces(it, end); !AtTokenEnd(it, end); SkipSpaces(it, end))
+    {
+        int64_t position_index;
+        int64_t texture_index;
+        int64_t normal_index = 0;
+        bool valid = ParseIndex(it, end, position_index);
+        if (valid && it != end && *it == '/')
+        {
+            it++;
+            if (it != end && *it != '/')
+            {
+                valid = ParseIndex(it, end, texture_index);
+            }
+            if (valid && it != end && *it == '/')
+            {
+                it++;
+                valid = ParseIndex(it, end, normal_index) && normal_index != 0;
+            }
+        }
+
+        std::array<int64_t, 2> corner{0, NO_REF};
+        valid = valid && AtTokenEnd(it, end) && ToRef(position_index, chunk.positions.size(), corner[0]);
+        if (valid && normal_index != 0)
+        {
+            ToRef(normal_index, chunk.normals.size(), corner[1]);
+        }
+        if (!valid)
+        {
+            chunk.error = "malformed face corner";
+            return false;
+        }
+
+        // fan around the first corner
+        if (corner_count >= 2)
+        {
+            for (const auto &triangle_corner : {first, previous, corner})
+            {
+                chunk.position_refs.push_back(triangle_corner[0]);
+                chunk.normal_refs.push_back(triangle_corner[1]);
+            }
+        }
+        else if (corner_count == 0)
+        {
+            first = corner;
+        }
+        previous = corner;
+        corner_count++;
+    }
+
+    if (corner_count < 3)
+    {
+        chunk.error = "face with less than 3 corners";
+        return false;
+    }
+    return true;
+}
+
+static bool ParseLine(ObjChunk &chunk, const char *it, const char *end)
+{
+    SkipSpaces(it, end);
+    const char *keyword_begin = it;
+    while (!AtTokenEnd(it, end))
+    {
+        it++;
+    }
+
+    std::string_view keyword(keyword_begin, static_cast<size_t>(it - keyword_begin));
+    if (keyword == "v")
+    {
+        return ParsePosition(chunk, it, end);
+    }
+    if (keyword == "vn")
+    {
+        return ParseNormal(chunk, it, end);
+    }
+    if (keyword == "f")
+    {
+        return ParseFace(chunk, it, end);
+    }
+    // comments, texture coordinates, objects, groups, materials, smoothing groups, lines and points
+    return true;
+}
+
+static void ParseChunk(ObjChunk &chunk)
+{
+    try
+    {
+        const char *it = chunk.begin;
+        for (size_t line = 0; it != chunk.end; line++)
+        {
+            const auto *newline = static_cast<const char *>(std::memchr(it, '\n', static_cast<size_t>(chunk.end - it)));
+            const char *line_end = newline != nullptr ? newline : chunk.end;
+            if (!ParseLine(chunk, it, line_end))
+            {
+                chunk.error_line = line;
+                return;
+            }
+            it = newline != nullptr ? newline + 1 : chunk.end;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        chunk.error = e.what();
+    }
+}
+
+static bool ResolveRef(int64_t &ref, size_t base, size_t count)
+{
+    if (ref >= RELATIVE_REF / 2)
+    {
+        ref = ref - RELATIVE_REF + static_cast<int64_t>(base);
+    }
+    return ref >= 0 && ref < static_cast<int64_t>(count);
+}
+
+// turns the refs into indices into the whole mesh's positions and normals
+static void ResolveChunk(ObjChunk &chunk, size_t position_count, size_t normal_count)
+{
+    for (size_t i = 0; i < chunk.position_refs.size(); i++)
+    {
+        auto &position = chunk.position_refs[i];
+        auto &normal = chunk.normal_refs[i];
+        if (!ResolveRef(position, chunk.position_base, position_count))
+        {
+            chunk.error = fmt::format("face references position {} but there are {}", position + 1, position_count);
+            return;
+        }
+        if (normal != NO_REF && !ResolveRef(normal, chunk.normal_base, normal_count))
+        {
+            chunk.error = fmt::format("face references normal {} but there are {}", normal + 1, normal_count);
+            return;
+        }
+    }
+}
+
+static std::vector<ObjChunk> SplitChunks(const char *text, size_t size, size_t max_chunks)
+{
+    auto chunk_size = std::max(MIN_CHUNK_SIZE, (size + max_chunks - 1) / max_chunks);
+    std::vector<ObjChunk> chunks;
+    const char *end = text + size;
+    for (const char *it = text; it != end;)
+    {
+        const char *chunk_end = static_cast<size_t>(end - it) > chunk_size ? it + chunk_size : end;
+        // move the cut behind the end of the line it fell into
+        if (chunk_end != end)
+        {
+            const auto *newline = static_cast<const char *>(std::memchr(chunk_end, '\n', static_cast<size_t>(end - chunk_end)));
+            chunk_end = newline != nullptr ? newline + 1 : end;
+        }
+
+        auto &chunk = chunks.emplace_back();
+        chunk.begin = it;
+        chunk.end = chunk_end;
+        it = chunk_end;
+    }
+    return chunks;
+}
+
+// one job per chunk instead of ParallelFor ranges, so idle threads pick up the chunks left.
+// Jobs don't throw, errors are kept in the chunks
+template <typename F>
+static void ForEachChunk(lvk::JobSystem *jobs, std::vector<ObjChunk> &chunks, const F &job)
+{
+    if (jobs == nullptr || chunks.size() <= 1)
+    {
+        for (auto &chunk : chunks)
+        {
+            job(chunk);
+        }
+        return;
+    }
+
+    lvk::JobCounter counter;
+    for (auto &chunk : chunks)
+    {
+        jobs->Run([&job, &chunk]() { job(chunk); }, &counter);
+    }
+    jobs->Wait(counter);
+}
+
+static void ThrowChunkError(const std::filesystem::path &path, const char *text, const std::vector<ObjChunk> &chunks)
+{
+    for (const auto &chunk : chunks)
+    {
+        if (!chunk.error.empty())
+        {
+            if (!chunk.error_line)
+            {
+                throw std::runtime_error(fmt::format("obj loader: {}: {}", path.string(), chunk.error));
+            }
+            // lines before the chunk are only counted when there is an error to report
+            auto line = static_cast<size_t>(std::count(text, chunk.begin, '\n')) + *chunk.error_line + 1;
+            throw std::runtime_error(fmt::format("obj loader: {}:{}: {}", path.string(), line, chunk.error));
+        }
+    }
+}
+
+lvk::MeshData LoadObj(const std::filesystem::path &path, lvk::JobSystem *jobs)
+{
+    auto start = std::chrono::steady_clock::now();
+    lvk::MappedFile file(path);
+    const auto *text = reinterpret_cast<const char *>(file.GetData().data());
+
+    auto max_chunks = jobs != nullptr ? jobs->GetThreadCount() * CHUNKS_PER_THREAD : 1;
+    auto chunks = SplitChunks(text, file.Size(), max_chunks);
+    ForEachChunk(jobs, chunks, ParseChunk);
+    ThrowChunkError(path, text, chunks);
+
+    size_t position_count = 0;
+    size_t normal_count = 0;
+    size_t index_count = 0;
+    bool has_colors = false;
+    for (auto &chunk : chunks)
+    {
+        chunk.position_base = position_count;
+        chunk.normal_base = normal_count;
+        chunk.index_base = index_count;
+        position_count += chunk.positions.size();
+        normal_count += chunk.normals.size();
+        index_count += chunk.position_refs.size();
+        has_colors = has_colors || !chunk.colors.empty();
+    }
+    if (position_count >= NO_VERTEX || normal_count >= NO_NORMAL)
+    {
+        throw std::runtime_error(fmt::format("obj loader: {} has more vertices than 32 bit indices can address", path.string()));
+    }
+
+    std::vector<glm::vec3> positions(position_count);
+    std::vector<glm::vec3> colors(has_colors ? position_count : 0, glm::vec3(1.f));
+    std::vector<glm::vec3> normals(normal_count);
+    ForEachChunk(jobs, chunks, [&](ObjChunk &chunk)
+    {
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.position_base);
+        std::copy(chunk.colors.begin(), chunk.colors.end(), colors.begin() + chunk.position_base);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normal_base);
+        chunk.positions = {};
+        chunk.colors = {};
+        chunk.normals = {};
+        ResolveChunk(chunk, position_count, normal_count);
+    });
+    ThrowChunkError(path, text, chunks);
+
+    lvk::MeshData mesh;
+    mesh.indices.resize(index_count);
+    mesh.vertices.reserve(position_count);
+    auto add_vertex = [&](int64_t position, int64_t normal)
+    {
+        glm::vec3 color(1.f);
+        if (has_colors)
+        {
+            color = colors[position];
+        }
+        else if (normal != NO_REF && glm::dot(normals[normal], normals[normal]) > 0.f)
+        {
+            color = glm::normalize(normals[normal]) * 0.5f + 0.5f;
+        }
+        mesh.vertices.push_back(Vertex{.posision = positions[position], .color = color});
+        return static_cast<uint32_t>(mesh.vertices.size() - 1);
+    };
+
+    // Usually every position is used with a single normal, or none. The first combination
+    // seen per position is looked up directly, only the others go through the hash map
+    struct FirstUse
+    {
+        uint32_t normal{NO_NORMAL};
+        uint32_t vertex{NO_VERTEX};
+    };
+    std::vector<FirstUse> first_uses(position_count);
+    std::unordered_map<uint64_t, uint32_t> other_uses;
+    for (auto &chunk : chunks)
+    {
+        for (size_t i = 0; i < chunk.position_refs.size(); i++)
+        {
+            auto position = chunk.position_refs[i];
+            auto normal = chunk.normal_refs[i];
+            auto normal_key = normal != NO_REF ? static_cast<uint32_t>(normal) : NO_NORMAL;
+
+            auto &first_use = first_uses[position];
+            uint32_t vertex;
+            if (first_use.vertex == NO_VERTEX)
+            {
+                first_use = {normal_key, add_vertex(position, normal)};
+                vertex = first_use.vertex;
+            }
+            else if (first_use.normal == normal_key)
+            {
+                vertex = first_use.vertex;
+            }
+            else
+            {
+                auto key = static_cast<uint64_t>(position) | static_cast<uint64_t>(normal_key) << 32;
+                auto [it, inserted] = other_uses.try_emplace(key, NO_VERTEX);
+                if (inserted)
+                {
+                    it->second = add_vertex(position, normal);
+                }
+                vertex = it->second;
+            }
+            mesh.indices[chunk.index_base + i] = vertex;
+        }
+        chunk.position_refs = {};
+        chunk.normal_refs = {};
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_LOG_TRIVIAL(info) << fmt::format("obj loader: {} loaded in {:.1f} ms, {} vertices, {} triangles, {} chunks",
+                                           path.string(), elapsed.count(), mesh.vertices.size(), mesh.indices.size() / 3, chunks.size());
+    return mesh;
+}
+
+}
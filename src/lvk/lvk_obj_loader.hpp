@@ -0,0 +1,23 @@
+#ifndef _LVK_OBJ_LOADER_H
+#define _LVK_OBJ_LOADER_H
+
+// module
+#include "lvk_mesh_data.hpp"
+
+// std
+#include <filesystem>
+
+namespace lvk
+{
+class JobSystem;
+
+// Wavefront OBJ importer built for large scans. The file is memory mapped and split into
+// line aligned chunks which are parsed as separate jobs, vertices referencing the same
+// position and normal are merged. Only v, vn and f are read: polygons are triangulated as
+// fans, negative indices are resolved, "v x y z r g b" colors are used when present,
+// otherwise the color is the normal mapped to [0, 1], or white without normals. Throws
+// with the line number on malformed input, without jobs everything runs on the caller.
+lvk::MeshData LoadObj(const std::filesystem::path &path, lvk::JobSystem *jobs = nullptr);
+
+}
+#endif
@@ -0,0 +1,168 @@
+#include "lvk_offscreen.hpp"
+
+// module
+#include "lvk_definitions.hpp"
+#include "lvk_hardware.hpp"
+#include "lvk_allocator.hpp"
+
+namespace lvk
+{
+Offscreen::Offscreen(const lvk::Hardware &hardware, const lvk::Allocator &allocator, vk::Extent2D extent) :
+    extent_(extent),
+    color_images_(ConstructColorImages(allocator)),
+    image_views_(ConstructImageViews(hardware)),
+    render_pass_(ConstructRenderPass(hardware)),
+    frame_buffers_(ConstructFramebuffers(hardware))
+{}
+
+Offscreen::Offscreen(Offscreen &&other) noexcept :
+    format_(other.format_),
+    extent_(other.extent_),
+    color_images_(std::move(other.color_images_)),
+    image_views_(std::move(other.image_views_)),
+    render_pass_(std::move(other.render_pass_)),
+    frame_buffers_(std::move(other.frame_buffers_))
+{}
+
+std::vector<lvk::Image> Offscreen::ConstructColorImages(const lvk::Allocator &allocator)
+{
+    std::vector<lvk::Image> images;
+    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        images.emplace_back(
+            allocator,
+            vk::ImageCreateInfo
+            {
+                .imageType = vk::ImageType::e2D,
+                .format = format_,
+                .extent = {extent_.width, extent_.height, 1},
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = vk::SampleCountFlagBits::e1,
+                .tiling = vk::ImageTiling::eOptimal,
+                .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+                .sharingMode = vk::SharingMode::eExclusive,
+                .initialLayout = vk::ImageLayout::eUndefined
+            },
+            VmaAllocationCreateInfo{.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE});
+    }
+    return images;
+}
+
+std::vector<vk::raii::ImageView> Offscreen::ConstructImageViews(const lvk::Hardware &hardware)
+{
+    std::vector<vk::raii::ImageView> image_views;
+    for (const auto &image : color_images_)
+    {
+        vk::ImageViewCreateInfo create_info
+        {
+            .image = image,
+            .viewType = vk::ImageViewType::e2D,
+            .format = format_,
+            .components = vk::ComponentMapping(),
+            .subresourceRange
+            {
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+        image_views.emplace_back(hardware.GetDevice(), create_info);
+    }
+    return image_views;
+}
+
+vk::raii::RenderPass Offscreen::ConstructRenderPass(const lvk::Hardware &hardware)
+{
+    // same layout as the swapchain render pass, but the image is left readable for copies instead of present
+    vk::AttachmentDescription color_attachment_description
+    {
+        .format = format_,
+        .samples = vk::SampleCountFlagBits::e1,
+        .loadOp = vk::AttachmentLoadOp::eClear,
+        .storeOp = vk::AttachmentStoreOp::eStore,
+        .stencilLoadOp = vk::AttachmentLoadOp::eDontCare,
+        .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
+        .initialLayout = vk::ImageLayout::eUndefined,
+        .finalLayout = vk::ImageLayout::eTransferSrcOptimal
+    };
+
+    vk::ArrayProxy<vk::AttachmentDescription> color_attachment_descriptions(color_attachment_description);
+
+    vk::AttachmentReference color_attachment_reference
+    {
+        .attachment = 0,
+        .layout = vk::ImageLayout::eColorAttachmentOptimal
+    };
+
+    vk::ArrayProxy<vk::AttachmentReference> color_attachment_references(color_attachment_reference);
+
+    vk::SubpassDescription subpass_description
+    {
+        .pipelineBindPoint = vk::PipelineBindPoint::eGraphics,
+        .colorAttachmentCount = color_attachment_references.size(),
+        .pColorAttachments = color_attachment_references.data()
+    };
+
+    vk::ArrayProxy<vk::SubpassDescription> subpass_descriptions(subpass_description);
+
+    std::array<vk::SubpassDependency, 2> subpass_dependencies
+    {
+        vk::SubpassDependency
+        {
+            .srcSubpass = VK_SUBPASS_EXTERNAL,
+            .dstSubpass = 0,
+            .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eTransfer,
+            .dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .srcAccessMask = vk::AccessFlagBits::eTransferRead,
+            .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+        },
+        vk::SubpassDependency
+        {
+            .srcSubpass = 0,
+            .dstSubpass = VK_SUBPASS_EXTERNAL,
+            .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .dstStageMask = vk::PipelineStageFlagBits::eTransfer,
+            .srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead,
+        }
+    };
+
+    vk::RenderPassCreateInfo render_pass_create_info
+    {
+        .attachmentCount = color_attachment_descriptions.size(),
+        .pAttachments = color_attachment_descriptions.data(),
+        .subpassCount = subpass_descriptions.size(),
+        .pSubpasses = subpass_descriptions.data(),
+        .dependencyCount = static_cast<uint32_t>(subpass_dependencies.size()),
+        .pDependencies = subpass_dependencies.data()
+    };
+
+    return vk::raii::RenderPass(hardware.GetDevice(), render_pass_create_info);
+}
+
+std::vector<vk::raii::Framebuffer> Offscreen::ConstructFramebuffers(const lvk::Hardware &hardware)
+{
+    std::vector<vk::raii::Framebuffer> framebuffers;
+    for (const auto &image_view : image_views_)
+    {
+        vk::ArrayProxy<const vk::ImageView> attachments(*image_view);
+
+        vk::FramebufferCreateInfo frame_buffer_create_info
+        {
+            .renderPass = *render_pass_,
+            .attachmentCount = attachments.size(),
+            .pAttachments = attachments.data(),
+            .width = extent_.width,
+            .height = extent_.height,
+            .layers = 1
+        };
+
+        framebuffers.emplace_back(hardware.GetDevice(), frame_buffer_create_info);
+    }
+    return framebuffers;
+}
+
+}// namespace lvk
@@ -0,0 +1,53 @@
+#ifndef _LVK_OFFSCREEN_H
+#define _LVK_OFFSCREEN_H
+
+// module
+#include "lvk_image.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace lvk
+{
+class Hardware;
+class Allocator;
+
+// headless counterpart of Swapchain, renders into VMA allocated images, one per frame in flight
+class Offscreen : public boost::noncopyable
+{
+public:
+    Offscreen(const lvk::Hardware &hardware, const lvk::Allocator &allocator, vk::Extent2D extent);
+    Offscreen(Offscreen &&other) noexcept;
+
+public:
+    const vk::raii::RenderPass &GetRenderPass() const { return render_pass_; }
+    const vk::raii::Framebuffer &GetFrameBuffer(uint32_t index) const { return frame_buffers_[index]; }
+    const lvk::Image &GetColorImage(uint32_t index) const { return color_images_[index]; }
+    vk::Format GetFormat() const { return format_; }
+    vk::Extent2D GetExtent() const { return extent_; }
+
+private:
+    std::vector<lvk::Image> ConstructColorImages(const lvk::Allocator &allocator);
+    std::vector<vk::raii::ImageView> ConstructImageViews(const lvk::Hardware &hardware);
+    vk::raii::RenderPass ConstructRenderPass(const lvk::Hardware &hardware);
+    std::vector<vk::raii::Framebuffer> ConstructFramebuffers(const lvk::Hardware &hardware);
+
+private:
+    vk::Format format_{vk::Format::eR8G8B8A8Srgb};
+    vk::Extent2D extent_;
+
+    std::vector<lvk::Image> color_images_;
+    std::vector<vk::raii::ImageView> image_views_;
+
+    vk::raii::RenderPass render_pass_;
+    std::vector<vk::raii::Framebuffer> frame_buffers_;
+};
+}// namespace lvk
+#endif
@@ -0,0 +1,153 @@
+#include "lvk_parallel_recorder.hpp"
+
+// module
+#include "lvk_hardware.hpp"
+#include "lvk_job_system.hpp"
+
+// std
+#include <algorithm>
+#include <exception>
+
+namespace lvk
+{
+
+ParallelRecorder::ParallelRecorder(const lvk::Hardware &hardware, lvk::JobSystem &jobs, uint32_t thread_count) :
+    jobs_(&jobs),
+    thread_count_(thread_count > 0 ? thread_count : jobs.GetThreadCount()),
+    frame_commands_(ConstructFrameCommands(hardware))
+{}
+
+ParallelRecorder::ParallelRecorder(ParallelRecorder &&other) noexcept :
+    jobs_(other.jobs_),
+    thread_count_(other.thread_count_),
+    frame_commands_(std::move(other.frame_commands_))
+{}
+
+std::array<std::vector<ParallelRecorder::ThreadCommands>, MAX_FRAMES_IN_FLIGHT> ParallelRecorder::ConstructFrameCommands(const lvk::Hardware &hardware)
+{
+    // transient, every buffer is recorded once per frame and the whole pool is reset
+    vk::CommandPoolCreateInfo command_pool_create_info
+    {
+        .flags = vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex = hardware.GetQueueIndex(Hardware::QueueType::GRAPHICS).value(),
+    };
+
+    std::array<std::vector<ThreadCommands>, MAX_FRAMES_IN_FLIGHT> frame_commands;
+    for (auto &thread_commands : frame_commands)
+    {
+        for (uint32_t t = 0; t < thread_count_; t++)
+        {
+            ThreadCommands commands;
+            commands.command_pool = vk::raii::CommandPool(hardware.GetDevice(), command_pool_create_info);
+            vk::CommandBufferAllocateInfo command_buffer_allocate_info
+            {
+                .commandPool = *commands.command_pool,
+                .level = vk::CommandBufferLevel::eSecondary,
+                .commandBufferCount = 1,
+            };
+            commands.command_buffer = std::move(hardware.GetDevice().allocateCommandBuffers(command_buffer_allocate_info)[0]);
+            thread_commands.push_back(std::move(commands));
+        }
+    }
+    return frame_commands;
+}
+
+void ParallelRecorder::Record(const FrameContext &context, uint32_t item_count, uint32_t min_items_per_thread, const RecordRangeCallback &record)
+{
+    if (item_count == 0)
+    {
+        return;
+    }
+
+    // the frame's fence was waited, nothing recorded from its pools is pending anymore
+    auto &thread_commands = frame_commands_[context.frame_index];
+    for (auto &commands : thread_commands)
+    {
+        commands.command_pool.reset();
+    }
+
+    auto chunk_count = std::clamp(item_count / std::max(1u, min_items_per_thread), 1u, thread_count_);
+    auto chunk_size = (item_count + chunk_count - 1) / chunk_count;
+    auto chunk_range = [&](uint32_t chunk)
+    {
+        auto begin = std::min(item_count, chunk * chunk_size);
+        return std::make_pair(begin, std::min(item_count, begin + chunk_size));
+    };
+
+    // the calling thread records the first chunk, errors are rethrown here after every chunk finished
+    std::vector<std::exception_ptr> errors(chunk_count);
+    auto record_chunk = [&](uint32_t chunk)
+    {
+        try
+        {
+            auto [begin, end] = chunk_range(chunk);
+            RecordChunk(context, thread_commands[chunk], begin, end, record);
+        }
+        catch (...)
+        {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    JobCounter recorded;
+    for (uint32_t chunk = 1; chunk < chunk_count; chunk++)
+    {
+        jobs_->Run([&record_chunk, chunk]() { record_chunk(chunk); }, &recorded);
+    }
+    record_chunk(0);
+    jobs_->Wait(recorded);
+    for (const auto &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<vk::CommandBuffer> command_buffers;
+    for (uint32_t chunk = 0; chunk < chunk_count; chunk++)
+    {
+        command_buffers.push_back(*thread_commands[chunk].command_buffer);
+    }
+    context.command_buffer.executeCommands(command_buffers);
+}
+
+void ParallelRecorder::RecordChunk(const FrameContext &context, const ThreadCommands &commands, uint32_t begin, uint32_t end, const RecordRangeCallback &record) const
+{
+    vk::CommandBufferInheritanceInfo inheritance_info
+    {
+        .renderPass = *context.render_pass,
+        .subpass = 0,
+        .framebuffer = *context.framebuffer,
+    };
+    const auto &command_buffer = commands.command_buffer;
+    command_buffer.begin(vk::CommandBufferBeginInfo
+    {
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = &inheritance_info
+    });
+
+    // dynamic state is not inherited from the primary buffer
+    vk::Viewport viewport
+    {
+        .x = 0,
+        .y = 0,
+        .width = static_cast<float>(context.extent.width),
+        .height = static_cast<float>(context.extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+    vk::ArrayProxy<const vk::Viewport> viewports(viewport);
+    command_buffer.setViewport(0, viewports);
+    vk::Rect2D scissor
+    {
+        .offset = {0, 0},
+        .extent = context.extent,
+    };
+    vk::ArrayProxy<const vk::Rect2D> scissors(scissor);
+    command_buffer.setScissor(0, scissors);
+
+    record(command_buffer, begin, end);
+    command_buffer.end();
+}
+
+}
@@ -0,0 +1,64 @@
+#ifndef _LVK_PARALLEL_RECORDER_H
+#define _LVK_PARALLEL_RECORDER_H
+
+// module
+#include "lvk_definitions.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <array>
+#include <functional>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace lvk
+{
+class Hardware;
+class JobSystem;
+
+// Records a range of items as jobs into secondary command buffers. Every chunk
+// owns one command pool per frame in flight and is recorded by a single job, so
+// recording needs no locks and a frame's pools are reset as a whole once its
+// fence was waited.
+class ParallelRecorder : public boost::noncopyable
+{
+public:
+    // at most thread_count chunks are recorded at once, 0 picks the job system's thread count
+    ParallelRecorder(const lvk::Hardware &hardware, lvk::JobSystem &jobs, uint32_t thread_count = 0);
+    ParallelRecorder(ParallelRecorder &&other) noexcept;
+
+    // records one contiguous chunk of items, the buffer inherits nothing but the render pass,
+    // so pipeline, descriptor sets and vertex buffers have to be bound again in every chunk
+    using RecordRangeCallback = std::function<void(const vk::raii::CommandBuffer &command_buffer, uint32_t begin, uint32_t end)>;
+
+    // splits [0, item_count) into at most one chunk per thread with at least min_items_per_thread each,
+    // records them in parallel and executes them in order on the primary buffer. The render pass has
+    // to be begun with vk::SubpassContents::eSecondaryCommandBuffers. Viewport and scissor are set
+    // from the context in every chunk
+    void Record(const FrameContext &context, uint32_t item_count, uint32_t min_items_per_thread, const RecordRangeCallback &record);
+
+    uint32_t GetThreadCount() const { return thread_count_; }
+
+private:
+    struct ThreadCommands
+    {
+        vk::raii::CommandPool command_pool{nullptr};
+        vk::raii::CommandBuffer command_buffer{nullptr};
+    };
+
+    std::array<std::vector<ThreadCommands>, MAX_FRAMES_IN_FLIGHT> ConstructFrameCommands(const lvk::Hardware &hardware);
+    void RecordChunk(const FrameContext &context, const ThreadCommands &commands, uint32_t begin, uint32_t end, const RecordRangeCallback &record) const;
+
+private:
+    lvk::JobSystem *jobs_;
+    uint32_t thread_count_;
+    std::array<std::vector<ThreadCommands>, MAX_FRAMES_IN_FLIGHT> frame_commands_;
+};
+
+}
+#endif
@@ -2,6 +2,7 @@
 // module
 #include "lvk_hardware.hpp"
 #include "lvk_vertex.hpp"
+#include "lvk_pipeline_cache.hpp"
 
 // std
 #include <fstream>
@@ -15,10 +16,13 @@ namespace lvk
 Pipeline::Pipeline(const lvk::Hardware& hardware,
                    const vk::raii::PipelineLayout &pipeline_layout,
                    std::vector<lvk::Shader> shaders,
-                   const vk::raii::RenderPass &render_pass) :
+                   const vk::raii::RenderPass &render_pass,
+                   lvk::PipelineCache &pipeline_cache,
+                   const lvk::PipelineDesc &desc) :
     pipeline_layout_(pipeline_layout),
     shaders_(std::move(shaders)),
-    pipeline_(ConstructPipeline(hardware, render_pass))
+    desc_(desc),
+    pipeline_(ConstructPipeline(render_pass, pipeline_cache))
 {
 }
 
@@ -26,10 +30,20 @@ Pipeline::Pipeline(const lvk::Hardware& hardware,
 Pipeline::Pipeline(Pipeline&& other) noexcept :
     pipeline_layout_(other.pipeline_layout_),
     shaders_(std::move(other.shaders_)),
+    desc_(other.desc_),
     pipeline_(std::move(other.pipeline_))
 {}
 
-vk::raii::Pipeline Pipeline::ConstructPipeline(const lvk::Hardware& hardware, const vk::raii::RenderPass &render_pass)
+Pipeline &Pipeline::operator=(Pipeline &&other) noexcept
+{
+    std::swap(pipeline_layout_, other.pipeline_layout_);
+    std::swap(shaders_, other.shaders_);
+    std::swap(desc_, other.desc_);
+    std::swap(pipeline_, other.pipeline_);
+    return *this;
+}
+
+vk::raii::Pipeline Pipeline::ConstructPipeline(const vk::raii::RenderPass &render_pass, lvk::PipelineCache &pipeline_cache)
 {
     std::vector<vk::PipelineShaderStageCreateInfo> shader_stage_create_infos;
     for (const auto &shader : shaders_)
@@ -50,20 +64,19 @@ vk::raii::Pipeline Pipeline::ConstructPipeline(const lvk::Hardware& hardware, co
         .pScissors = nullptr
     };
 
-    auto &binding_descriptions = Vertex::GetVertexBindingDescriptions();
-    auto &input_descriptions = Vertex::GetVertexInputAttributeDescriptions();
+    auto vertex_input = GetVertexInput(desc_.vertex_format);
 
     vk::PipelineVertexInputStateCreateInfo vertex_input_state_create_info
     {
-        .vertexBindingDescriptionCount = static_cast<uint32_t>(binding_descriptions.size()),
-        .pVertexBindingDescriptions = binding_descriptions.data(),
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(input_descriptions.size()),
-        .pVertexAttributeDescriptions = input_descriptions.data()
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(vertex_input.bindings.size()),
+        .pVertexBindingDescriptions = vertex_input.bindings.data(),
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input.attributes.size()),
+        .pVertexAttributeDescriptions = vertex_input.attributes.data()
     };
 
     vk::PipelineInputAssemblyStateCreateInfo input_assembly_state_create_info
     {
-        .topology = vk::PrimitiveTopology::eTriangleList,
+        .topology = desc_.topology,
         .primitiveRestartEnable = VK_FALSE
     };
 
@@ -71,9 +84,9 @@ vk::raii::Pipeline Pipeline::ConstructPipeline(const lvk::Hardware& hardware, co
     {
         .depthClampEnable = VK_FALSE,
         .rasterizerDiscardEnable = VK_FALSE,
-        .polygonMode = vk::PolygonMode::eFill,
-        .cullMode = vk::CullModeFlagBits::eBack,
-        .frontFace = vk::FrontFace::eClockwise,
+        .polygonMode = desc_.polygon_mode,
+        .cullMode = desc_.cull_mode,
+        .frontFace = desc_.front_face,
         .depthBiasEnable = VK_FALSE,
         .depthBiasConstantFactor = 0.0f,
         .depthBiasClamp = 0.0f,
@@ -90,18 +103,19 @@ vk::raii::Pipeline Pipeline::ConstructPipeline(const lvk::Hardware& hardware, co
         .alphaToCoverageEnable = VK_FALSE,
         .alphaToOneEnable = VK_FALSE};
 
-    vk::PipelineColorBlendAttachmentState color_blend_attachment_state
+    vk::PipelineDepthStencilStateCreateInfo depth_stencil_state_create_info
     {
-        .blendEnable = VK_FALSE,
-        .srcColorBlendFactor = vk::BlendFactor::eOne,
-        .dstColorBlendFactor = vk::BlendFactor::eZero,
-        .colorBlendOp = vk::BlendOp::eAdd,
-        .srcAlphaBlendFactor = vk::BlendFactor::eOne,
-        .dstAlphaBlendFactor = vk::BlendFactor::eZero,
-        .alphaBlendOp = vk::BlendOp::eAdd,
-        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA,
+        .depthTestEnable = desc_.depth_test,
+        .depthWriteEnable = desc_.depth_write,
+        .depthCompareOp = desc_.depth_compare,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE,
+        .minDepthBounds = 0.0f,
+        .maxDepthBounds = 1.0f
     };
 
+    auto color_blend_attachment_state = GetBlendAttachmentState();
+
     vk::PipelineColorBlendStateCreateInfo color_blend_state_create_info
     {
         .logicOpEnable = VK_FALSE,
@@ -131,7 +145,7 @@ vk::raii::Pipeline Pipeline::ConstructPipeline(const lvk::Hardware& hardware, co
         .pViewportState = &viewport_state_create_info,
         .pRasterizationState = &rasterization_state_create_info,
         .pMultisampleState = &multisampling_state_create_info,
-        .pDepthStencilState = nullptr,
+        .pDepthStencilState = &depth_stencil_state_create_info,
         .pColorBlendState = &color_blend_state_create_info,
         .pDynamicState = &dynamic_state_create_info,
         .layout = *pipeline_layout_.get(),
@@ -141,7 +155,41 @@ vk::raii::Pipeline Pipeline::ConstructPipeline(const lvk::Hardware& hardware, co
         .basePipelineIndex = -1,
     };
 
-    return vk::raii::Pipeline(hardware.GetDevice(), {nullptr}, graphic_pipeline_create_info);
+    return pipeline_cache.CreatePipeline(graphic_pipeline_create_info);
+}
+
+vk::PipelineColorBlendAttachmentState Pipeline::GetBlendAttachmentState() const
+{
+    vk::PipelineColorBlendAttachmentState color_blend_attachment_state
+    {
+        .blendEnable = VK_FALSE,
+        .srcColorBlendFactor = vk::BlendFactor::eOne,
+        .dstColorBlendFactor = vk::BlendFactor::eZero,
+        .colorBlendOp = vk::BlendOp::eAdd,
+        .srcAlphaBlendFactor = vk::BlendFactor::eOne,
+        .dstAlphaBlendFactor = vk::BlendFactor::eZero,
+        .alphaBlendOp = vk::BlendOp::eAdd,
+        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA,
+    };
+
+    switch (desc_.blend)
+    {
+    case BlendMode::REPLACE:
+        break;
+    case BlendMode::ALPHA:
+        color_blend_attachment_state.blendEnable = VK_TRUE;
+        color_blend_attachment_state.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+        color_blend_attachment_state.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+        color_blend_attachment_state.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+        break;
+    case BlendMode::ADDITIVE:
+        color_blend_attachment_state.blendEnable = VK_TRUE;
+        color_blend_attachment_state.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+        color_blend_attachment_state.dstColorBlendFactor = vk::BlendFactor::eOne;
+        color_blend_attachment_state.dstAlphaBlendFactor = vk::BlendFactor::eOne;
+        break;
+    }
+    return color_blend_attachment_state;
 }
 
 void Pipeline::BindPipeline(const vk::raii::CommandBuffer &command_buffer) const
@@ -3,6 +3,7 @@
 
 // module
 #include "lvk_shader.hpp"
+#include "lvk_pipeline_desc.hpp"
 
 // boost
 #include <boost/noncopyable.hpp>
@@ -15,6 +16,7 @@
 namespace lvk
 {
 class Hardware;
+class PipelineCache;
 
 class Pipeline : public boost::noncopyable
 {
@@ -22,21 +24,27 @@ public:
     Pipeline(const lvk::Hardware& hardware,
              const vk::raii::PipelineLayout &pipeline_layout,
              std::vector<lvk::Shader> shaders,
-             const vk::raii::RenderPass &render_pass);
+             const vk::raii::RenderPass &render_pass,
+             lvk::PipelineCache &pipeline_cache,
+             const lvk::PipelineDesc &desc = {});
 
     Pipeline(Pipeline&& other) noexcept;
+    Pipeline &operator=(Pipeline &&other) noexcept;
 
     void BindPipeline(const vk::raii::CommandBuffer &command_buffer) const;
 
 public:
     const vk::raii::Pipeline &GetPipeline() const { return pipeline_; }
+    const lvk::PipelineDesc &GetDesc() const { return desc_; }
 
 private:
-    vk::raii::Pipeline ConstructPipeline(const lvk::Hardware& hardware, const vk::raii::RenderPass &render_pass);
+    vk::raii::Pipeline ConstructPipeline(const vk::raii::RenderPass &render_pass, lvk::PipelineCache &pipeline_cache);
+    vk::PipelineColorBlendAttachmentState GetBlendAttachmentState() const;
 
 private:
     std::reference_wrapper<const vk::raii::PipelineLayout> pipeline_layout_;
     std::vector<lvk::Shader> shaders_;
+    lvk::PipelineDesc desc_;
 
     vk::raii::Pipeline pipeline_;
 };
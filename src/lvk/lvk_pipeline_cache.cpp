@@ -0,0 +1,239 @@
+#include "lvk_pipeline_cache.hpp"
+
+// module
+#include "lvk_hardware.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+// "LVKP"
+constexpr uint32_t CACHE_FILE_MAGIC = 0x504b564c;
+constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+struct CacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    std::array<uint8_t, VK_UUID_SIZE> pipeline_cache_uuid;
+    uint64_t data_size;
+    uint64_t checksum;
+};
+
+// fnv-1a, the driver may trust whatever it is handed, so torn or corrupted data must not reach it
+static uint64_t Checksum(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static CacheFileHeader MakeHeader(const vk::PhysicalDeviceProperties &properties)
+{
+    CacheFileHeader header{};
+    header.magic = CACHE_FILE_MAGIC;
+    header.version = CACHE_FILE_VERSION;
+    header.vendor_id = properties.vendorID;
+    header.device_id = properties.deviceID;
+    header.driver_version = properties.driverVersion;
+    std::copy(properties.pipelineCacheUUID.begin(), properties.pipelineCacheUUID.end(), header.pipeline_cache_uuid.begin());
+    return header;
+}
+
+PipelineCache::PipelineCache(const lvk::Hardware &hardware, std::filesystem::path path) :
+    hardware_(&hardware),
+    path_(std::move(path)),
+    pipeline_cache_(ConstructPipelineCache(hardware))
+{}
+
+std::vector<uint8_t> PipelineCache::LoadCacheData(const lvk::Hardware &hardware) const
+{
+    if (path_.empty())
+    {
+        return {};
+    }
+
+    std::ifstream file(path_, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        BOOST_LOG_TRIVIAL(info) << fmt::format("pipeline cache: no {}, starting cold", path_.string());
+        return {};
+    }
+
+    auto file_size = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+    CacheFileHeader header{};
+    if (file_size < sizeof(header) || !file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("pipeline cache: {} is truncated, starting cold", path_.string());
+        return {};
+    }
+
+    auto expected = MakeHeader(hardware.GetPhysicalDevice().getProperties());
+    if (header.magic != expected.magic || header.version != expected.version)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("pipeline cache: {} is not a pipeline cache of this version, starting cold", path_.string());
+        return {};
+    }
+    if (header.vendor_id != expected.vendor_id || header.device_id != expected.device_id || header.driver_version != expected.driver_version || header.pipeline_cache_uuid != expected.pipeline_cache_uuid)
+    {
+        BOOST_LOG_TRIVIAL(info) << fmt::format("pipeline cache: {} was written for another device or driver, starting cold", path_.string());
+        return {};
+    }
+    if (header.data_size != file_size - sizeof(header))
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("pipeline cache: {} holds {} bytes but its header says {}, starting cold", path_.string(), file_size - sizeof(header), header.data_size);
+        return {};
+    }
+
+    std::vector<uint8_t> data(header.data_size);
+    if (!file.read(reinterpret_cast<char *>(data.data()), data.size()) || Checksum(data.data(), data.size()) != header.checksum)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("pipeline cache: {} is corrupted, starting cold", path_.string());
+        return {};
+    }
+
+    // the driver's own header has to agree as well, some drivers don't check it themselves
+    VkPipelineCacheHeaderVersionOne driver_header{};
+    if (data.size() < sizeof(driver_header))
+    {
+        return {};
+    }
+    std::memcpy(&driver_header, data.data(), sizeof(driver_header));
+    if (driver_header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        driver_header.vendorID != expected.vendor_id ||
+        driver_header.deviceID != expected.device_id ||
+        std::memcmp(driver_header.pipelineCacheUUID, expected.pipeline_cache_uuid.data(), VK_UUID_SIZE) != 0)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("pipeline cache: {} has a foreign driver header, starting cold", path_.string());
+        return {};
+    }
+    return data;
+}
+
+vk::raii::PipelineCache PipelineCache::ConstructPipelineCache(const lvk::Hardware &hardware)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto data = LoadCacheData(hardware);
+    warm_ = !data.empty();
+    saved_size_ = data.size();
+
+    vk::PipelineCacheCreateInfo pipeline_cache_create_info
+    {
+        .initialDataSize = data.size(),
+        .pInitialData = data.empty() ? nullptr : data.data()
+    };
+    vk::raii::PipelineCache pipeline_cache(hardware.GetDevice(), pipeline_cache_create_info);
+
+    if (warm_)
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        BOOST_LOG_TRIVIAL(info) << fmt::format("pipeline cache: loaded {} bytes from {} in {:.2f} ms", data.size(), path_.string(), elapsed.count());
+    }
+    return pipeline_cache;
+}
+
+vk::raii::Pipeline PipelineCache::CreatePipeline(const vk::GraphicsPipelineCreateInfo &create_info)
+{
+    auto start = std::chrono::steady_clock::now();
+    vk::raii::Pipeline pipeline(hardware_->GetDevice(), pipeline_cache_, create_info);
+    AddCreation(std::chrono::steady_clock::now() - start);
+    return pipeline;
+}
+
+vk::raii::Pipeline PipelineCache::CreatePipeline(const vk::ComputePipelineCreateInfo &create_info)
+{
+    auto start = std::chrono::steady_clock::now();
+    vk::raii::Pipeline pipeline(hardware_->GetDevice(), pipeline_cache_, create_info);
+    AddCreation(std::chrono::steady_clock::now() - start);
+    return pipeline;
+}
+
+void PipelineCache::Save()
+{
+    if (path_.empty())
+    {
+        return;
+    }
+
+    // the data only ever grows, an unchanged size means nothing new was compiled
+    auto data = pipeline_cache_.getData();
+    if (data.size() == saved_size_)
+    {
+        return;
+    }
+
+    auto header = MakeHeader(hardware_->GetPhysicalDevice().getProperties());
+    header.data_size = data.size();
+    header.checksum = Checksum(data.data(), data.size());
+
+    if (path_.has_parent_path())
+    {
+        std::filesystem::create_directories(path_.parent_path());
+    }
+    auto temporary_path = path_;
+    temporary_path += ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error(fmt::format("failed to open {}", temporary_path.string()));
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(data.data()), data.size());
+        file.flush();
+        if (!file)
+        {
+            throw std::runtime_error(fmt::format("failed to write {}", temporary_path.string()));
+        }
+    }
+    std::filesystem::rename(temporary_path, path_);
+
+    saved_size_ = data.size();
+    BOOST_LOG_TRIVIAL(debug) << fmt::format("pipeline cache: saved {} bytes to {}", data.size(), path_.string());
+}
+
+uint32_t PipelineCache::GetPipelineCount() const
+{
+    std::lock_guard lock(stats_mutex_);
+    return pipeline_count_;
+}
+
+std::chrono::duration<double> PipelineCache::GetCreationTime() const
+{
+    std::lock_guard lock(stats_mutex_);
+    return creation_time_;
+}
+
+void PipelineCache::LogStats() const
+{
+    std::chrono::duration<double, std::milli> creation_time = GetCreationTime();
+    BOOST_LOG_TRIVIAL(info) << fmt::format("pipeline cache: {} start, {} pipelines created in {:.2f} ms", warm_ ? "warm" : "cold", GetPipelineCount(), creation_time.count());
+}
+
+void PipelineCache::AddCreation(std::chrono::steady_clock::duration duration)
+{
+    std::lock_guard lock(stats_mutex_);
+    pipeline_count_++;
+    creation_time_ += duration;
+}
+
+}
@@ -0,0 +1,67 @@
+#ifndef _LVK_PIPELINE_CACHE_H
+#define _LVK_PIPELINE_CACHE_H
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace lvk
+{
+class Hardware;
+
+// vk::PipelineCache persisted across runs. The file starts with a header naming the
+// device, driver and cache uuid it was written for plus a checksum of the data, a
+// file that doesn't match the current device exactly is ignored and replaced on the
+// next Save. Every pipeline should be created through it, so creation times can be
+// compared between cold (empty) and warm (loaded) starts.
+class PipelineCache : public boost::noncopyable
+{
+public:
+    // an empty path keeps the cache in memory only
+    PipelineCache(const lvk::Hardware &hardware, std::filesystem::path path);
+
+    vk::raii::Pipeline CreatePipeline(const vk::GraphicsPipelineCreateInfo &create_info);
+    vk::raii::Pipeline CreatePipeline(const vk::ComputePipelineCreateInfo &create_info);
+
+    // writes the cache to a temporary file and renames it over the old one, so a crash
+    // never leaves a torn file behind. Skipped when no pipeline was added since the last
+    // load or save, cheap enough to call periodically
+    void Save();
+
+    const vk::raii::PipelineCache &GetPipelineCache() const { return pipeline_cache_; }
+    // loaded from disk, pipelines created so far were likely hits
+    bool IsWarm() const { return warm_; }
+    uint32_t GetPipelineCount() const;
+    std::chrono::duration<double> GetCreationTime() const;
+    void LogStats() const;
+
+private:
+    // loaded data, empty when missing or not valid for this device
+    std::vector<uint8_t> LoadCacheData(const lvk::Hardware &hardware) const;
+    vk::raii::PipelineCache ConstructPipelineCache(const lvk::Hardware &hardware);
+    void AddCreation(std::chrono::steady_clock::duration duration);
+
+private:
+    const lvk::Hardware *hardware_;
+    std::filesystem::path path_;
+    bool warm_{false};
+    size_t saved_size_{0};
+    vk::raii::PipelineCache pipeline_cache_;
+
+    mutable std::mutex stats_mutex_;
+    uint32_t pipeline_count_{0};
+    std::chrono::steady_clock::duration creation_time_{0};
+};
+
+}
+#endif
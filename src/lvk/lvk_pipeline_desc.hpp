@@ -0,0 +1,65 @@
+#ifndef _LVK_PIPELINE_DESC_H
+#define _LVK_PIPELINE_DESC_H
+
+// module
+#include "lvk_vertex.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+
+// boost
+#include <boost/container_hash/hash.hpp>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+
+namespace lvk
+{
+
+// REPLACE writes the fragment as it is, ALPHA blends by source alpha, ADDITIVE adds it on top
+enum class BlendMode : uint8_t { REPLACE, ALPHA, ADDITIVE };
+
+// The fixed function state a graphics pipeline is built with, everything else comes
+// from the shaders, the layout and the render pass. Defaults are the opaque solid state
+// every pipeline used before variants existed.
+struct PipelineDesc
+{
+    vk::PrimitiveTopology topology{vk::PrimitiveTopology::eTriangleList};
+    // anything but eFill needs the fillModeNonSolid feature
+    vk::PolygonMode polygon_mode{vk::PolygonMode::eFill};
+    vk::CullModeFlags cull_mode{vk::CullModeFlagBits::eBack};
+    vk::FrontFace front_face{vk::FrontFace::eClockwise};
+    // only take effect in render passes with a depth attachment
+    bool depth_test{false};
+    bool depth_write{false};
+    vk::CompareOp depth_compare{vk::CompareOp::eLessOrEqual};
+    BlendMode blend{BlendMode::REPLACE};
+    // has to match the geometry arena's, the render system fills it in
+    VertexFormat vertex_format{VertexFormat::FULL};
+
+    bool operator==(const PipelineDesc &other) const = default;
+
+    size_t Hash() const
+    {
+        size_t seed = 0;
+        boost::hash_combine(seed, static_cast<uint32_t>(topology));
+        boost::hash_combine(seed, static_cast<uint32_t>(polygon_mode));
+        boost::hash_combine(seed, static_cast<VkCullModeFlags>(cull_mode));
+        boost::hash_combine(seed, static_cast<uint32_t>(front_face));
+        boost::hash_combine(seed, depth_test);
+        boost::hash_combine(seed, depth_write);
+        boost::hash_combine(seed, static_cast<uint32_t>(depth_compare));
+        boost::hash_combine(seed, static_cast<uint32_t>(blend));
+        boost::hash_combine(seed, static_cast<uint32_t>(vertex_format));
+        return seed;
+    }
+};
+
+struct PipelineDescHash
+{
+    size_t operator()(const PipelineDesc &desc) const { return desc.Hash(); }
+};
+
+}
+#endif
@@ -0,0 +1,182 @@
+#include "lvk_pipeline_variants.hpp"
+
+// module
+#include "lvk_hardware.hpp"
+#include "lvk_pipeline_cache.hpp"
+#include "lvk_shader.hpp"
+
+// std
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+PipelineVariants::PipelineVariants(const lvk::Hardware &hardware,
+                                   const vk::raii::PipelineLayout &pipeline_layout,
+                                   const vk::raii::RenderPass &render_pass,
+                                   lvk::PipelineCache &pipeline_cache,
+                                   lvk::JobSystem &jobs,
+                                   std::vector<ShaderSource> shaders,
+                                   const lvk::PipelineDesc &default_desc) :
+    hardware_(&hardware),
+    pipeline_layout_(&pipeline_layout),
+    render_pass_(&render_pass),
+    pipeline_cache_(&pipeline_cache),
+    jobs_(&jobs),
+    shaders_(std::make_shared<const ShaderSet>(std::move(shaders)))
+{
+    // the fallback for everything else, without it the first frame would have nothing to draw with
+    auto variant = std::make_unique<Variant>();
+    variant->desc = default_desc;
+    variant->pipeline.emplace(CreatePipeline(default_desc, *shaders_));
+    variant->generation = generation_;
+    default_variant_ = variant.get();
+    variants_.emplace(default_desc, std::move(variant));
+}
+
+PipelineVariants::~PipelineVariants()
+{
+    // jobs write into the variants
+    for (auto &[desc, variant] : variants_)
+    {
+        if (variant->in_flight)
+        {
+            jobs_->Wait(variant->compiling);
+        }
+    }
+}
+
+const lvk::Pipeline &PipelineVariants::Get(const lvk::PipelineDesc &desc)
+{
+    {
+        std::shared_lock lock(mutex_);
+        auto it = variants_.find(desc);
+        if (it != variants_.end())
+        {
+            return it->second->pipeline ? *it->second->pipeline : *default_variant_->pipeline;
+        }
+    }
+
+    // another thread may have added it meanwhile
+    std::unique_lock lock(mutex_);
+    auto [it, inserted] = variants_.try_emplace(desc);
+    if (inserted)
+    {
+        it->second = std::make_unique<Variant>();
+        it->second->desc = desc;
+        StartCompile(*it->second);
+    }
+    return it->second->pipeline ? *it->second->pipeline : *default_variant_->pipeline;
+}
+
+void PipelineVariants::NextFrame(uint32_t frame_index)
+{
+    // this frame's fence was waited, whatever was retired when it last ran is unused by now
+    retired_[frame_index].clear();
+
+    std::unique_lock lock(mutex_);
+    for (auto &[desc, variant] : variants_)
+    {
+        if (variant->in_flight)
+        {
+            CollectCompile(*variant, frame_index);
+        }
+        if (!variant->in_flight && variant->generation != generation_)
+        {
+            StartCompile(*variant);
+        }
+    }
+}
+
+void PipelineVariants::SetShaders(std::vector<ShaderSource> shaders)
+{
+    std::unique_lock lock(mutex_);
+    shaders_ = std::make_shared<const ShaderSet>(std::move(shaders));
+    generation_++;
+}
+
+uint32_t PipelineVariants::GetVariantCount() const
+{
+    std::shared_lock lock(mutex_);
+    return static_cast<uint32_t>(variants_.size());
+}
+
+uint32_t PipelineVariants::GetReadyCount() const
+{
+    std::shared_lock lock(mutex_);
+    uint32_t count = 0;
+    for (const auto &[desc, variant] : variants_)
+    {
+        count += variant->pipeline.has_value();
+    }
+    return count;
+}
+
+lvk::Pipeline PipelineVariants::CreatePipeline(const lvk::PipelineDesc &desc, const ShaderSet &shaders) const
+{
+    if (desc.polygon_mode != vk::PolygonMode::eFill && !hardware_->GetEnabledFeatures().fillModeNonSolid)
+    {
+        throw std::runtime_error("polygon modes other than fill are unsupported");
+    }
+
+    std::vector<lvk::Shader> modules;
+    for (const auto &shader : shaders)
+    {
+        modules.emplace_back(*hardware_, "main", shader.code, shader.stage);
+    }
+    return lvk::Pipeline(*hardware_, *pipeline_layout_, std::move(modules), *render_pass_, *pipeline_cache_, desc);
+}
+
+void PipelineVariants::StartCompile(Variant &variant)
+{
+    variant.in_flight = true;
+    variant.generation = generation_;
+    // a compile takes milliseconds, on the regular queue a thread waiting for frame work could pick it up
+    jobs_->RunBackground([this, &variant, shaders = shaders_]()
+    {
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            variant.compiled.emplace(CreatePipeline(variant.desc, *shaders));
+        }
+        catch (const std::exception &e)
+        {
+            BOOST_LOG_TRIVIAL(warning) << fmt::format("pipeline variants: variant {:016x} failed to compile, using the fallback: {}", variant.desc.Hash(), e.what());
+            return;
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        BOOST_LOG_TRIVIAL(debug) << fmt::format("pipeline variants: compiled variant {:016x} in {:.2f} ms", variant.desc.Hash(), elapsed.count());
+    }, &variant.compiling);
+}
+
+void PipelineVariants::CollectCompile(Variant &variant, uint32_t frame_index)
+{
+    if (!variant.compiling.IsDone())
+    {
+        return;
+    }
+    // returns right away, makes sure the job system let go of the counter
+    jobs_->Wait(variant.compiling);
+    variant.in_flight = false;
+    if (!variant.compiled)
+    {
+        return;
+    }
+
+    if (variant.pipeline)
+    {
+        retired_[frame_index].push_back(std::move(*variant.pipeline));
+    }
+    variant.pipeline = std::move(variant.compiled);
+    variant.compiled.reset();
+}
+
+}
@@ -0,0 +1,108 @@
+#ifndef _LVK_PIPELINE_VARIANTS_H
+#define _LVK_PIPELINE_VARIANTS_H
+
+// module
+#include "lvk_definitions.hpp"
+#include "lvk_pipeline.hpp"
+#include "lvk_pipeline_desc.hpp"
+#include "lvk_job_system.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace lvk
+{
+class Hardware;
+class PipelineCache;
+
+struct ShaderSource
+{
+    vk::ShaderStageFlagBits stage;
+    std::span<const uint32_t> code;
+    // keeps code alive while variants compile from it, empty when it points into a ShaderBundle
+    std::shared_ptr<const std::vector<uint32_t>> storage;
+};
+
+// Graphics pipelines sharing shaders, layout and render pass, keyed by PipelineDesc. Missing
+// variants are compiled as background jobs, until one is ready Get hands out the default
+// variant, which is compiled up front and draws with the same layout and render pass, so
+// asking for a new variant never stalls the frame. New shaders recompile every variant the
+// same way, each keeps its current pipeline until the replacement is ready.
+class PipelineVariants : public boost::noncopyable
+{
+public:
+    PipelineVariants(const lvk::Hardware &hardware,
+                     const vk::raii::PipelineLayout &pipeline_layout,
+                     const vk::raii::RenderPass &render_pass,
+                     lvk::PipelineCache &pipeline_cache,
+                     lvk::JobSystem &jobs,
+                     std::vector<ShaderSource> shaders,
+                     const lvk::PipelineDesc &default_desc = {});
+    // waits for the compiles still running
+    ~PipelineVariants();
+
+    // safe from any thread. The returned pipeline stays valid until the next NextFrame
+    const lvk::Pipeline &Get(const lvk::PipelineDesc &desc);
+    // at the start of a frame once its fence was waited: swaps in finished compiles, releases
+    // the pipelines replaced when this frame index last ran and starts outdated compiles
+    void NextFrame(uint32_t frame_index);
+    // recompiles every variant from these shaders, takes effect in NextFrame
+    void SetShaders(std::vector<ShaderSource> shaders);
+
+    uint32_t GetVariantCount() const;
+    uint32_t GetReadyCount() const;
+
+private:
+    struct Variant
+    {
+        lvk::PipelineDesc desc;
+        // only replaced in NextFrame, recording threads may be drawing with it
+        std::optional<lvk::Pipeline> pipeline;
+        // written by the compile job, taken once compiling dropped to zero
+        std::optional<lvk::Pipeline> compiled;
+        lvk::JobCounter compiling;
+        bool in_flight{false};
+        // shaders generation the last compile started from, failed compiles aren't retried
+        uint64_t generation{0};
+    };
+
+    using ShaderSet = std::vector<ShaderSource>;
+
+    lvk::Pipeline CreatePipeline(const lvk::PipelineDesc &desc, const ShaderSet &shaders) const;
+    // mutex_ held exclusively or by the render thread in NextFrame
+    void StartCompile(Variant &variant);
+    void CollectCompile(Variant &variant, uint32_t frame_index);
+
+private:
+    const lvk::Hardware *hardware_;
+    const vk::raii::PipelineLayout *pipeline_layout_;
+    const vk::raii::RenderPass *render_pass_;
+    lvk::PipelineCache *pipeline_cache_;
+    lvk::JobSystem *jobs_;
+
+    std::shared_ptr<const ShaderSet> shaders_;
+    uint64_t generation_{1};
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<lvk::PipelineDesc, std::unique_ptr<Variant>, lvk::PipelineDescHash> variants_;
+    Variant *default_variant_;
+    // replaced pipelines, frames in flight may still use them
+    std::array<std::vector<lvk::Pipeline>, MAX_FRAMES_IN_FLIGHT> retired_;
+};
+
+}
+#endif
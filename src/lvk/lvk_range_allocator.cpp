@@ -0,0 +1,106 @@
+#include "lvk_range_allocator.hpp"
+
+// std
+#include <stdexcept>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+RangeAllocator::RangeAllocator(uint32_t capacity) :
+    capacity_(capacity)
+{
+    if (capacity_ > 0)
+    {
+        InsertFreeBlock(0, capacity_);
+    }
+}
+
+std::optional<uint32_t> RangeAllocator::Allocate(uint32_t size)
+{
+    if (size == 0)
+    {
+        return {};
+    }
+
+    auto best = free_by_size_.lower_bound(size);
+    if (best == free_by_size_.end())
+    {
+        return {};
+    }
+
+    auto [block_size, offset] = *best;
+    EraseFreeBlock(free_by_offset_.find(offset));
+    if (block_size > size)
+    {
+        InsertFreeBlock(offset + size, block_size - size);
+    }
+
+    allocated_.emplace(offset, size);
+    used_ += size;
+    return offset;
+}
+
+void RangeAllocator::Free(uint32_t offset)
+{
+    auto it = allocated_.find(offset);
+    if (it == allocated_.end())
+    {
+        throw std::runtime_error(fmt::format("range allocator free unknown offset: {}", offset));
+    }
+
+    auto size = it->second;
+    allocated_.erase(it);
+    used_ -= size;
+
+    // merge with the free neighbours on both sides
+    auto next = free_by_offset_.lower_bound(offset);
+    if (next != free_by_offset_.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = std::next(next);
+        EraseFreeBlock(std::prev(next));
+    }
+
+    if (next != free_by_offset_.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            EraseFreeBlock(prev);
+        }
+    }
+
+    InsertFreeBlock(offset, size);
+}
+
+uint32_t RangeAllocator::GetLargestFreeBlock() const
+{
+    return free_by_size_.empty() ? 0 : free_by_size_.rbegin()->first;
+}
+
+void RangeAllocator::InsertFreeBlock(uint32_t offset, uint32_t size)
+{
+    free_by_offset_.emplace(offset, size);
+    free_by_size_.emplace(size, offset);
+}
+
+void RangeAllocator::EraseFreeBlock(std::map<uint32_t, uint32_t>::iterator it)
+{
+    auto [first, last] = free_by_size_.equal_range(it->second);
+    for (auto size_it = first; size_it != last; ++size_it)
+    {
+        if (size_it->second == it->first)
+        {
+            free_by_size_.erase(size_it);
+            break;
+        }
+    }
+    free_by_offset_.erase(it);
+}
+
+}
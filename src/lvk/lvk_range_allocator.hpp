@@ -0,0 +1,41 @@
+#ifndef _LVK_RANGE_ALLOCATOR_H
+#define _LVK_RANGE_ALLOCATOR_H
+
+// std
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace lvk
+{
+
+// Best fit offset allocator over [0, capacity), it never touches memory itself.
+// Free blocks are indexed by offset (for coalescing) and by size (for best fit),
+// both O(log n).
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator(uint32_t capacity);
+
+    std::optional<uint32_t> Allocate(uint32_t size);
+    void Free(uint32_t offset);
+
+    uint32_t GetCapacity() const { return capacity_; }
+    uint32_t GetUsed() const { return used_; }
+    uint32_t GetLargestFreeBlock() const;
+    size_t GetFreeBlockCount() const { return free_by_offset_.size(); }
+
+private:
+    void InsertFreeBlock(uint32_t offset, uint32_t size);
+    void EraseFreeBlock(std::map<uint32_t, uint32_t>::iterator it);
+
+private:
+    uint32_t capacity_;
+    uint32_t used_{0};
+    std::map<uint32_t, uint32_t> free_by_offset_;
+    std::multimap<uint32_t, uint32_t> free_by_size_;
+    std::map<uint32_t, uint32_t> allocated_;
+};
+
+}
+#endif
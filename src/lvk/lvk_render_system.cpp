@@ -2,7 +2,19 @@
 
 // module
 #include "lvk_hardware.hpp"
+#include "lvk_allocator.hpp"
 #include "lvk_shader.hpp"
+#include "lvk_shader_bundle.hpp"
+#include "lvk_geometry_arena.hpp"
+#include "lvk_model.hpp"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// boost
+#include <boost/log/trivial.hpp>
 
 // glm
 #include <glm/ext.hpp>
@@ -10,60 +22,501 @@
 namespace lvk
 {
 
-RenderSystem::RenderSystem(const lvk::Hardware &hardware, const vk::raii::RenderPass &render_pass) :
+// initial number of draws each frame's buffers can hold, they grow on demand
+constexpr uint32_t INITIAL_DRAW_CAPACITY = 256;
+constexpr uint32_t NO_GROUP = std::numeric_limits<uint32_t>::max();
+// below this many direct draws per thread the secondary buffer costs more than it saves
+constexpr uint32_t MIN_DRAWS_PER_THREAD = 128;
+
+struct PipelineShader
+{
+    lvk::EmbeddedShaderId id;
+    vk::ShaderStageFlagBits stage;
+};
+
+constexpr std::array<PipelineShader, 2> PIPELINE_SHADERS
+{{
+    {"naive/naive.vert", vk::ShaderStageFlagBits::eVertex},
+    {"naive/naive.frag", vk::ShaderStageFlagBits::eFragment}
+}};
+
+RenderSystem::RenderSystem(const lvk::Hardware &hardware, const lvk::Allocator &allocator, const lvk::GeometryArena &geometry_arena, const vk::raii::RenderPass &render_pass, const lvk::ShaderBundle &shaders, lvk::PipelineCache &pipeline_cache, lvk::JobSystem &jobs, bool gpu_culling, uint32_t record_threads) :
+    hardware_(&hardware),
+    allocator_(&allocator),
+    geometry_arena_(&geometry_arena),
+    jobs_(&jobs),
+    shaders_(&shaders),
+    descriptor_set_layout_(ConstructDescriptorSetLayout(hardware)),
+    descriptor_pool_(ConstructDescriptorPool(hardware)),
     pipeline_layout_(ConstructPipelineLayout(hardware)),
-    pipeline_(hardware, pipeline_layout_, LoadShaders(hardware), render_pass)
+    pipelines_(hardware, pipeline_layout_, render_pass, pipeline_cache, jobs, GetShaderSources(shaders, {}), {.vertex_format = geometry_arena.GetVertexFormat()}),
+    camera_(allocator),
+    frame_draws_(ConstructFrameDraws(hardware)),
+    draw_path_(ChooseDrawPath(hardware)),
+    max_draw_indirect_count_(hardware.GetPhysicalDevice().getProperties().limits.maxDrawIndirectCount),
+    gpu_culling_(ConstructGpuCulling(hardware, allocator, shaders, pipeline_cache, gpu_culling)),
+    recorder_(hardware, jobs, record_threads)
 {}
 
-std::vector<lvk::Shader> RenderSystem::LoadShaders(const lvk::Hardware &hardware)
+std::vector<lvk::ShaderSource> RenderSystem::GetShaderSources(const lvk::ShaderBundle &bundle, const ShaderOverrides &reloaded)
+{
+    std::vector<lvk::ShaderSource> sources;
+    for (const auto &shader : PIPELINE_SHADERS)
+    {
+        auto it = reloaded.find(std::string(shader.id.GetName()));
+        if (it != reloaded.end())
+        {
+            sources.push_back({.stage = shader.stage, .code = *it->second, .storage = it->second});
+        }
+        else
+        {
+            sources.push_back({.stage = shader.stage, .code = bundle.Get(shader.id), .storage = nullptr});
+        }
+    }
+    return sources;
+}
+
+void RenderSystem::ReloadShaders(std::vector<lvk::CompiledShader> shaders)
+{
+    bool changed = false;
+    for (auto &shader : shaders)
+    {
+        auto used = std::any_of(PIPELINE_SHADERS.begin(), PIPELINE_SHADERS.end(), [&](const PipelineShader &pipeline_shader) { return pipeline_shader.id.GetName() == shader.name; });
+        if (used)
+        {
+            reloaded_shaders_[std::move(shader.name)] = std::make_shared<const std::vector<uint32_t>>(std::move(shader.code));
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        pipelines_.SetShaders(GetShaderSources(*shaders_, reloaded_shaders_));
+    }
+}
+
+RenderSystem::DrawPath RenderSystem::ChooseDrawPath(const lvk::Hardware &hardware)
+{
+    // without drawIndirectFirstInstance the indirect firstInstance must be 0, so gl_InstanceIndex can't pick the draw data
+    const auto &features = hardware.GetEnabledFeatures();
+    if (!features.drawIndirectFirstInstance)
+    {
+        BOOST_LOG_TRIVIAL(info) << "render system: drawIndirectFirstInstance unsupported, using direct draws";
+        return DrawPath::DIRECT;
+    }
+    if (!features.multiDrawIndirect)
+    {
+        BOOST_LOG_TRIVIAL(info) << "render system: multiDrawIndirect unsupported, using one indirect draw per object";
+        return DrawPath::SINGLE_DRAW_INDIRECT;
+    }
+    BOOST_LOG_TRIVIAL(info) << "render system: using multi draw indirect";
+    return DrawPath::MULTI_DRAW_INDIRECT;
+}
+
+std::optional<lvk::GpuCulling> RenderSystem::ConstructGpuCulling(const lvk::Hardware &hardware, const lvk::Allocator &allocator, const lvk::ShaderBundle &shaders, lvk::PipelineCache &pipeline_cache, bool gpu_culling)
 {
-    std::vector<lvk::Shader> shaders;
-    shaders.emplace_back(hardware, "main", "shaders/naive/naive.vert.spv", vk::ShaderStageFlagBits::eVertex);
-    shaders.emplace_back(hardware, "main", "shaders/naive/naive.frag.spv", vk::ShaderStageFlagBits::eFragment);
-    return std::move(shaders);
+    if (!gpu_culling)
+    {
+        BOOST_LOG_TRIVIAL(info) << "render system: culling on the cpu";
+        return std::nullopt;
+    }
+    if (!GpuCulling::IsSupported(hardware))
+    {
+        BOOST_LOG_TRIVIAL(info) << "render system: draw indirect count unsupported, culling on the cpu";
+        return std::nullopt;
+    }
+    BOOST_LOG_TRIVIAL(info) << "render system: culling on the gpu";
+    return std::optional<lvk::GpuCulling>(std::in_place, hardware, allocator, shaders, pipeline_cache);
 }
 
-void RenderSystem::RenderObjects(const FrameContext &context, std::vector<lvk::GameObject> &objects)
+void RenderSystem::PrepareFrame(const FrameContext &context, const lvk::Scene &scene, const lvk::CameraPose &camera)
 {
-    pipeline_.BindPipeline(context.command_buffer);
+    // the frame's fence was waited, finished variants can be swapped in and old ones released
+    pipelines_.NextFrame(context.frame_index);
+
+    auto &frame_draws = frame_draws_[context.frame_index];
+    // once per frame, every draw reads it from the frame's uniform buffer
+    camera_.Update(context.frame_index, camera, context.extent);
+    auto frustum = ExtractFrustum(camera_.GetUniform().view_projection);
 
-    for (auto &object : objects) {
-        object.SetScale({0.5f, 0.5f, 0.5f});
-        object.SetTranslation({0.f, 0.2f, 0.f});
-        auto rotation = object.GetRotation();
-        rotation.y = glm::mod(rotation.y + glm::radians(-0.1f), glm::two_pi<float>());
-        rotation.x = glm::mod(rotation.x + glm::radians(-0.1f), glm::two_pi<float>());
-        object.SetRotation(rotation);
+    if (gpu_culling_)
+    {
+        gpu_culling_->Prepare(context, scene, frustum);
+        BindWorldBuffer(frame_draws);
+        culling_stats_ = gpu_culling_->GetCullingStats();
+        return;
+    }
 
-        MVP mvp
+    PrepareCpuDraws(frame_draws, scene, frustum);
+}
+
+void RenderSystem::RenderObjects(const FrameContext &context)
+{
+    const auto &frame_draws = frame_draws_[context.frame_index];
+    if (gpu_culling_)
+    {
+        // the compacted draws are a single call, nothing to split
+        recorder_.Record(context, 1, 1, [&](const vk::raii::CommandBuffer &command_buffer, uint32_t, uint32_t)
         {
-            .model = object.ModelMatrix(),
-            .view = glm::lookAt(glm::vec3{0.f, 0.f, 2.f}, glm::vec3{0.f, 0.f, 0.f}, glm::vec3{0.f, -1.f, 0.f}),
-            .projection = glm::perspective(glm::radians(41.f), context.extent.width / (float)context.extent.height, 0.1f, 10.f)
-        };
+            BindState(command_buffer, frame_draws);
+            gpu_culling_->Draw(command_buffer, context.frame_index);
+        });
+        return;
+    }
+
+    // indirect draws cover a whole range with one call, only direct draws are worth splitting
+    auto draw_count = static_cast<uint32_t>(indexed_draws_.size() + vertex_draws_.size());
+    auto min_draws_per_thread = draw_path_ == DrawPath::MULTI_DRAW_INDIRECT ? draw_count : MIN_DRAWS_PER_THREAD;
+    recorder_.Record(context, draw_count, min_draws_per_thread, [&](const vk::raii::CommandBuffer &command_buffer, uint32_t begin, uint32_t end)
+    {
+        BindState(command_buffer, frame_draws);
+        RecordDraws(command_buffer, frame_draws, begin, end);
+    });
+}
 
-        context.command_buffer.pushConstants<MVP>(*pipeline_layout_, vk::ShaderStageFlagBits::eVertex, 0, mvp);
-        object.GetModel()->BindBuffer(context.command_buffer);
-        object.GetModel()->Draw(context.command_buffer);
+void RenderSystem::BindState(const vk::raii::CommandBuffer &command_buffer, const FrameDraws &frame_draws) const
+{
+    auto desc = pipeline_desc_;
+    desc.vertex_format = geometry_arena_->GetVertexFormat();
+    pipelines_.Get(desc).BindPipeline(command_buffer);
+    // every model lives in the arena, geometry is bound once for all draws
+    geometry_arena_->BindBuffers(command_buffer);
+    command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline_layout_, 0, {*frame_draws.descriptor_set}, nullptr);
+}
+
+void RenderSystem::BindWorldBuffer(const FrameDraws &frame_draws)
+{
+    // the world buffer may be reallocated any frame, the frame's own set is not in use anymore
+    vk::DescriptorBufferInfo buffer_info
+    {
+        .buffer = gpu_culling_->GetWorldBuffer(),
+        .offset = 0,
+        .range = VK_WHOLE_SIZE
+    };
+    vk::WriteDescriptorSet write
+    {
+        .dstSet = *frame_draws.descriptor_set,
+        .dstBinding = 0,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = vk::DescriptorType::eStorageBuffer,
+        .pBufferInfo = &buffer_info
+    };
+    hardware_->GetDevice().updateDescriptorSets(write, nullptr);
+}
+
+void RenderSystem::PrepareCpuDraws(FrameDraws &frame_draws, const lvk::Scene &scene, const lvk::Frustum &frustum)
+{
+    ReserveDraws(frame_draws, static_cast<uint32_t>(scene.Size()));
+
+    UpdateWorldSpheres(scene);
+    visible_.resize(scene.Size());
+    CullSpheres(frustum, world_spheres_, visible_.data(), jobs_);
+    culling_stats_ = CullingStats{};
+
+    auto *draw_data = static_cast<DrawData *>(frame_draws.draw_data_buffer->GetMappedData());
+    indexed_draws_.clear();
+    vertex_draws_.clear();
+    group_indices_.clear();
+    instance_groups_.clear();
+    entity_groups_.resize(scene.Size());
+
+    // count the visible instances of every model, first seen order keeps the draw order stable
+    auto models = scene.GetModels();
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        // transform only nodes
+        if (models[i] == nullptr)
+        {
+            entity_groups_[i] = NO_GROUP;
+            continue;
+        }
+        if (!visible_[i])
+        {
+            entity_groups_[i] = NO_GROUP;
+            culling_stats_.culled++;
+            continue;
+        }
+
+        auto [it, inserted] = group_indices_.try_emplace(models[i], static_cast<uint32_t>(instance_groups_.size()));
+        if (inserted)
+        {
+            instance_groups_.push_back(InstanceGroup{.model = models[i]});
+        }
+        instance_groups_[it->second].instance_count++;
+        entity_groups_[i] = it->second;
     }
+
+    // one instanced draw per model, its instances are contiguous in the draw data
+    // and firstInstance makes gl_InstanceIndex index them directly
+    uint32_t first_instance = 0;
+    for (auto &group : instance_groups_)
+    {
+        // models still uploading are skipped, so they don't count as visible either
+        group.resident = group.model->IsResident();
+        if (!group.resident)
+        {
+            continue;
+        }
+        culling_stats_.visible += group.instance_count;
+
+        group.first_instance = first_instance;
+        group.next_instance = first_instance;
+        first_instance += group.instance_count;
+
+        auto range = group.model->GetRange();
+        if (range.index_count > 0)
+        {
+            indexed_draws_.push_back(vk::DrawIndexedIndirectCommand
+            {
+                .indexCount = range.index_count,
+                .instanceCount = group.instance_count,
+                .firstIndex = range.first_index,
+                .vertexOffset = static_cast<int32_t>(range.first_vertex),
+                .firstInstance = group.first_instance
+            });
+        }
+        else
+        {
+            vertex_draws_.push_back(vk::DrawIndirectCommand
+            {
+                .vertexCount = range.vertex_count,
+                .instanceCount = group.instance_count,
+                .firstVertex = range.first_vertex,
+                .firstInstance = group.first_instance
+            });
+        }
+    }
+
+    auto world_matrices = scene.GetWorldMatrices();
+    for (size_t i = 0; i < world_matrices.size(); i++)
+    {
+        if (entity_groups_[i] == NO_GROUP)
+        {
+            continue;
+        }
+
+        auto &group = instance_groups_[entity_groups_[i]];
+        if (group.resident)
+        {
+            draw_data[group.next_instance++] = DrawData{.model = world_matrices[i]};
+        }
+    }
+
+    std::memcpy(frame_draws.indirect_buffer->GetMappedData(), indexed_draws_.data(), indexed_draws_.size() * sizeof(vk::DrawIndexedIndirectCommand));
+    frame_draws.indirect_buffer->FlushMemory(0, VK_WHOLE_SIZE);
+    frame_draws.draw_data_buffer->FlushMemory(0, VK_WHOLE_SIZE);
 }
 
-vk::raii::PipelineLayout RenderSystem::ConstructPipelineLayout(const lvk::Hardware &hardware)
+void RenderSystem::UpdateWorldSpheres(const lvk::Scene &scene)
 {
-    vk::PushConstantRange push_constant_range
+    auto models = scene.GetModels();
+    auto world_matrices = scene.GetWorldMatrices();
+    auto update = [&](size_t i)
+    {
+        if (models[i] == nullptr)
+        {
+            world_spheres_.x[i] = world_spheres_.y[i] = world_spheres_.z[i] = world_spheres_.radius[i] = 0.f;
+            return;
+        }
+
+        const auto &bounds = models[i]->GetBounds();
+        const auto &world = world_matrices[i];
+        auto center = world * glm::vec4(bounds.center, 1.f);
+        auto scale = std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))});
+        world_spheres_.x[i] = center.x;
+        world_spheres_.y[i] = center.y;
+        world_spheres_.z[i] = center.z;
+        world_spheres_.radius[i] = bounds.radius * scale;
+    };
+
+    // the scene reports every index as changed when entities move, so only a size change needs a full rebuild
+    if (world_spheres_.Size() != scene.Size())
+    {
+        world_spheres_.Resize(scene.Size());
+        for (size_t i = 0; i < scene.Size(); i++)
+        {
+            update(i);
+        }
+        return;
+    }
+
+    for (auto i : scene.GetChangedIndices())
+    {
+        update(i);
+    }
+}
+
+void RenderSystem::RecordDraws(const vk::raii::CommandBuffer &command_buffer, const FrameDraws &frame_draws, uint32_t begin, uint32_t end) const
+{
+    const vk::Buffer &indirect_buffer = *frame_draws.indirect_buffer;
+    constexpr uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+    auto indexed_count = static_cast<uint32_t>(indexed_draws_.size());
+    auto indexed_begin = std::min(begin, indexed_count);
+    auto indexed_end = std::min(end, indexed_count);
+
+    switch (draw_path_)
+    {
+        case DrawPath::MULTI_DRAW_INDIRECT:
+            for (uint32_t first = indexed_begin; first < indexed_end; first += max_draw_indirect_count_)
+            {
+                command_buffer.drawIndexedIndirect(indirect_buffer, first * stride, std::min(max_draw_indirect_count_, indexed_end - first), stride);
+            }
+            break;
+        case DrawPath::SINGLE_DRAW_INDIRECT:
+            for (uint32_t i = indexed_begin; i < indexed_end; i++)
+            {
+                command_buffer.drawIndexedIndirect(indirect_buffer, i * stride, 1, stride);
+            }
+            break;
+        case DrawPath::DIRECT:
+            for (uint32_t i = indexed_begin; i < indexed_end; i++)
+            {
+                const auto &draw = indexed_draws_[i];
+                command_buffer.drawIndexed(draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset, draw.firstInstance);
+            }
+            break;
+    }
+
+    // models without indices are rare, they are always drawn directly
+    for (auto i = std::max(begin, indexed_count); i < end; i++)
+    {
+        const auto &draw = vertex_draws_[i - indexed_count];
+        command_buffer.draw(draw.vertexCount, draw.instanceCount, draw.firstVertex, draw.firstInstance);
+    }
+}
+
+void RenderSystem::ReserveDraws(FrameDraws &frame_draws, uint32_t count)
+{
+    if (count <= frame_draws.capacity)
+    {
+        return;
+    }
+
+    // the frame's fence was waited, its old buffers are no longer read by the gpu
+    auto capacity = std::max(count, frame_draws.capacity * 2);
+    VmaAllocationCreateInfo alloc_info{.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, .usage = VMA_MEMORY_USAGE_AUTO};
+    frame_draws.indirect_buffer.emplace(
+        *allocator_,
+        vk::BufferCreateInfo{.size = capacity * sizeof(vk::DrawIndexedIndirectCommand), .usage = vk::BufferUsageFlagBits::eIndirectBuffer, .sharingMode = vk::SharingMode::eExclusive},
+        alloc_info);
+    frame_draws.draw_data_buffer.emplace(
+        *allocator_,
+        vk::BufferCreateInfo{.size = capacity * sizeof(DrawData), .usage = vk::BufferUsageFlagBits::eStorageBuffer, .sharingMode = vk::SharingMode::eExclusive},
+        alloc_info);
+    frame_draws.capacity = capacity;
+
+    vk::DescriptorBufferInfo buffer_info
     {
-        .stageFlags = vk::ShaderStageFlagBits::eVertex,
+        .buffer = *frame_draws.draw_data_buffer,
         .offset = 0,
-        .size = sizeof(MVP),
+        .range = VK_WHOLE_SIZE
+    };
+    vk::WriteDescriptorSet write
+    {
+        .dstSet = *frame_draws.descriptor_set,
+        .dstBinding = 0,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = vk::DescriptorType::eStorageBuffer,
+        .pBufferInfo = &buffer_info
+    };
+    hardware_->GetDevice().updateDescriptorSets(write, nullptr);
+}
+
+std::array<RenderSystem::FrameDraws, MAX_FRAMES_IN_FLIGHT> RenderSystem::ConstructFrameDraws(const lvk::Hardware &hardware)
+{
+    std::array<vk::DescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts;
+    layouts.fill(*descriptor_set_layout_);
+    vk::DescriptorSetAllocateInfo allocate_info
+    {
+        .descriptorPool = *descriptor_pool_,
+        .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
+        .pSetLayouts = layouts.data()
     };
+    auto descriptor_sets = hardware.GetDevice().allocateDescriptorSets(allocate_info);
 
+    std::array<FrameDraws, MAX_FRAMES_IN_FLIGHT> frame_draws;
+    for (uint32_t i = 0; i < frame_draws.size(); i++)
+    {
+        frame_draws[i].descriptor_set = std::move(descriptor_sets[i]);
+        ReserveDraws(frame_draws[i], INITIAL_DRAW_CAPACITY);
+
+        // the camera's buffers live as long as the render system
+        auto camera_info = camera_.GetBufferInfo(i);
+        vk::WriteDescriptorSet camera_write
+        {
+            .dstSet = *frame_draws[i].descriptor_set,
+            .dstBinding = 1,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eUniformBuffer,
+            .pBufferInfo = &camera_info
+        };
+        hardware.GetDevice().updateDescriptorSets(camera_write, nullptr);
+    }
+    return frame_draws;
+}
+
+vk::raii::DescriptorSetLayout RenderSystem::ConstructDescriptorSetLayout(const lvk::Hardware &hardware)
+{
+    std::array<vk::DescriptorSetLayoutBinding, 2> bindings
+    {{
+        {
+            .binding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eVertex
+        },
+        {
+            .binding = 1,
+            .descriptorType = vk::DescriptorType::eUniformBuffer,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eVertex
+        }
+    }};
+
+    vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info
+    {
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    };
+
+    return vk::raii::DescriptorSetLayout(hardware.GetDevice(), descriptor_set_layout_create_info);
+}
+
+vk::raii::DescriptorPool RenderSystem::ConstructDescriptorPool(const lvk::Hardware &hardware)
+{
+    std::array<vk::DescriptorPoolSize, 2> pool_sizes
+    {{
+        {.type = vk::DescriptorType::eStorageBuffer, .descriptorCount = MAX_FRAMES_IN_FLIGHT},
+        {.type = vk::DescriptorType::eUniformBuffer, .descriptorCount = MAX_FRAMES_IN_FLIGHT}
+    }};
+
+    // raii descriptor sets free themselves
+    vk::DescriptorPoolCreateInfo descriptor_pool_create_info
+    {
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = MAX_FRAMES_IN_FLIGHT,
+        .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
+        .pPoolSizes = pool_sizes.data()
+    };
+
+    return vk::raii::DescriptorPool(hardware.GetDevice(), descriptor_pool_create_info);
+}
+
+vk::raii::PipelineLayout RenderSystem::ConstructPipelineLayout(const lvk::Hardware &hardware)
+{
+    // the camera is a uniform and per object data is indexed by gl_InstanceIndex, nothing is pushed
     vk::PipelineLayoutCreateInfo pipeline_layout_create_info
     {
-        .pushConstantRangeCount = 1,
-        .pPushConstantRanges = &push_constant_range
+        .setLayoutCount = 1,
+        .pSetLayouts = &*descriptor_set_layout_,
+        .pushConstantRangeCount = 0,
+        .pPushConstantRanges = nullptr
     };
 
     return vk::raii::PipelineLayout(hardware.GetDevice(), pipeline_layout_create_info);
 }
 
-}
\ No newline at end of file
+}
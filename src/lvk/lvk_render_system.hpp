@@ -3,12 +3,27 @@
 
 // module
 #include "lvk_definitions.hpp"
+#include "lvk_buffer.hpp"
+#include "lvk_camera.hpp"
 #include "lvk_pipeline.hpp"
-#include "lvk_game_object.hpp"
+#include "lvk_pipeline_variants.hpp"
+#include "lvk_scene.hpp"
+#include "lvk_scene_snapshot.hpp"
+#include "lvk_culling.hpp"
+#include "lvk_gpu_culling.hpp"
+#include "lvk_parallel_recorder.hpp"
+#include "lvk_shader_watcher.hpp"
 
 // boost
 #include <boost/noncopyable.hpp>
 
+// std
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
 // vulkan
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -16,30 +31,117 @@
 namespace lvk
 {
 class Hardware;
+class Allocator;
+class GeometryArena;
+class JobSystem;
+class PipelineCache;
+class ShaderBundle;
 
-struct MVP
+// per instance data, the vertex shader reads it with gl_InstanceIndex
+struct DrawData
 {
     alignas(16) glm::mat4 model{1.0f};
-    alignas(16) glm::mat4 view{1.0f};
-    alignas(16) glm::mat4 projection{1.0f};
 };
 
 class RenderSystem : public boost::noncopyable
 {
 public:
-    RenderSystem(const lvk::Hardware &hardware, const vk::raii::RenderPass &render_pass);
+    // gpu_culling falls back to culling on the cpu when the device can't do it, cpu culling and
+    // recording run as jobs, 0 record_threads picks the job system's thread count
+    RenderSystem(const lvk::Hardware &hardware, const lvk::Allocator &allocator, const lvk::GeometryArena &geometry_arena, const vk::raii::RenderPass &render_pass, const lvk::ShaderBundle &shaders, lvk::PipelineCache &pipeline_cache, lvk::JobSystem &jobs, bool gpu_culling = true, uint32_t record_threads = 0);
     RenderSystem(RenderSystem &&other) noexcept;
 
-    void RenderObjects(const FrameContext &context, std::vector<lvk::GameObject> &objects);
+    // culls and writes this frame's draws, must be recorded outside of the render pass
+    // world matrices are taken as they are, call Scene::UpdateWorldMatrices first
+    void PrepareFrame(const FrameContext &context, const lvk::Scene &scene, const lvk::CameraPose &camera);
+    // records the draws of the last PrepareFrame into secondary command buffers, the render
+    // pass has to be begun with vk::SubpassContents::eSecondaryCommandBuffers
+    void RenderObjects(const FrameContext &context);
+    // recompiles the pipelines with the changed shaders on jobs, a later PrepareFrame swaps them
+    // in once they're ready and retires the old ones after the frames using them completed.
+    // Shaders the pipelines don't use are ignored
+    void ReloadShaders(std::vector<lvk::CompiledShader> shaders);
+    // state of the following frames' draws, a variant that isn't compiled yet draws with the default state meanwhile.
+    // The vertex format always is the geometry arena's
+    void SetPipelineDesc(const lvk::PipelineDesc &desc) { pipeline_desc_ = desc; }
+
+    bool IsGpuCulling() const { return gpu_culling_.has_value(); }
+    // of the last PrepareFrame, lags a few frames with gpu culling
+    const CullingStats &GetCullingStats() const { return culling_stats_; }
 
 private:
-    std::vector<lvk::Shader> LoadShaders(const lvk::Hardware &hardware);
+    enum class DrawPath { MULTI_DRAW_INDIRECT, SINGLE_DRAW_INDIRECT, DIRECT };
+
+    // host visible buffers written by the cpu each frame, one set per frame in flight
+    struct FrameDraws
+    {
+        std::optional<lvk::Buffer> indirect_buffer;
+        std::optional<lvk::Buffer> draw_data_buffer;
+        uint32_t capacity{0};
+        vk::raii::DescriptorSet descriptor_set{nullptr};
+    };
+
+    struct InstanceGroup
+    {
+        const lvk::Model *model;
+        bool resident{false};
+        uint32_t instance_count{0};
+        uint32_t first_instance{0};
+        uint32_t next_instance{0};
+    };
+
+    using ShaderOverrides = std::unordered_map<std::string, std::shared_ptr<const std::vector<uint32_t>>>;
+
+    static std::vector<lvk::ShaderSource> GetShaderSources(const lvk::ShaderBundle &bundle, const ShaderOverrides &reloaded);
+    vk::raii::DescriptorSetLayout ConstructDescriptorSetLayout(const lvk::Hardware &hardware);
+    vk::raii::DescriptorPool ConstructDescriptorPool(const lvk::Hardware &hardware);
     vk::raii::PipelineLayout ConstructPipelineLayout(const lvk::Hardware &hardware);
+    std::array<FrameDraws, MAX_FRAMES_IN_FLIGHT> ConstructFrameDraws(const lvk::Hardware &hardware);
+    DrawPath ChooseDrawPath(const lvk::Hardware &hardware);
+    std::optional<lvk::GpuCulling> ConstructGpuCulling(const lvk::Hardware &hardware, const lvk::Allocator &allocator, const lvk::ShaderBundle &shaders, lvk::PipelineCache &pipeline_cache, bool gpu_culling);
+    void PrepareCpuDraws(FrameDraws &frame_draws, const lvk::Scene &scene, const lvk::Frustum &frustum);
+    // points the vertex shader's draw data at the culling pass's world matrices
+    void BindWorldBuffer(const FrameDraws &frame_draws);
+    void ReserveDraws(FrameDraws &frame_draws, uint32_t count);
+    // world space bounding spheres, only entities whose world matrix changed are refreshed
+    void UpdateWorldSpheres(const lvk::Scene &scene);
+    // every secondary command buffer starts without any bound state
+    void BindState(const vk::raii::CommandBuffer &command_buffer, const FrameDraws &frame_draws) const;
+    // [begin, end) indexes the indexed draws followed by the non indexed ones
+    void RecordDraws(const vk::raii::CommandBuffer &command_buffer, const FrameDraws &frame_draws, uint32_t begin, uint32_t end) const;
 
 private:
+    const lvk::Hardware *hardware_;
+    const lvk::Allocator *allocator_;
+    const lvk::GeometryArena *geometry_arena_;
+    lvk::JobSystem *jobs_;
+    const lvk::ShaderBundle *shaders_;
+    vk::raii::DescriptorSetLayout descriptor_set_layout_;
+    vk::raii::DescriptorPool descriptor_pool_;
     vk::raii::PipelineLayout pipeline_layout_;
-    lvk::Pipeline pipeline_;
+    lvk::PipelineVariants pipelines_;
+    lvk::PipelineDesc pipeline_desc_;
+    // hot reloaded code by shader name
+    ShaderOverrides reloaded_shaders_;
+    lvk::Camera camera_;
+    std::array<FrameDraws, MAX_FRAMES_IN_FLIGHT> frame_draws_;
+    DrawPath draw_path_;
+    uint32_t max_draw_indirect_count_;
+    std::optional<lvk::GpuCulling> gpu_culling_;
+    lvk::ParallelRecorder recorder_;
+
+    // cpu side copies of this frame's commands, the direct path records from them
+    std::vector<vk::DrawIndexedIndirectCommand> indexed_draws_;
+    std::vector<vk::DrawIndirectCommand> vertex_draws_;
+    // per frame scratch for grouping entities by model, kept to reuse the allocations
+    std::unordered_map<const lvk::Model *, uint32_t> group_indices_;
+    std::vector<InstanceGroup> instance_groups_;
+    std::vector<uint32_t> entity_groups_;
+
+    lvk::SphereList world_spheres_;
+    std::vector<uint8_t> visible_;
+    CullingStats culling_stats_;
 };
 
 }
-#endif
\ No newline at end of file
+#endif
@@ -2,6 +2,7 @@
 
 // module
 #include "lvk_hardware.hpp"
+#include "lvk_allocator.hpp"
 #include "lvk_surface.hpp"
 #include "sdl2pp/sdl2pp.hpp"
 
@@ -15,9 +16,23 @@ namespace lvk
 
 Renderer::Renderer(const lvk::Hardware &hardware, const lvk::Surface &surface, const lvk::SDLWindow &window) :
     hardware_(&hardware),
-    swapchain_(hardware, surface, window),
+    swapchain_(std::in_place, hardware, surface, window),
     command_pool_(ConstructCommandPool(hardware)),
     command_buffers_(ConstructCommandBuffers(hardware))
+{
+    ConstructSyncObjects(hardware);
+}
+
+Renderer::Renderer(const lvk::Hardware &hardware, const lvk::Allocator &allocator, vk::Extent2D extent) :
+    hardware_(&hardware),
+    offscreen_(std::in_place, hardware, allocator, extent),
+    command_pool_(ConstructCommandPool(hardware)),
+    command_buffers_(ConstructCommandBuffers(hardware))
+{
+    ConstructSyncObjects(hardware);
+}
+
+void Renderer::ConstructSyncObjects(const lvk::Hardware &hardware)
 {
     vk::SemaphoreCreateInfo semaphore_create_info{};
     vk::FenceCreateInfo fence_create_info{.flags = vk::FenceCreateFlagBits::eSignaled};
@@ -64,8 +79,15 @@ void Renderer::DrawFrame(RecordCommandBufferCallback recorder)
         throw std::runtime_error(fmt::format("waitForFences error result: {}", (int)wait_result));
     }
 
+    if (IsHeadless())
+    {
+        DrawOffscreenFrame(frame_index, recorder);
+        frame_counter_++;
+        return;
+    }
+
     // acquire next image
-    auto [acquire_result, image_index] = swapchain_.GetSwapchain().acquireNextImage(std::numeric_limits<uint64_t>::max(), *image_available_semaphores_[frame_index]);
+    auto [acquire_result, image_index] = swapchain_->GetSwapchain().acquireNextImage(std::numeric_limits<uint64_t>::max(), *image_available_semaphores_[frame_index]);
     if (acquire_result == vk::Result::eErrorOutOfDateKHR)
     {
         ReCreateSwapchain();
@@ -83,10 +105,9 @@ void Renderer::DrawFrame(RecordCommandBufferCallback recorder)
     {
         .frame_index = frame_index,
         .command_buffer = command_buffers_[frame_index],
-        .framebuffer = swapchain_.GetFrameBuffer(image_index),
-        .render_pass = swapchain_.GetRenderPass(),
-        .swapchain = swapchain_.GetSwapchain(),
-        .extent = swapchain_.GetExtent()
+        .framebuffer = swapchain_->GetFrameBuffer(image_index),
+        .render_pass = swapchain_->GetRenderPass(),
+        .extent = swapchain_->GetExtent()
     };
 
     recorder(frame_context);
@@ -106,9 +127,12 @@ void Renderer::DrawFrame(RecordCommandBufferCallback recorder)
         .pSignalSemaphores = signal_semaphores.data()
     };
     vk::ArrayProxy<const vk::SubmitInfo> submit_infos(submit_info);
-    hardware_->GetQueue(Hardware::QueueType::GRAPHICS)->submit(submit_infos, *in_flight_fences_[frame_index]);
+    {
+        auto queue_lock = hardware_->LockQueue(Hardware::QueueType::GRAPHICS);
+        hardware_->GetQueue(Hardware::QueueType::GRAPHICS)->submit(submit_infos, *in_flight_fences_[frame_index]);
+    }
 
-    vk::ArrayProxy<const vk::SwapchainKHR> swapchains(*swapchain_.GetSwapchain());
+    vk::ArrayProxy<const vk::SwapchainKHR> swapchains(*swapchain_->GetSwapchain());
     vk::PresentInfoKHR present_info
     {
         .waitSemaphoreCount = signal_semaphores.size(),
@@ -118,10 +142,41 @@ void Renderer::DrawFrame(RecordCommandBufferCallback recorder)
         .pImageIndices = &image_index
     };
 
+    auto queue_lock = hardware_->LockQueue(Hardware::QueueType::PRESENT);
     auto present_result = hardware_->GetQueue(Hardware::QueueType::PRESENT)->presentKHR(present_info);
     frame_counter_++;
 }
 
+void Renderer::DrawOffscreenFrame(uint32_t frame_index, RecordCommandBufferCallback &recorder)
+{
+    // nothing to acquire or present, the fence alone keeps MAX_FRAMES_IN_FLIGHT images busy at most
+    vk::ArrayProxy<const vk::Fence> wait_fences(*in_flight_fences_[frame_index]);
+    hardware_->GetDevice().resetFences(wait_fences);
+
+    FrameContext frame_context
+    {
+        .frame_index = frame_index,
+        .command_buffer = command_buffers_[frame_index],
+        .framebuffer = offscreen_->GetFrameBuffer(frame_index),
+        .render_pass = offscreen_->GetRenderPass(),
+        .extent = offscreen_->GetExtent()
+    };
+
+    recorder(frame_context);
+
+    vk::ArrayProxy<const vk::CommandBuffer> submit_command_buffers(*command_buffers_[frame_index]);
+    vk::SubmitInfo submit_info
+    {
+        .commandBufferCount = submit_command_buffers.size(),
+        .pCommandBuffers = submit_command_buffers.data(),
+    };
+    vk::ArrayProxy<const vk::SubmitInfo> submit_infos(submit_info);
+    {
+        auto queue_lock = hardware_->LockQueue(Hardware::QueueType::GRAPHICS);
+        hardware_->GetQueue(Hardware::QueueType::GRAPHICS)->submit(submit_infos, *in_flight_fences_[frame_index]);
+    }
+}
+
 void Renderer::ReCreateSwapchain()
 {
 }
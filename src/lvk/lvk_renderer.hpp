@@ -4,10 +4,14 @@
 // module
 #include "lvk_definitions.hpp"
 #include "lvk_swapchain.hpp"
+#include "lvk_offscreen.hpp"
 
 // boost
 #include <boost/noncopyable.hpp>
 
+// std
+#include <optional>
+
 // vulkan
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -15,6 +19,7 @@
 namespace lvk
 {
 class Hardware;
+class Allocator;
 class Surface;
 class SDLWindow;
 
@@ -23,6 +28,7 @@ class Renderer : public boost::noncopyable
 public:
 
     Renderer(const lvk::Hardware &hardware, const lvk::Surface &surface, const lvk::SDLWindow &window);
+    Renderer(const lvk::Hardware &hardware, const lvk::Allocator &allocator, vk::Extent2D extent);
     Renderer(Renderer &&other) noexcept;
     
     using RecordCommandBufferCallback = std::function<void(const FrameContext &context)>;
@@ -30,18 +36,24 @@ public:
 
 public:
     uint64_t GetFrameCounter() const { return frame_counter_; }
-    const vk::raii::RenderPass &GetRenderPass() const { return swapchain_.GetRenderPass(); }
+    bool IsHeadless() const { return offscreen_.has_value(); }
+    const vk::raii::RenderPass &GetRenderPass() const { return swapchain_ ? swapchain_->GetRenderPass() : offscreen_->GetRenderPass(); }
+    vk::Extent2D GetExtent() const { return swapchain_ ? swapchain_->GetExtent() : offscreen_->GetExtent(); }
 
 private:
     vk::raii::CommandPool ConstructCommandPool(const lvk::Hardware &hardware);
     std::vector<vk::raii::CommandBuffer> ConstructCommandBuffers(const lvk::Hardware &hardware);
+    void ConstructSyncObjects(const lvk::Hardware &hardware);
 
+    void DrawOffscreenFrame(uint32_t frame_index, RecordCommandBufferCallback &recorder);
     void ReCreateSwapchain();
 private:
     const lvk::Hardware *hardware_;
 
 private:
-    lvk::Swapchain swapchain_;
+    // exactly one of them is engaged
+    std::optional<lvk::Swapchain> swapchain_;
+    std::optional<lvk::Offscreen> offscreen_;
     vk::raii::CommandPool command_pool_;
     std::vector<vk::raii::CommandBuffer> command_buffers_;
     std::vector<vk::raii::Semaphore> image_available_semaphores_;
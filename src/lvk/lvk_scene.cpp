@@ -0,0 +1,431 @@
+#include "lvk_scene.hpp"
+
+// module
+#include "lvk_transform.hpp"
+#include "lvk_job_system.hpp"
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+// fmt
+#include <fmt/format.h>
+
+// glm
+#include <glm/ext.hpp>
+
+namespace lvk
+{
+
+// the local transform was set since the last update
+constexpr uint8_t DIRTY_LOCAL = 1;
+// the world matrix was recomputed in the running update, children have to follow
+constexpr uint8_t DIRTY_WORLD = 2;
+// below this many dirty transforms a job costs more than it saves
+constexpr uint32_t PARALLEL_TRANSFORM_THRESHOLD = 16 * 1024;
+
+template <typename T>
+static void SwapRemove(std::vector<T> &values, uint32_t index)
+{
+    if (index + 1 != values.size())
+    {
+        values[index] = std::move(values.back());
+    }
+    values.pop_back();
+}
+
+template <typename T>
+static void Permute(std::vector<T> &values, const std::vector<uint32_t> &order, std::vector<T> &scratch)
+{
+    scratch.clear();
+    scratch.reserve(values.size());
+    for (auto index : order)
+    {
+        scratch.push_back(std::move(values[index]));
+    }
+    values.swap(scratch);
+}
+
+Scene::Entity Scene::Create(std::shared_ptr<lvk::Model> model, Entity parent)
+{
+    // a new entity goes last, its parent already is in front of it so the order holds
+    auto parent_index = parent.IsValid() ? GetDenseIndex(parent) : NO_PARENT;
+
+    Entity entity;
+    if (!free_indices_.empty())
+    {
+        entity.index = free_indices_.back();
+        free_indices_.pop_back();
+    }
+    else
+    {
+        entity.index = static_cast<uint32_t>(dense_indices_.size());
+        dense_indices_.push_back(Entity::INVALID_INDEX);
+        generations_.push_back(0);
+    }
+    entity.generation = generations_[entity.index];
+    dense_indices_[entity.index] = static_cast<uint32_t>(entities_.size());
+
+    translations_.push_back({0.f, 0.f, 0.5f});
+    rotations_.push_back({0.f, 0.f, 0.f});
+    scales_.push_back({1.f, 1.f, 1.f});
+    local_matrices_.emplace_back(1.f);
+    world_matrices_.emplace_back(1.f);
+    models_.push_back(model.get());
+    entities_.push_back(entity);
+    parents_.push_back(parent_index != NO_PARENT ? parent : Entity{});
+    parent_indices_.push_back(parent_index);
+    dirty_.push_back(DIRTY_LOCAL);
+    transforms_dirty_ = true;
+
+    AcquireModel(std::move(model));
+    return entity;
+}
+
+void Scene::Destroy(Entity entity)
+{
+    if (hierarchy_dirty_)
+    {
+        SortHierarchy();
+    }
+
+    // sorted, so a single forward pass finds every descendant
+    auto root = GetDenseIndex(entity);
+    std::vector<bool> doomed(entities_.size() - root, false);
+    doomed[0] = true;
+    for (auto i = root + 1; i < entities_.size(); i++)
+    {
+        auto parent = parent_indices_[i];
+        doomed[i - root] = parent != NO_PARENT && parent >= root && doomed[parent - root];
+    }
+
+    // back to front, whatever is swapped into a hole is never doomed
+    for (auto i = static_cast<uint32_t>(entities_.size()); i-- > root;)
+    {
+        if (!doomed[i - root])
+        {
+            continue;
+        }
+
+        auto dead = entities_[i];
+        ReleaseModel(models_[i]);
+        RemoveDense(i);
+        dense_indices_[dead.index] = Entity::INVALID_INDEX;
+        generations_[dead.index]++;
+        free_indices_.push_back(dead.index);
+    }
+    hierarchy_dirty_ = true;
+}
+
+void Scene::RemoveDense(uint32_t dense_index)
+{
+    auto last = static_cast<uint32_t>(entities_.size() - 1);
+    if (dense_index != last)
+    {
+        dense_indices_[entities_[last].index] = dense_index;
+    }
+
+    SwapRemove(translations_, dense_index);
+    SwapRemove(rotations_, dense_index);
+    SwapRemove(scales_, dense_index);
+    SwapRemove(local_matrices_, dense_index);
+    SwapRemove(world_matrices_, dense_index);
+    SwapRemove(models_, dense_index);
+    SwapRemove(entities_, dense_index);
+    SwapRemove(parents_, dense_index);
+    SwapRemove(parent_indices_, dense_index);
+    SwapRemove(dirty_, dense_index);
+}
+
+void Scene::SetParent(Entity entity, Entity parent)
+{
+    auto index = GetDenseIndex(entity);
+    if (parent.IsValid())
+    {
+        for (auto ancestor = parent; ancestor.IsValid(); ancestor = parents_[GetDenseIndex(ancestor)])
+        {
+            if (ancestor == entity)
+            {
+                throw std::runtime_error(fmt::format("scene entity {}:{} can't be parented to its own descendant", entity.index, entity.generation));
+            }
+        }
+    }
+
+    parents_[index] = parent;
+    parent_indices_[index] = parent.IsValid() ? GetDenseIndex(parent) : NO_PARENT;
+    if (parent_indices_[index] != NO_PARENT && parent_indices_[index] > index)
+    {
+        hierarchy_dirty_ = true;
+    }
+    dirty_[index] |= DIRTY_LOCAL;
+    transforms_dirty_ = true;
+}
+
+Scene::Entity Scene::GetParent(Entity entity) const
+{
+    return parents_[GetDenseIndex(entity)];
+}
+
+bool Scene::IsAlive(Entity entity) const
+{
+    return entity.index < generations_.size() && generations_[entity.index] == entity.generation;
+}
+
+uint32_t Scene::GetDenseIndex(Entity entity) const
+{
+    if (!IsAlive(entity))
+    {
+        throw std::runtime_error(fmt::format("scene entity {}:{} is not alive", entity.index, entity.generation));
+    }
+    return dense_indices_[entity.index];
+}
+
+std::vector<const lvk::Model *> Scene::GetUniqueModels() const
+{
+    std::vector<const lvk::Model *> models;
+    models.reserve(model_references_.size());
+    for (const auto &[model, reference] : model_references_)
+    {
+        models.push_back(model);
+    }
+    return models;
+}
+
+std::vector<std::shared_ptr<lvk::Model>> Scene::GetModelReferences() const
+{
+    std::vector<std::shared_ptr<lvk::Model>> models;
+    models.reserve(model_references_.size());
+    for (const auto &[model, reference] : model_references_)
+    {
+        models.push_back(reference.model);
+    }
+    return models;
+}
+
+void Scene::MarkDirty(Entity entity)
+{
+    dirty_[GetDenseIndex(entity)] |= DIRTY_LOCAL;
+    transforms_dirty_ = true;
+}
+
+void Scene::SetTranslation(Entity entity, const glm::vec3 &translation)
+{
+    translations_[GetDenseIndex(entity)] = translation;
+    MarkDirty(entity);
+}
+
+void Scene::SetRotation(Entity entity, const glm::vec3 &rotation)
+{
+    rotations_[GetDenseIndex(entity)] = rotation;
+    MarkDirty(entity);
+}
+
+void Scene::SetScale(Entity entity, const glm::vec3 &scale)
+{
+    scales_[GetDenseIndex(entity)] = scale;
+    MarkDirty(entity);
+}
+
+void Scene::SortHierarchy()
+{
+    auto count = static_cast<uint32_t>(entities_.size());
+    for (uint32_t i = 0; i < count; i++)
+    {
+        parent_indices_[i] = parents_[i].IsValid() ? dense_indices_[parents_[i].index] : NO_PARENT;
+    }
+
+    // depth first, walking up until an ancestor with a known depth
+    constexpr uint32_t UNKNOWN_DEPTH = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> depths(count, UNKNOWN_DEPTH);
+    std::vector<uint32_t> chain;
+    uint32_t max_depth = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        auto current = i;
+        while (current != NO_PARENT && depths[current] == UNKNOWN_DEPTH)
+        {
+            chain.push_back(current);
+            current = parent_indices_[current];
+        }
+
+        auto depth = current == NO_PARENT ? 0 : depths[current] + 1;
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+        {
+            depths[*it] = depth++;
+        }
+        max_depth = std::max(max_depth, depths[i]);
+        chain.clear();
+    }
+
+    // stable counting sort by depth puts every parent in front of its children
+    std::vector<uint32_t> offsets(max_depth + 2, 0);
+    for (auto depth : depths)
+    {
+        offsets[depth + 1]++;
+    }
+    for (size_t d = 1; d < offsets.size(); d++)
+    {
+        offsets[d] += offsets[d - 1];
+    }
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        order[offsets[depths[i]]++] = i;
+    }
+
+    {
+        std::vector<glm::vec3> vec3_scratch;
+        std::vector<glm::mat4> mat4_scratch;
+        std::vector<const lvk::Model *> model_scratch;
+        std::vector<Entity> entity_scratch;
+        std::vector<uint8_t> dirty_scratch;
+        Permute(translations_, order, vec3_scratch);
+        Permute(rotations_, order, vec3_scratch);
+        Permute(scales_, order, vec3_scratch);
+        Permute(local_matrices_, order, mat4_scratch);
+        Permute(world_matrices_, order, mat4_scratch);
+        Permute(models_, order, model_scratch);
+        Permute(entities_, order, entity_scratch);
+        Permute(parents_, order, entity_scratch);
+        Permute(dirty_, order, dirty_scratch);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        dense_indices_[entities_[i].index] = i;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        parent_indices_[i] = parents_[i].IsValid() ? dense_indices_[parents_[i].index] : NO_PARENT;
+    }
+
+    // every dense index may have moved, report all of them as changed
+    std::fill(dirty_.begin(), dirty_.end(), DIRTY_LOCAL);
+    transforms_dirty_ = true;
+    hierarchy_dirty_ = false;
+}
+
+static void ComposeBatch(const glm::vec3 *translations, const glm::vec3 *rotations, const glm::vec3 *scales, glm::mat4 *matrices, size_t count, JobSystem *jobs)
+{
+    if (jobs == nullptr)
+    {
+        ComposeTransforms(translations, rotations, scales, matrices, count);
+        return;
+    }
+    jobs->ParallelFor(0, static_cast<uint32_t>(count), PARALLEL_TRANSFORM_THRESHOLD, [&](uint32_t begin, uint32_t end)
+    {
+        ComposeTransforms(translations + begin, rotations + begin, scales + begin, matrices + begin, end - begin);
+    });
+}
+
+void Scene::ComputeLocalMatrices(JobSystem *jobs)
+{
+    dirty_indices_.clear();
+    for (uint32_t i = 0; i < dirty_.size(); i++)
+    {
+        if (dirty_[i] & DIRTY_LOCAL)
+        {
+            dirty_indices_.push_back(i);
+        }
+    }
+
+    if (dirty_indices_.size() == local_matrices_.size())
+    {
+        ComposeBatch(translations_.data(), rotations_.data(), scales_.data(), local_matrices_.data(), local_matrices_.size(), jobs);
+        return;
+    }
+
+    // gather the dirty ones so the batch kernel still sees contiguous input
+    batch_translations_.clear();
+    batch_rotations_.clear();
+    batch_scales_.clear();
+    for (auto i : dirty_indices_)
+    {
+        batch_translations_.push_back(translations_[i]);
+        batch_rotations_.push_back(rotations_[i]);
+        batch_scales_.push_back(scales_[i]);
+    }
+    batch_matrices_.resize(dirty_indices_.size());
+    ComposeBatch(batch_translations_.data(), batch_rotations_.data(), batch_scales_.data(), batch_matrices_.data(), batch_matrices_.size(), jobs);
+    for (size_t k = 0; k < dirty_indices_.size(); k++)
+    {
+        local_matrices_[dirty_indices_[k]] = batch_matrices_[k];
+    }
+}
+
+void Scene::UpdateWorldMatrices(JobSystem *jobs)
+{
+    changed_indices_.clear();
+    if (hierarchy_dirty_)
+    {
+        SortHierarchy();
+    }
+    if (!transforms_dirty_)
+    {
+        return;
+    }
+
+    ComputeLocalMatrices(jobs);
+
+    // parents come first, so their DIRTY_WORLD bit is final when a child reads it
+    for (uint32_t i = 0; i < world_matrices_.size(); i++)
+    {
+        auto parent = parent_indices_[i];
+        bool changed = (dirty_[i] & DIRTY_LOCAL) || (parent != NO_PARENT && (dirty_[parent] & DIRTY_WORLD));
+        if (!changed)
+        {
+            continue;
+        }
+
+        world_matrices_[i] = parent == NO_PARENT ? local_matrices_[i] : world_matrices_[parent] * local_matrices_[i];
+        dirty_[i] = DIRTY_WORLD;
+        changed_indices_.push_back(i);
+    }
+
+    for (auto i : changed_indices_)
+    {
+        dirty_[i] = 0;
+    }
+    transforms_dirty_ = false;
+}
+
+glm::mat4 Scene::ComposeTransform(const glm::vec3 &translation, const glm::vec3 &rotation, const glm::vec3 &scale)
+{
+    auto model = glm::translate(glm::mat4{1.f}, translation);
+    model = glm::rotate(model, rotation.y, glm::vec3{0, 1, 0});
+    model = glm::rotate(model, rotation.x, glm::vec3{1, 0, 0});
+    model = glm::rotate(model, rotation.z, glm::vec3{0, 0, 1});
+    model = glm::scale(model, scale);
+    return model;
+}
+
+void Scene::AcquireModel(std::shared_ptr<lvk::Model> model)
+{
+    if (!model)
+    {
+        return;
+    }
+
+    auto &reference = model_references_[model.get()];
+    if (!reference.model)
+    {
+        reference.model = std::move(model);
+    }
+    reference.entity_count++;
+}
+
+void Scene::ReleaseModel(const lvk::Model *model)
+{
+    if (model == nullptr)
+    {
+        return;
+    }
+
+    auto it = model_references_.find(model);
+    if (--it->second.entity_count == 0)
+    {
+        model_references_.erase(it);
+    }
+}
+
+}
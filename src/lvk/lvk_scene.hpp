@@ -0,0 +1,141 @@
+#ifndef _LVK_SCENE_H
+#define _LVK_SCENE_H
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+class Model;
+class JobSystem;
+
+// stable handle to a Scene entity
+struct Entity
+{
+    static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index{INVALID_INDEX};
+    // bumped on destroy so stale handles are detected
+    uint32_t generation{0};
+
+    bool IsValid() const { return index != INVALID_INDEX; }
+    bool operator==(const Entity &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity &other) const { return !(*this == other); }
+};
+
+// Structure of arrays entity store with a parent/child hierarchy. Components live
+// in dense parallel arrays kept in topological order (parents before children), so
+// world transforms propagate in one forward pass. Entities are stable handles into
+// a sparse table. Destroy and SetParent may reorder the dense arrays, so dense
+// indices and spans are only valid until the next Create/Destroy/SetParent/UpdateWorldMatrices.
+class Scene : public boost::noncopyable
+{
+public:
+    using Entity = lvk::Entity;
+
+    static constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+    Scene() = default;
+    Scene(Scene &&other) noexcept = default;
+
+    // model may be null for pure transform nodes, translation/rotation/scale are relative to the parent
+    Entity Create(std::shared_ptr<lvk::Model> model, Entity parent = {});
+    // destroys the entity and all of its descendants
+    void Destroy(Entity entity);
+    // an invalid parent makes the entity a root, throws if it would create a cycle
+    void SetParent(Entity entity, Entity parent);
+    Entity GetParent(Entity entity) const;
+    bool IsAlive(Entity entity) const;
+    // throws for dead entities
+    uint32_t GetDenseIndex(Entity entity) const;
+    size_t Size() const { return entities_.size(); }
+
+    // setters mark the entity dirty, its subtree is recomputed by the next UpdateWorldMatrices
+    void SetTranslation(Entity entity, const glm::vec3 &translation);
+    void SetRotation(Entity entity, const glm::vec3 &rotation);
+    void SetScale(Entity entity, const glm::vec3 &scale);
+
+    // recomputes world matrices of dirty entities and their descendants only,
+    // local matrices of large batches are split across the job system when given
+    void UpdateWorldMatrices(JobSystem *jobs = nullptr);
+    // dense indices whose world matrix changed in the last UpdateWorldMatrices, in ascending order
+    std::span<const uint32_t> GetChangedIndices() const { return changed_indices_; }
+
+    std::span<const glm::vec3> GetTranslations() const { return translations_; }
+    std::span<const glm::vec3> GetRotations() const { return rotations_; }
+    std::span<const glm::vec3> GetScales() const { return scales_; }
+    std::span<const glm::mat4> GetWorldMatrices() const { return world_matrices_; }
+    std::span<const lvk::Model *const> GetModels() const { return models_; }
+    std::span<const Entity> GetEntities() const { return entities_; }
+    // every model referenced by at least one entity, in no particular order
+    std::vector<const lvk::Model *> GetUniqueModels() const;
+    // the same models as owning references, for handing them to another thread
+    std::vector<std::shared_ptr<lvk::Model>> GetModelReferences() const;
+    // NO_PARENT for roots, always smaller than the child's own index after UpdateWorldMatrices
+    std::span<const uint32_t> GetParentIndices() const { return parent_indices_; }
+
+    // per object reference, see lvk_transform.hpp for how far the batch kernel may deviate
+    static glm::mat4 ComposeTransform(const glm::vec3 &translation, const glm::vec3 &rotation, const glm::vec3 &scale);
+
+private:
+    // the scene keeps one reference per model instead of one per entity
+    struct ModelReference
+    {
+        std::shared_ptr<lvk::Model> model;
+        uint32_t entity_count{0};
+    };
+
+    void AcquireModel(std::shared_ptr<lvk::Model> model);
+    void ReleaseModel(const lvk::Model *model);
+    void MarkDirty(Entity entity);
+    void RemoveDense(uint32_t dense_index);
+    // restores parent before child order and the dense parent indices
+    void SortHierarchy();
+    void ComputeLocalMatrices(JobSystem *jobs);
+
+private:
+    // dense, indexed by dense index
+    std::vector<glm::vec3> translations_;
+    std::vector<glm::vec3> rotations_;
+    std::vector<glm::vec3> scales_;
+    std::vector<glm::mat4> local_matrices_;
+    std::vector<glm::mat4> world_matrices_;
+    std::vector<const lvk::Model *> models_;
+    std::vector<Entity> entities_;
+    std::vector<Entity> parents_;
+    std::vector<uint32_t> parent_indices_;
+    // DIRTY_LOCAL / DIRTY_WORLD bits
+    std::vector<uint8_t> dirty_;
+
+    // sparse, indexed by Entity::index
+    std::vector<uint32_t> dense_indices_;
+    std::vector<uint32_t> generations_;
+    std::vector<uint32_t> free_indices_;
+
+    bool hierarchy_dirty_{false};
+    bool transforms_dirty_{false};
+    std::vector<uint32_t> dirty_indices_;
+    std::vector<uint32_t> changed_indices_;
+
+    // scratch for batching dirty local transforms through the simd kernel
+    std::vector<glm::vec3> batch_translations_;
+    std::vector<glm::vec3> batch_rotations_;
+    std::vector<glm::vec3> batch_scales_;
+    std::vector<glm::mat4> batch_matrices_;
+
+    std::unordered_map<const lvk::Model *, ModelReference> model_references_;
+};
+
+}
+#endif
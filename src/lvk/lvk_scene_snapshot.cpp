@@ -0,0 +1,149 @@
+#include "lvk_scene_snapshot.hpp"
+
+// module
+#include "lvk_job_system.hpp"
+
+// std
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+// glm
+#include <glm/ext.hpp>
+
+namespace lvk
+{
+
+// the shorter way around between two angles, so wrapping rotations don't spin back
+static glm::vec3 MixAngles(const glm::vec3 &from, const glm::vec3 &to, float alpha)
+{
+    auto delta = to - from;
+    delta -= glm::two_pi<float>() * glm::round(delta / glm::two_pi<float>());
+    return from + delta * alpha;
+}
+
+void TransformState::Capture(const lvk::Scene &scene, const CameraPose &camera_pose)
+{
+    auto scene_entities = scene.GetEntities();
+    auto scene_parents = scene.GetParentIndices();
+    auto scene_translations = scene.GetTranslations();
+    auto scene_rotations = scene.GetRotations();
+    auto scene_scales = scene.GetScales();
+    entities.assign(scene_entities.begin(), scene_entities.end());
+    parent_indices.assign(scene_parents.begin(), scene_parents.end());
+    translations.assign(scene_translations.begin(), scene_translations.end());
+    rotations.assign(scene_rotations.begin(), scene_rotations.end());
+    scales.assign(scene_scales.begin(), scene_scales.end());
+    camera = camera_pose;
+}
+
+void SceneSnapshot::Capture(const lvk::Scene &scene, const TransformState &previous_state, const CameraPose &camera, uint64_t step_tick, std::chrono::steady_clock::time_point due, std::chrono::duration<double> step_length)
+{
+    tick = step_tick;
+    time = due;
+    step = step_length;
+
+    auto scene_models = scene.GetModels();
+    models.assign(scene_models.begin(), scene_models.end());
+    model_references = scene.GetModelReferences();
+
+    current.Capture(scene, camera);
+    previous = previous_state.LinesUpWith(current) ? previous_state : current;
+}
+
+float SceneSnapshot::InterpolationFactor(std::chrono::steady_clock::time_point now) const
+{
+    if (step.count() <= 0.0)
+    {
+        return 1.f;
+    }
+    // the state shown lags one step behind, it reaches current at time + step
+    std::chrono::duration<double> since = now - time;
+    return static_cast<float>(std::clamp(since.count() / step.count(), 0.0, 1.0));
+}
+
+const lvk::Scene &SceneInterpolator::Apply(const SceneSnapshot &snapshot, float alpha, lvk::JobSystem *jobs)
+{
+    SyncStructure(snapshot);
+
+    const auto &previous = snapshot.previous;
+    const auto &current = snapshot.current;
+    for (size_t i = 0; i < mirror_entities_.size(); i++)
+    {
+        auto translation = glm::mix(previous.translations[i], current.translations[i], alpha);
+        auto rotation = MixAngles(previous.rotations[i], current.rotations[i], alpha);
+        auto scale = glm::mix(previous.scales[i], current.scales[i], alpha);
+
+        // only what actually moved is marked dirty
+        if (translation != applied_translations_[i])
+        {
+            scene_.SetTranslation(mirror_entities_[i], translation);
+            applied_translations_[i] = translation;
+        }
+        if (rotation != applied_rotations_[i])
+        {
+            scene_.SetRotation(mirror_entities_[i], rotation);
+            applied_rotations_[i] = rotation;
+        }
+        if (scale != applied_scales_[i])
+        {
+            scene_.SetScale(mirror_entities_[i], scale);
+            applied_scales_[i] = scale;
+        }
+    }
+
+    camera_ = CameraPose
+    {
+        .position = glm::mix(previous.camera.position, current.camera.position, alpha),
+        .target = glm::mix(previous.camera.target, current.camera.target, alpha),
+        .up = glm::mix(previous.camera.up, current.camera.up, alpha),
+    };
+
+    scene_.UpdateWorldMatrices(jobs);
+    return scene_;
+}
+
+void SceneInterpolator::SyncStructure(const SceneSnapshot &snapshot)
+{
+    const auto &current = snapshot.current;
+    if (current.entities == source_entities_ && current.parent_indices == source_parents_ && snapshot.models == source_models_)
+    {
+        return;
+    }
+
+    // rare, entities were created, destroyed or reparented. Roots take their subtrees with them
+    for (size_t i = 0; i < mirror_entities_.size(); i++)
+    {
+        if (source_parents_[i] == Scene::NO_PARENT)
+        {
+            scene_.Destroy(mirror_entities_[i]);
+        }
+    }
+
+    std::unordered_map<const lvk::Model *, std::shared_ptr<lvk::Model>> references;
+    for (const auto &reference : snapshot.model_references)
+    {
+        references.emplace(reference.get(), reference);
+    }
+
+    // parents come before their children in the snapshot, so they already exist
+    mirror_entities_.resize(current.entities.size());
+    for (size_t i = 0; i < current.entities.size(); i++)
+    {
+        auto model = snapshot.models[i] ? references.at(snapshot.models[i]) : nullptr;
+        auto parent = current.parent_indices[i];
+        mirror_entities_[i] = scene_.Create(std::move(model), parent == Scene::NO_PARENT ? Entity{} : mirror_entities_[parent]);
+    }
+
+    source_entities_ = current.entities;
+    source_parents_ = current.parent_indices;
+    source_models_ = snapshot.models;
+
+    // nan never compares equal, so every entity gets its transform on the next Apply
+    const auto NOT_APPLIED = glm::vec3(std::numeric_limits<float>::quiet_NaN());
+    applied_translations_.assign(current.entities.size(), NOT_APPLIED);
+    applied_rotations_.assign(current.entities.size(), NOT_APPLIED);
+    applied_scales_.assign(current.entities.size(), NOT_APPLIED);
+}
+
+}
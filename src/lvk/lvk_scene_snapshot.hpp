@@ -0,0 +1,97 @@
+#ifndef _LVK_SCENE_SNAPSHOT_H
+#define _LVK_SCENE_SNAPSHOT_H
+
+// module
+#include "lvk_scene.hpp"
+#include "lvk_camera.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+class Model;
+class JobSystem;
+
+// hierarchy and local transforms of every entity in dense order, as of one simulation step
+struct TransformState
+{
+    std::vector<Entity> entities;
+    std::vector<uint32_t> parent_indices;
+    std::vector<glm::vec3> translations;
+    std::vector<glm::vec3> rotations;
+    std::vector<glm::vec3> scales;
+    CameraPose camera;
+
+    // reuses the vectors' allocations, call after Scene::UpdateWorldMatrices so the order is settled
+    void Capture(const lvk::Scene &scene, const CameraPose &camera_pose);
+    // same entities with the same parents at the same dense indices
+    bool LinesUpWith(const TransformState &other) const { return entities == other.entities && parent_indices == other.parent_indices; }
+};
+
+// What the render thread sees of one simulation step, immutable once published. The
+// previous step's transforms are carried along so the renderer can interpolate between
+// two steps without holding on to an older snapshot.
+struct SceneSnapshot
+{
+    uint64_t tick{0};
+    // wall clock time the current state is due at, one step after the previous one
+    std::chrono::steady_clock::time_point time;
+    std::chrono::duration<double> step{0.0};
+
+    std::vector<const lvk::Model *> models;
+    // keeps the models alive while the render thread reads the snapshot
+    std::vector<std::shared_ptr<lvk::Model>> model_references;
+
+    // equals current when entities were created, destroyed or reparented during the step
+    TransformState previous;
+    TransformState current;
+
+    // structure and current state from the scene, previous is taken over when it still lines up
+    void Capture(const lvk::Scene &scene, const TransformState &previous_state, const CameraPose &camera, uint64_t step_tick, std::chrono::steady_clock::time_point due, std::chrono::duration<double> step_length);
+    // how far time lies between previous and current, clamped to [0, 1]
+    float InterpolationFactor(std::chrono::steady_clock::time_point now) const;
+};
+
+// Render thread side mirror of the simulated scene. Apply writes the interpolated
+// transforms into a scene of its own, so only entities that moved are marked dirty
+// and the render system keeps seeing the changed indices it uploads incrementally.
+class SceneInterpolator : public boost::noncopyable
+{
+public:
+    SceneInterpolator() = default;
+
+    const lvk::Scene &Apply(const SceneSnapshot &snapshot, float alpha, lvk::JobSystem *jobs = nullptr);
+
+    const lvk::Scene &GetScene() const { return scene_; }
+    const CameraPose &GetCamera() const { return camera_; }
+
+private:
+    // recreates every entity when the snapshot's structure differs from the mirrored one
+    void SyncStructure(const SceneSnapshot &snapshot);
+
+private:
+    lvk::Scene scene_;
+    CameraPose camera_;
+
+    // per snapshot dense index
+    std::vector<Entity> source_entities_;
+    std::vector<uint32_t> source_parents_;
+    std::vector<const lvk::Model *> source_models_;
+    std::vector<Entity> mirror_entities_;
+    std::vector<glm::vec3> applied_translations_;
+    std::vector<glm::vec3> applied_rotations_;
+    std::vector<glm::vec3> applied_scales_;
+};
+
+}
+#endif
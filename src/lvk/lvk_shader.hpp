@@ -4,9 +4,12 @@
 #include "lvk_definitions.hpp"
 
 // boost
-#include <boost/align.hpp>
 #include <boost/noncopyable.hpp>
 
+// std
+#include <cstdint>
+#include <span>
+
 // vulkan
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -17,10 +20,11 @@ class Hardware;
 class Shader : public boost::noncopyable
 {
 public:
+    // the module is created straight from code, nothing is copied, see ShaderBundle
     Shader(
         const lvk::Hardware &hardware,
         std::string_view shader_entry,
-        std::string_view shader_path,
+        std::span<const uint32_t> code,
         vk::ShaderStageFlagBits shader_stage);
 
     Shader(Shader &&other) noexcept;
@@ -30,8 +34,7 @@ public:
     const std::string &GetShaderName() const { return shader_name_; }
 
 private:
-    std::vector<char, boost::alignment::aligned_allocator<char, 8>> ReadShaderFile(std::string_view file_name) const;
-    vk::raii::ShaderModule ConstructShaderModule(const lvk::Hardware &hardware, std::string_view file_name);
+    vk::raii::ShaderModule ConstructShaderModule(const lvk::Hardware &hardware, std::span<const uint32_t> code);
 
 private:
     std::string shader_name_;
@@ -0,0 +1,168 @@
+#include "lvk_shader_bundle.hpp"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+// "LVKS"
+constexpr uint32_t BUNDLE_MAGIC = 0x534b564c;
+constexpr uint32_t BUNDLE_VERSION = 1;
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+struct BundleHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+};
+
+// offsets are from the start of the file, code is 4 byte aligned
+struct BundleEntry
+{
+    uint32_t name_offset;
+    uint32_t name_size;
+    uint32_t code_offset;
+    uint32_t code_size;
+};
+
+ShaderBundle::ShaderBundle(const std::filesystem::path &override_path)
+{
+    std::copy(detail::EMBEDDED_SHADER_CODE.begin(), detail::EMBEDDED_SHADER_CODE.end(), shaders_.begin());
+    if (override_path.empty())
+    {
+        return;
+    }
+
+    override_file_.emplace(override_path);
+    ApplyOverrides(*override_file_);
+    BOOST_LOG_TRIVIAL(info) << fmt::format("shader bundle: {} replaces {} of {} shaders", override_path.string(), override_count_, shaders_.size());
+}
+
+void ShaderBundle::ApplyOverrides(const lvk::MappedFile &file)
+{
+    auto data = file.GetData();
+    auto fail = [&](std::string_view reason)
+    {
+        return std::runtime_error(fmt::format("shader bundle {}: {}", file.GetPath().string(), reason));
+    };
+
+    BundleHeader header{};
+    if (data.size() < sizeof(header))
+    {
+        throw fail("truncated header");
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != BUNDLE_MAGIC || header.version != BUNDLE_VERSION)
+    {
+        throw fail("not a shader bundle of this version");
+    }
+    if (header.entry_count > (data.size() - sizeof(header)) / sizeof(BundleEntry))
+    {
+        throw fail("truncated entry table");
+    }
+
+    for (uint32_t i = 0; i < header.entry_count; i++)
+    {
+        BundleEntry entry{};
+        std::memcpy(&entry, data.data() + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        if (uint64_t(entry.name_offset) + entry.name_size > data.size() || uint64_t(entry.code_offset) + entry.code_size > data.size())
+        {
+            throw fail(fmt::format("entry {} points past the end of the file", i));
+        }
+        // the mapping is page aligned, so aligned offsets give aligned words
+        if (entry.code_offset % sizeof(uint32_t) != 0 || entry.code_size % sizeof(uint32_t) != 0 || entry.code_size == 0)
+        {
+            throw fail(fmt::format("entry {} is not a whole number of aligned words", i));
+        }
+
+        std::string_view name(reinterpret_cast<const char *>(data.data() + entry.name_offset), entry.name_size);
+        std::span<const uint32_t> code(reinterpret_cast<const uint32_t *>(data.data() + entry.code_offset), entry.code_size / sizeof(uint32_t));
+        if (code[0] != SPIRV_MAGIC)
+        {
+            throw fail(fmt::format("{} is not spir-v", name));
+        }
+
+        // shaders are referenced by embedded id, a mod can only replace existing ones
+        auto it = std::find(detail::EMBEDDED_SHADER_NAMES.begin(), detail::EMBEDDED_SHADER_NAMES.end(), name);
+        if (it == detail::EMBEDDED_SHADER_NAMES.end())
+        {
+            BOOST_LOG_TRIVIAL(warning) << fmt::format("shader bundle: ignoring {}, no shader of that name", name);
+            continue;
+        }
+        shaders_[it - detail::EMBEDDED_SHADER_NAMES.begin()] = code;
+        override_count_++;
+    }
+}
+
+void ShaderBundle::Write(const std::filesystem::path &path, std::span<const Entry> entries)
+{
+    BundleHeader header
+    {
+        .magic = BUNDLE_MAGIC,
+        .version = BUNDLE_VERSION,
+        .entry_count = static_cast<uint32_t>(entries.size()),
+        .reserved = 0
+    };
+
+    // header, entry table, names, then the code
+    std::vector<BundleEntry> table(entries.size());
+    size_t offset = sizeof(header) + table.size() * sizeof(BundleEntry);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        table[i].name_offset = static_cast<uint32_t>(offset);
+        table[i].name_size = static_cast<uint32_t>(entries[i].name.size());
+        offset += entries[i].name.size();
+    }
+    offset = (offset + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+    size_t names_end = offset;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        table[i].code_offset = static_cast<uint32_t>(offset);
+        table[i].code_size = static_cast<uint32_t>(entries[i].code.size_bytes());
+        offset += entries[i].code.size_bytes();
+    }
+    if (offset > UINT32_MAX)
+    {
+        throw std::runtime_error(fmt::format("shader bundle {} would exceed 4 GiB", path.string()));
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error(fmt::format("failed to open {}", path.string()));
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(BundleEntry));
+    size_t written = sizeof(header) + table.size() * sizeof(BundleEntry);
+    for (const auto &entry : entries)
+    {
+        file.write(entry.name.data(), entry.name.size());
+        written += entry.name.size();
+    }
+    std::array<char, sizeof(uint32_t)> padding{};
+    file.write(padding.data(), names_end - written);
+    for (const auto &entry : entries)
+    {
+        file.write(reinterpret_cast<const char *>(entry.code.data()), entry.code.size_bytes());
+    }
+    file.flush();
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("failed to write {}", path.string()));
+    }
+}
+
+}
@@ -0,0 +1,87 @@
+#ifndef _LVK_SHADER_BUNDLE_H
+#define _LVK_SHADER_BUNDLE_H
+
+// module
+#include "lvk_mapped_file.hpp"
+// generated by target_embed_shaders
+#include "lvk_embedded_shaders.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace lvk
+{
+
+// Index of a shader compiled into the library, named by its path below shaders/
+// without the .spv suffix. Names are resolved at compile time, an unknown name
+// doesn't build.
+class EmbeddedShaderId
+{
+public:
+    template<size_t N>
+    consteval EmbeddedShaderId(const char (&name)[N]) :
+        index_(Find(std::string_view(name, N - 1)))
+    {}
+
+    uint32_t GetIndex() const { return index_; }
+    std::string_view GetName() const { return detail::EMBEDDED_SHADER_NAMES[index_]; }
+
+private:
+    static consteval uint32_t Find(std::string_view name)
+    {
+        for (uint32_t i = 0; i < detail::EMBEDDED_SHADER_NAMES.size(); i++)
+        {
+            if (detail::EMBEDDED_SHADER_NAMES[i] == name)
+            {
+                return i;
+            }
+        }
+        throw "not an embedded shader, add it with target_add_shader";
+    }
+
+private:
+    uint32_t index_;
+};
+
+// SPIR-V of every shader, read straight from the library's read only data. An
+// optional bundle file written by ShaderBundle::Write is mapped on top of it and
+// replaces the embedded shaders of the same name, so mods don't need a rebuild.
+// The spans stay valid for the bundle's lifetime.
+class ShaderBundle : public boost::noncopyable
+{
+public:
+    // an empty path uses the embedded shaders only, throws when the bundle file is malformed
+    explicit ShaderBundle(const std::filesystem::path &override_path = {});
+
+    std::span<const uint32_t> Get(EmbeddedShaderId id) const { return shaders_[id.GetIndex()]; }
+    uint32_t GetOverrideCount() const { return override_count_; }
+
+public:
+    struct Entry
+    {
+        std::string name;
+        std::span<const uint32_t> code;
+    };
+
+    static void Write(const std::filesystem::path &path, std::span<const Entry> entries);
+
+private:
+    void ApplyOverrides(const lvk::MappedFile &file);
+
+private:
+    std::array<std::span<const uint32_t>, detail::EMBEDDED_SHADER_NAMES.size()> shaders_;
+    std::optional<lvk::MappedFile> override_file_;
+    uint32_t override_count_{0};
+};
+
+}
+#endif
@@ -0,0 +1,298 @@
+#include "lvk_shader_watcher.hpp"
+
+// module
+#include "lvk_mapped_file.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// boost
+#include <boost/log/trivial.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+// editors tend to write a file in several steps, compile once they went quiet
+constexpr std::chrono::milliseconds SETTLE_TIME{100};
+constexpr std::array<std::string_view, 6> STAGE_EXTENSIONS{".vert", ".frag", ".comp", ".geom", ".tesc", ".tese"};
+constexpr std::array<std::string_view, 3> INCLUDE_EXTENSIONS{".glsl", ".inc", ".h"};
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+static bool IsStage(const std::filesystem::path &path)
+{
+    auto extension = path.extension().string();
+    return std::find(STAGE_EXTENSIONS.begin(), STAGE_EXTENSIONS.end(), extension) != STAGE_EXTENSIONS.end();
+}
+
+// anything else, like editor swap and backup files, is ignored
+static bool IsShaderSource(const std::filesystem::path &path)
+{
+    auto extension = path.extension().string();
+    return IsStage(path) || std::find(INCLUDE_EXTENSIONS.begin(), INCLUDE_EXTENSIONS.end(), extension) != INCLUDE_EXTENSIONS.end();
+}
+
+// everything below directory. Directories deleted while an editor saves are common, they end
+// the listing early instead of throwing
+static std::vector<std::filesystem::directory_entry> ListTree(const std::filesystem::path &directory)
+{
+    std::vector<std::filesystem::directory_entry> entries;
+    std::error_code error;
+    std::filesystem::recursive_directory_iterator it(directory, std::filesystem::directory_options::skip_permission_denied, error);
+    for (; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+    {
+        entries.push_back(*it);
+    }
+    if (error)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("shader watcher: can't list {}: {}", directory.string(), error.message());
+    }
+    return entries;
+}
+
+ShaderWatcher::ShaderWatcher(std::filesystem::path source_dir, std::string glslc) :
+    source_dir_(std::move(source_dir)),
+    glslc_(std::move(glslc))
+{
+    if (!IsSupported())
+    {
+        BOOST_LOG_TRIVIAL(warning) << "shader watcher: needs inotify, shaders won't be reloaded";
+        return;
+    }
+    if (!std::filesystem::is_directory(source_dir_))
+    {
+        throw std::runtime_error(fmt::format("shader watcher: {} is not a directory", source_dir_.string()));
+    }
+
+#if defined(__linux__)
+    output_dir_ = std::filesystem::temp_directory_path() / fmt::format("lvk_shaders_{}", getpid());
+#endif
+    std::filesystem::create_directories(output_dir_);
+    thread_ = std::thread([this]() { WatchLoop(); });
+    BOOST_LOG_TRIVIAL(info) << fmt::format("shader watcher: watching {}", source_dir_.string());
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    stop_ = true;
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    if (!output_dir_.empty())
+    {
+        std::error_code error;
+        std::filesystem::remove_all(output_dir_, error);
+    }
+}
+
+bool ShaderWatcher::IsSupported()
+{
+#if defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<CompiledShader> ShaderWatcher::TakeCompiled()
+{
+    std::lock_guard lock(compiled_mutex_);
+    return std::exchange(compiled_, {});
+}
+
+#if defined(__linux__)
+
+void ShaderWatcher::WatchLoop()
+{
+    int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0)
+    {
+        BOOST_LOG_TRIVIAL(error) << fmt::format("shader watcher: inotify_init1 failed: {}", std::strerror(errno));
+        return;
+    }
+
+    std::unordered_map<int, std::filesystem::path> directories;
+    auto watch = [&](const std::filesystem::path &directory)
+    {
+        int descriptor = inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (descriptor < 0)
+        {
+            BOOST_LOG_TRIVIAL(warning) << fmt::format("shader watcher: can't watch {}: {}", directory.string(), std::strerror(errno));
+            return;
+        }
+        directories[descriptor] = directory;
+    };
+    watch(source_dir_);
+    for (const auto &entry : ListTree(source_dir_))
+    {
+        std::error_code error;
+        if (entry.is_directory(error))
+        {
+            watch(entry.path());
+        }
+    }
+
+    std::set<std::filesystem::path> changed;
+    auto last_event = std::chrono::steady_clock::now();
+    alignas(inotify_event) std::array<char, 4096> buffer;
+    while (!stop_)
+    {
+        // wakes up regularly to see stop_ and to let the changes settle
+        pollfd poll_fd{.fd = inotify_fd, .events = POLLIN, .revents = 0};
+        poll(&poll_fd, 1, static_cast<int>(SETTLE_TIME.count()));
+
+        ssize_t size;
+        while ((size = read(inotify_fd, buffer.data(), buffer.size())) > 0)
+        {
+            for (ssize_t offset = 0; offset < size;)
+            {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+                offset += sizeof(inotify_event) + event->len;
+                auto directory = directories.find(event->wd);
+                if (event->len == 0 || directory == directories.end())
+                {
+                    continue;
+                }
+
+                auto path = directory->second / event->name;
+                if (event->mask & IN_ISDIR)
+                {
+                    watch(path);
+                }
+                else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO) && IsShaderSource(path))
+                {
+                    changed.insert(path);
+                    last_event = std::chrono::steady_clock::now();
+                }
+            }
+        }
+
+        if (!changed.empty() && std::chrono::steady_clock::now() - last_event >= SETTLE_TIME)
+        {
+            // escaping this thread would terminate the engine, the next save tries again
+            try
+            {
+                Compile(changed);
+            }
+            catch (const std::exception &e)
+            {
+                BOOST_LOG_TRIVIAL(error) << fmt::format("shader watcher: recompiling failed: {}", e.what());
+            }
+            changed.clear();
+        }
+    }
+    close(inotify_fd);
+}
+
+#else
+
+void ShaderWatcher::WatchLoop()
+{}
+
+#endif
+
+void ShaderWatcher::Compile(const std::set<std::filesystem::path> &changed)
+{
+    // anything else may be included from anywhere, recompile all of them
+    std::vector<std::filesystem::path> sources;
+    if (std::all_of(changed.begin(), changed.end(), IsStage))
+    {
+        sources.assign(changed.begin(), changed.end());
+    }
+    else
+    {
+        for (const auto &entry : ListTree(source_dir_))
+        {
+            std::error_code error;
+            if (entry.is_regular_file(error) && IsStage(entry.path()))
+            {
+                sources.push_back(entry.path());
+            }
+        }
+    }
+
+    for (const auto &source : sources)
+    {
+        CompiledShader compiled;
+        if (!CompileShader(source, compiled))
+        {
+            continue;
+        }
+
+        std::lock_guard lock(compiled_mutex_);
+        auto it = std::find_if(compiled_.begin(), compiled_.end(), [&](const CompiledShader &other) { return other.name == compiled.name; });
+        if (it != compiled_.end())
+        {
+            *it = std::move(compiled);
+        }
+        else
+        {
+            compiled_.push_back(std::move(compiled));
+        }
+    }
+}
+
+bool ShaderWatcher::CompileShader(const std::filesystem::path &source, CompiledShader &compiled) const
+{
+    auto start = std::chrono::steady_clock::now();
+    compiled.name = source.lexically_relative(source_dir_).generic_string();
+    auto output = output_dir_ / (compiled.name + ".spv");
+    std::error_code error;
+    std::filesystem::create_directories(output.parent_path(), error);
+    if (error)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("shader watcher: can't create {}: {}", output.parent_path().string(), error.message());
+        return false;
+    }
+
+    // glslc reports errors on stderr itself
+    auto command = fmt::format("\"{}\" --target-env=vulkan1.1 -o \"{}\" \"{}\"", glslc_, output.string(), source.string());
+    if (std::system(command.c_str()) != 0)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("shader watcher: {} failed to compile, keeping the last good version", compiled.name);
+        return false;
+    }
+
+    try
+    {
+        lvk::MappedFile file(output);
+        auto data = file.GetData();
+        compiled.code.resize(data.size() / sizeof(uint32_t));
+        std::memcpy(compiled.code.data(), data.data(), compiled.code.size() * sizeof(uint32_t));
+    }
+    catch (const std::exception &e)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("shader watcher: {}", e.what());
+        return false;
+    }
+    // a leftover only costs disk space until the watcher's directory is removed
+    std::filesystem::remove(output, error);
+
+    if (compiled.code.empty() || compiled.code[0] != SPIRV_MAGIC)
+    {
+        BOOST_LOG_TRIVIAL(warning) << fmt::format("shader watcher: glslc wrote no spir-v for {}", compiled.name);
+        return false;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_LOG_TRIVIAL(info) << fmt::format("shader watcher: compiled {} in {:.1f} ms", compiled.name, elapsed.count());
+    return true;
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef _LVK_SHADER_WATCHER_H
+#define _LVK_SHADER_WATCHER_H
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lvk
+{
+
+struct CompiledShader
+{
+    // path below the watched directory, the same name the shader is embedded under
+    std::string name;
+    std::vector<uint32_t> code;
+};
+
+// Watches a glsl source tree with inotify and recompiles changed shaders with glslc on
+// its own thread. A changed include (.glsl, .inc, .h) recompiles every shader, files
+// that are neither a stage nor an include are ignored. Shaders that fail to compile are logged and skipped, the last good
+// version stays in use. Only supported on linux, elsewhere it logs and does nothing.
+class ShaderWatcher : public boost::noncopyable
+{
+public:
+    ShaderWatcher(std::filesystem::path source_dir, std::string glslc);
+    ~ShaderWatcher();
+
+    // shaders compiled since the last call, the newest version of each
+    std::vector<CompiledShader> TakeCompiled();
+
+    static bool IsSupported();
+
+private:
+    void WatchLoop();
+    void Compile(const std::set<std::filesystem::path> &changed);
+    bool CompileShader(const std::filesystem::path &source, CompiledShader &compiled) const;
+
+private:
+    std::filesystem::path source_dir_;
+    std::filesystem::path output_dir_;
+    std::string glslc_;
+
+    std::mutex compiled_mutex_;
+    std::vector<CompiledShader> compiled_;
+
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+}
+#endif
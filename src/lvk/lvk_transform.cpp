@@ -0,0 +1,369 @@
+#include "lvk_transform.hpp"
+
+// std
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LVK_TRANSFORM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// msvc accepts avx2 intrinsics anywhere, gcc and clang need the function to opt in
+#if defined(__GNUC__) || defined(__clang__)
+#define LVK_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define LVK_TARGET_AVX2
+#endif
+
+namespace lvk
+{
+
+// cephes style sin/cos: reduce by pi/4 in three parts, then a minimax polynomial on [-pi/4, pi/4].
+// about 1 ulp for |x| < 8192, every kernel evaluates the same steps so they agree closely
+constexpr float FOUR_OVER_PI = 1.27323954473516f;
+constexpr float DP1 = 0.78515625f;
+constexpr float DP2 = 2.4187564849853515625e-4f;
+constexpr float DP3 = 3.77489497744594108e-8f;
+constexpr float SIN_P0 = -1.9515295891e-4f;
+constexpr float SIN_P1 = 8.3321608736e-3f;
+constexpr float SIN_P2 = -1.6666654611e-1f;
+constexpr float COS_P0 = 2.443315711809948e-5f;
+constexpr float COS_P1 = -1.388731625493765e-3f;
+constexpr float COS_P2 = 4.166664568298827e-2f;
+
+static inline void SinCos(float x, float &sin, float &cos)
+{
+    uint32_t sign_sin = std::bit_cast<uint32_t>(x) & 0x80000000u;
+    x = std::fabs(x);
+
+    auto j = static_cast<uint32_t>(static_cast<int32_t>(x * FOUR_OVER_PI));
+    j = (j + 1) & ~1u;
+    auto y = static_cast<float>(static_cast<int32_t>(j));
+
+    sign_sin ^= (j & 4u) << 29;
+    uint32_t sign_cos = (~(j - 2) & 4u) << 29;
+    bool sin_polynomial = (j & 2u) == 0;
+
+    x = ((x - y * DP1) - y * DP2) - y * DP3;
+    float z = x * x;
+    float cos_value = ((COS_P0 * z + COS_P1) * z + COS_P2) * z * z - 0.5f * z + 1.f;
+    float sin_value = ((SIN_P0 * z + SIN_P1) * z + SIN_P2) * z * x + x;
+
+    sin = std::bit_cast<float>(std::bit_cast<uint32_t>(sin_polynomial ? sin_value : cos_value) ^ sign_sin);
+    cos = std::bit_cast<float>(std::bit_cast<uint32_t>(sin_polynomial ? cos_value : sin_value) ^ sign_cos);
+}
+
+// T * Ry * Rx * Rz * S written out, columns of R are scaled by S
+static inline void ComposeTransform(const glm::vec3 &t, const glm::vec3 &r, const glm::vec3 &s, glm::mat4 &out)
+{
+    float sx, cx, sy, cy, sz, cz;
+    SinCos(r.x, sx, cx);
+    SinCos(r.y, sy, cy);
+    SinCos(r.z, sz, cz);
+
+    out[0] = glm::vec4((cy * cz + sy * sx * sz) * s.x, (cx * sz) * s.x, (cy * sx * sz - sy * cz) * s.x, 0.f);
+    out[1] = glm::vec4((sy * sx * cz - cy * sz) * s.y, (cx * cz) * s.y, (sy * sz + cy * sx * cz) * s.y, 0.f);
+    out[2] = glm::vec4((sy * cx) * s.z, -sx * s.z, (cy * cx) * s.z, 0.f);
+    out[3] = glm::vec4(t, 1.f);
+}
+
+static void ComposeTransformsScalar(const glm::vec3 *translations, const glm::vec3 *rotations, const glm::vec3 *scales, glm::mat4 *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        ComposeTransform(translations[i], rotations[i], scales[i], out[i]);
+    }
+}
+
+#ifdef LVK_TRANSFORM_X86
+
+// four objects per iteration, lanes are objects
+static inline __m128 LoadComponentSse(const glm::vec3 *v, size_t c)
+{
+    return _mm_set_ps(v[3][c], v[2][c], v[1][c], v[0][c]);
+}
+
+static inline void SinCosSse(__m128 x, __m128 &sin, __m128 &cos)
+{
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+    __m128 sign_sin = _mm_and_ps(x, sign_mask);
+    x = _mm_andnot_ps(sign_mask, x);
+
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+
+    sign_sin = _mm_xor_ps(sign_sin, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29)));
+    __m128 sign_cos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+    __m128 sin_polynomial = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+    __m128 z = _mm_mul_ps(x, x);
+
+    __m128 cos_value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_P0), z), _mm_set1_ps(COS_P1));
+    cos_value = _mm_add_ps(_mm_mul_ps(cos_value, z), _mm_set1_ps(COS_P2));
+    cos_value = _mm_mul_ps(_mm_mul_ps(cos_value, z), z);
+    cos_value = _mm_add_ps(_mm_sub_ps(cos_value, _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.f));
+
+    __m128 sin_value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P0), z), _mm_set1_ps(SIN_P1));
+    sin_value = _mm_add_ps(_mm_mul_ps(sin_value, z), _mm_set1_ps(SIN_P2));
+    sin_value = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_value, z), x), x);
+
+    sin = _mm_or_ps(_mm_and_ps(sin_polynomial, sin_value), _mm_andnot_ps(sin_polynomial, cos_value));
+    cos = _mm_or_ps(_mm_and_ps(sin_polynomial, cos_value), _mm_andnot_ps(sin_polynomial, sin_value));
+    sin = _mm_xor_ps(sin, sign_sin);
+    cos = _mm_xor_ps(cos, sign_cos);
+}
+
+// rows hold one matrix element for four objects, transposing makes them one column of each object
+static inline void StoreColumnSse(__m128 r0, __m128 r1, __m128 r2, __m128 r3, glm::mat4 *out, size_t column)
+{
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(&out[0][column][0], r0);
+    _mm_storeu_ps(&out[1][column][0], r1);
+    _mm_storeu_ps(&out[2][column][0], r2);
+    _mm_storeu_ps(&out[3][column][0], r3);
+}
+
+static void ComposeTransformsSse(const glm::vec3 *translations, const glm::vec3 *rotations, const glm::vec3 *scales, glm::mat4 *out, size_t count)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 sx, cx, sy, cy, sz, cz;
+        SinCosSse(LoadComponentSse(rotations + i, 0), sx, cx);
+        SinCosSse(LoadComponentSse(rotations + i, 1), sy, cy);
+        SinCosSse(LoadComponentSse(rotations + i, 2), sz, cz);
+        __m128 scale_x = LoadComponentSse(scales + i, 0);
+        __m128 scale_y = LoadComponentSse(scales + i, 1);
+        __m128 scale_z = LoadComponentSse(scales + i, 2);
+
+        __m128 sy_sx = _mm_mul_ps(sy, sx);
+        __m128 cy_sx = _mm_mul_ps(cy, sx);
+
+        __m128 m00 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(cy, cz), _mm_mul_ps(sy_sx, sz)), scale_x);
+        __m128 m01 = _mm_mul_ps(_mm_mul_ps(cx, sz), scale_x);
+        __m128 m02 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cy_sx, sz), _mm_mul_ps(sy, cz)), scale_x);
+        StoreColumnSse(m00, m01, m02, zero, out + i, 0);
+
+        __m128 m10 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(sy_sx, cz), _mm_mul_ps(cy, sz)), scale_y);
+        __m128 m11 = _mm_mul_ps(_mm_mul_ps(cx, cz), scale_y);
+        __m128 m12 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(sy, sz), _mm_mul_ps(cy_sx, cz)), scale_y);
+        StoreColumnSse(m10, m11, m12, zero, out + i, 1);
+
+        __m128 m20 = _mm_mul_ps(_mm_mul_ps(sy, cx), scale_z);
+        __m128 m21 = _mm_mul_ps(_mm_sub_ps(zero, sx), scale_z);
+        __m128 m22 = _mm_mul_ps(_mm_mul_ps(cy, cx), scale_z);
+        StoreColumnSse(m20, m21, m22, zero, out + i, 2);
+
+        StoreColumnSse(
+            LoadComponentSse(translations + i, 0),
+            LoadComponentSse(translations + i, 1),
+            LoadComponentSse(translations + i, 2),
+            one, out + i, 3);
+    }
+
+    ComposeTransformsScalar(translations + i, rotations + i, scales + i, out + i, count - i);
+}
+
+// eight objects per iteration, the vec3 components are gathered with a stride of 3 floats
+LVK_TARGET_AVX2 static inline __m256 LoadComponentAvx2(const glm::vec3 *v, size_t c)
+{
+    const __m256i stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    return _mm256_i32gather_ps(&v[0][c], stride, 4);
+}
+
+LVK_TARGET_AVX2 static inline void SinCosAvx2(__m256 x, __m256 &sin, __m256 &cos)
+{
+    const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(0x80000000u)));
+    __m256 sign_sin = _mm256_and_ps(x, sign_mask);
+    x = _mm256_andnot_ps(sign_mask, x);
+
+    __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOUR_OVER_PI)));
+    j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+    __m256 y = _mm256_cvtepi32_ps(j);
+
+    sign_sin = _mm256_xor_ps(sign_sin, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29)));
+    __m256 sign_cos = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+    __m256 sin_polynomial = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+
+    x = _mm256_fnmadd_ps(y, _mm256_set1_ps(DP1), x);
+    x = _mm256_fnmadd_ps(y, _mm256_set1_ps(DP2), x);
+    x = _mm256_fnmadd_ps(y, _mm256_set1_ps(DP3), x);
+    __m256 z = _mm256_mul_ps(x, x);
+
+    __m256 cos_value = _mm256_fmadd_ps(_mm256_set1_ps(COS_P0), z, _mm256_set1_ps(COS_P1));
+    cos_value = _mm256_fmadd_ps(cos_value, z, _mm256_set1_ps(COS_P2));
+    cos_value = _mm256_mul_ps(_mm256_mul_ps(cos_value, z), z);
+    cos_value = _mm256_add_ps(_mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, cos_value), _mm256_set1_ps(1.f));
+
+    __m256 sin_value = _mm256_fmadd_ps(_mm256_set1_ps(SIN_P0), z, _mm256_set1_ps(SIN_P1));
+    sin_value = _mm256_fmadd_ps(sin_value, z, _mm256_set1_ps(SIN_P2));
+    sin_value = _mm256_fmadd_ps(_mm256_mul_ps(sin_value, z), x, x);
+
+    sin = _mm256_xor_ps(_mm256_blendv_ps(cos_value, sin_value, sin_polynomial), sign_sin);
+    cos = _mm256_xor_ps(_mm256_blendv_ps(sin_value, cos_value, sin_polynomial), sign_cos);
+}
+
+LVK_TARGET_AVX2 static inline void StoreColumnAvx2(__m256 r0, __m256 r1, __m256 r2, __m256 r3, glm::mat4 *out, size_t column)
+{
+    StoreColumnSse(_mm256_castps256_ps128(r0), _mm256_castps256_ps128(r1), _mm256_castps256_ps128(r2), _mm256_castps256_ps128(r3), out, column);
+    StoreColumnSse(_mm256_extractf128_ps(r0, 1), _mm256_extractf128_ps(r1, 1), _mm256_extractf128_ps(r2, 1), _mm256_extractf128_ps(r3, 1), out + 4, column);
+}
+
+LVK_TARGET_AVX2 static void ComposeTransformsAvx2(const glm::vec3 *translations, const glm::vec3 *rotations, const glm::vec3 *scales, glm::mat4 *out, size_t count)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 sx, cx, sy, cy, sz, cz;
+        SinCosAvx2(LoadComponentAvx2(rotations + i, 0), sx, cx);
+        SinCosAvx2(LoadComponentAvx2(rotations + i, 1), sy, cy);
+        SinCosAvx2(LoadComponentAvx2(rotations + i, 2), sz, cz);
+        __m256 scale_x = LoadComponentAvx2(scales + i, 0);
+        __m256 scale_y = LoadComponentAvx2(scales + i, 1);
+        __m256 scale_z = LoadComponentAvx2(scales + i, 2);
+
+        __m256 sy_sx = _mm256_mul_ps(sy, sx);
+        __m256 cy_sx = _mm256_mul_ps(cy, sx);
+
+        __m256 m00 = _mm256_mul_ps(_mm256_fmadd_ps(cy, cz, _mm256_mul_ps(sy_sx, sz)), scale_x);
+        __m256 m01 = _mm256_mul_ps(_mm256_mul_ps(cx, sz), scale_x);
+        __m256 m02 = _mm256_mul_ps(_mm256_fmsub_ps(cy_sx, sz, _mm256_mul_ps(sy, cz)), scale_x);
+        StoreColumnAvx2(m00, m01, m02, zero, out + i, 0);
+
+        __m256 m10 = _mm256_mul_ps(_mm256_fmsub_ps(sy_sx, cz, _mm256_mul_ps(cy, sz)), scale_y);
+        __m256 m11 = _mm256_mul_ps(_mm256_mul_ps(cx, cz), scale_y);
+        __m256 m12 = _mm256_mul_ps(_mm256_fmadd_ps(sy, sz, _mm256_mul_ps(cy_sx, cz)), scale_y);
+        StoreColumnAvx2(m10, m11, m12, zero, out + i, 1);
+
+        __m256 m20 = _mm256_mul_ps(_mm256_mul_ps(sy, cx), scale_z);
+        __m256 m21 = _mm256_mul_ps(_mm256_sub_ps(zero, sx), scale_z);
+        __m256 m22 = _mm256_mul_ps(_mm256_mul_ps(cy, cx), scale_z);
+        StoreColumnAvx2(m20, m21, m22, zero, out + i, 2);
+
+        StoreColumnAvx2(
+            LoadComponentAvx2(translations + i, 0),
+            LoadComponentAvx2(translations + i, 1),
+            LoadComponentAvx2(translations + i, 2),
+            one, out + i, 3);
+    }
+
+    ComposeTransformsScalar(translations + i, rotations + i, scales + i, out + i, count - i);
+}
+
+static bool CpuSupportsAvx2Fma()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    return fma && os_saves_ymm && avx2;
+#endif
+}
+
+#endif
+
+static TransformKernel DetectTransformKernel()
+{
+#ifdef LVK_TRANSFORM_X86
+    // sse2 is part of x86-64
+    return CpuSupportsAvx2Fma() ? TransformKernel::AVX2 : TransformKernel::SSE;
+#else
+    return TransformKernel::SCALAR;
+#endif
+}
+
+TransformKernel GetTransformKernel()
+{
+    static const TransformKernel kernel = DetectTransformKernel();
+    return kernel;
+}
+
+bool IsTransformKernelSupported(TransformKernel kernel)
+{
+    switch (kernel)
+    {
+        case TransformKernel::SCALAR:
+            return true;
+        case TransformKernel::SSE:
+            return GetTransformKernel() != TransformKernel::SCALAR;
+        case TransformKernel::AVX2:
+            return GetTransformKernel() == TransformKernel::AVX2;
+    }
+    return false;
+}
+
+std::string_view TransformKernelName(TransformKernel kernel)
+{
+    switch (kernel)
+    {
+        case TransformKernel::SCALAR:
+            return "scalar";
+        case TransformKernel::SSE:
+            return "sse";
+        case TransformKernel::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+void ComposeTransforms(
+    const glm::vec3 *translations,
+    const glm::vec3 *rotations,
+    const glm::vec3 *scales,
+    glm::mat4 *out,
+    size_t count)
+{
+    ComposeTransforms(translations, rotations, scales, out, count, GetTransformKernel());
+}
+
+void ComposeTransforms(
+    const glm::vec3 *translations,
+    const glm::vec3 *rotations,
+    const glm::vec3 *scales,
+    glm::mat4 *out,
+    size_t count,
+    TransformKernel kernel)
+{
+    if (!IsTransformKernelSupported(kernel))
+    {
+        kernel = TransformKernel::SCALAR;
+    }
+
+    switch (kernel)
+    {
+#ifdef LVK_TRANSFORM_X86
+        case TransformKernel::AVX2:
+            ComposeTransformsAvx2(translations, rotations, scales, out, count);
+            return;
+        case TransformKernel::SSE:
+            ComposeTransformsSse(translations, rotations, scales, out, count);
+            return;
+#endif
+        default:
+            ComposeTransformsScalar(translations, rotations, scales, out, count);
+            return;
+    }
+}
+
+}
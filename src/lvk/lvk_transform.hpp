@@ -0,0 +1,44 @@
+#ifndef _LVK_TRANSFORM_H
+#define _LVK_TRANSFORM_H
+
+// std
+#include <cstddef>
+#include <string_view>
+
+// glm
+#include <glm/glm.hpp>
+
+namespace lvk
+{
+
+enum class TransformKernel { SCALAR, SSE, AVX2 };
+
+// Batch version of Scene::ComposeTransform: out[i] = T * Ry * Rx * Rz * S built
+// directly from the closed form, no matrix multiplies. Every kernel uses the same
+// polynomial sin/cos, results agree with the glm::translate/rotate/scale chain to
+// within TRANSFORM_TOLERANCE * max(1, |translation|, |scale|) per element.
+constexpr float TRANSFORM_TOLERANCE = 1e-5f;
+
+void ComposeTransforms(
+    const glm::vec3 *translations,
+    const glm::vec3 *rotations,
+    const glm::vec3 *scales,
+    glm::mat4 *out,
+    size_t count);
+
+// forces a kernel, falls back to SCALAR when the cpu can't run it
+void ComposeTransforms(
+    const glm::vec3 *translations,
+    const glm::vec3 *rotations,
+    const glm::vec3 *scales,
+    glm::mat4 *out,
+    size_t count,
+    TransformKernel kernel);
+
+// the best kernel for this cpu, detected once
+TransformKernel GetTransformKernel();
+bool IsTransformKernelSupported(TransformKernel kernel);
+std::string_view TransformKernelName(TransformKernel kernel);
+
+}
+#endif
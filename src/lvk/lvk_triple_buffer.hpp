@@ -0,0 +1,61 @@
+#ifndef _LVK_TRIPLE_BUFFER_H
+#define _LVK_TRIPLE_BUFFER_H
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace lvk
+{
+
+// Lock free single producer, single consumer handoff of the latest value. The producer
+// fills the back slot and publishes it, the consumer switches to the newest published
+// slot whenever it likes. Neither side ever waits for the other, values the consumer
+// didn't pick up in time are overwritten. Slots are reused, so the producer should
+// reuse their allocations instead of building values from scratch.
+template <typename T>
+class TripleBuffer : public boost::noncopyable
+{
+public:
+    TripleBuffer() = default;
+
+    // producer side, nobody else touches the back slot
+    T &Back() { return slots_[back_]; }
+    // hands the back slot over to the consumer and continues in the slot it gave up
+    void Publish()
+    {
+        auto previous = middle_.exchange(static_cast<uint8_t>(back_ | FRESH), std::memory_order_acq_rel);
+        back_ = previous & INDEX_MASK;
+    }
+
+    // consumer side, switches to the newest published slot, false when nothing was published since the last call
+    bool Acquire()
+    {
+        if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0)
+        {
+            return false;
+        }
+        auto previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX_MASK;
+        return true;
+    }
+    // stays valid and unchanged until the next Acquire
+    const T &Front() const { return slots_[front_]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    // set in middle_ while it holds a slot the consumer hasn't seen yet
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> slots_{};
+    uint8_t back_{0};
+    std::atomic<uint8_t> middle_{1};
+    uint8_t front_{2};
+};
+
+}
+#endif
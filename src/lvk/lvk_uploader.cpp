@@ -0,0 +1,274 @@
+#include "lvk_uploader.hpp"
+
+// module
+#include "lvk_hardware.hpp"
+#include "lvk_allocator.hpp"
+
+// std
+#include <cstring>
+#include <limits>
+
+// fmt
+#include <fmt/format.h>
+
+namespace lvk
+{
+
+// staging memory is handed out in chunks, larger uploads get a buffer of their own
+constexpr vk::DeviceSize STAGING_CHUNK_SIZE = 16 * 1024 * 1024;
+// a batch is submitted automatically once this much data is staged
+constexpr vk::DeviceSize MAX_BATCH_SIZE = 64 * 1024 * 1024;
+constexpr vk::DeviceSize STAGING_ALIGNMENT = 16;
+
+Uploader::Uploader(const lvk::Hardware &hardware, const lvk::Allocator &allocator) :
+    hardware_(&hardware),
+    allocator_(&allocator),
+    transfer_family_(hardware.GetQueueIndex(Hardware::QueueType::TRANSFER).value()),
+    graphics_family_(hardware.GetQueueIndex(Hardware::QueueType::GRAPHICS).value()),
+    command_pool_(ConstructCommandPool(hardware))
+{
+    recording_.ticket = 1;
+}
+
+Uploader::~Uploader()
+{
+    WaitIdle();
+}
+
+vk::raii::CommandPool Uploader::ConstructCommandPool(const lvk::Hardware &hardware)
+{
+    vk::CommandPoolCreateInfo command_pool_create_info
+    {
+        .flags = vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex = transfer_family_,
+    };
+    return vk::raii::CommandPool(hardware.GetDevice(), command_pool_create_info);
+}
+
+Uploader::Ticket Uploader::Enqueue(
+    const void *data,
+    vk::DeviceSize size,
+    const lvk::Buffer &dst_buffer,
+    vk::DeviceSize dst_offset,
+    vk::AccessFlags dst_access,
+    vk::PipelineStageFlags dst_stage)
+{
+    return EnqueueWrite(size, dst_buffer, dst_offset, dst_access, dst_stage, [data](std::span<std::byte> staging)
+    {
+        std::memcpy(staging.data(), data, staging.size());
+    });
+}
+
+Uploader::Ticket Uploader::EnqueueWrite(
+    vk::DeviceSize size,
+    const lvk::Buffer &dst_buffer,
+    vk::DeviceSize dst_offset,
+    vk::AccessFlags dst_access,
+    vk::PipelineStageFlags dst_stage,
+    const Writer &write)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (recording_.staging_total >= MAX_BATCH_SIZE)
+    {
+        SubmitRecording();
+    }
+
+    auto staging_offset = ReserveStaging(size);
+    auto &staging_buffer = recording_.staging_buffers.back();
+    write(std::span<std::byte>(static_cast<std::byte *>(staging_buffer.GetMappedData()) + staging_offset, size));
+
+    recording_.copies.push_back(Copy
+    {
+        .staging_index = recording_.staging_buffers.size() - 1,
+        .staging_offset = staging_offset,
+        .dst_buffer = dst_buffer,
+        .dst_offset = dst_offset,
+        .size = size,
+        .dst_access = dst_access,
+        .dst_stage = dst_stage
+    });
+    return recording_.ticket;
+}
+
+vk::DeviceSize Uploader::ReserveStaging(vk::DeviceSize size)
+{
+    auto offset = (recording_.staging_offset + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+    if (recording_.staging_buffers.empty() || offset + size > recording_.staging_capacity)
+    {
+        auto capacity = std::max(size, STAGING_CHUNK_SIZE);
+        recording_.staging_buffers.emplace_back(
+            *allocator_,
+            vk::BufferCreateInfo{.size = capacity, .usage = vk::BufferUsageFlagBits::eTransferSrc, .sharingMode = vk::SharingMode::eExclusive},
+            VmaAllocationCreateInfo{.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, .usage = VMA_MEMORY_USAGE_AUTO});
+        recording_.staging_capacity = capacity;
+        offset = 0;
+    }
+
+    recording_.staging_offset = offset + size;
+    recording_.staging_total += size;
+    return offset;
+}
+
+Uploader::Ticket Uploader::Flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return SubmitRecording();
+}
+
+Uploader::Ticket Uploader::SubmitRecording()
+{
+    auto ticket = recording_.ticket;
+    if (recording_.copies.empty())
+    {
+        return ticket - 1;
+    }
+
+    for (const auto &staging_buffer : recording_.staging_buffers)
+    {
+        staging_buffer.FlushMemory(0, VK_WHOLE_SIZE);
+    }
+
+    auto command_buffers = hardware_->GetDevice().allocateCommandBuffers(vk::CommandBufferAllocateInfo
+    {
+        .commandPool = *command_pool_,
+        .level = vk::CommandBufferLevel::ePrimary,
+        .commandBufferCount = 1,
+    });
+    recording_.command_buffer = std::move(command_buffers[0]);
+
+    auto &command_buffer = recording_.command_buffer;
+    command_buffer.begin(vk::CommandBufferBeginInfo{.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+    // consecutive copies between the same pair of buffers share one copy command
+    std::vector<vk::BufferCopy> regions;
+    for (size_t i = 0; i < recording_.copies.size(); i++)
+    {
+        const auto &copy = recording_.copies[i];
+        regions.push_back(vk::BufferCopy{.srcOffset = copy.staging_offset, .dstOffset = copy.dst_offset, .size = copy.size});
+
+        bool last = i + 1 == recording_.copies.size();
+        if (last || recording_.copies[i + 1].staging_index != copy.staging_index || recording_.copies[i + 1].dst_buffer != copy.dst_buffer)
+        {
+            command_buffer.copyBuffer(recording_.staging_buffers[copy.staging_index], copy.dst_buffer, regions);
+            regions.clear();
+        }
+    }
+
+    // hand the buffers over to the graphics family, Acquire records the other half
+    if (transfer_family_ != graphics_family_)
+    {
+        auto barriers = MakeBarriers(recording_, true);
+        command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, barriers, nullptr);
+    }
+    command_buffer.end();
+
+    recording_.fence = vk::raii::Fence(hardware_->GetDevice(), vk::FenceCreateInfo{});
+
+    vk::ArrayProxy<const vk::CommandBuffer> submit_command_buffers(*command_buffer);
+    vk::SubmitInfo submit_info
+    {
+        .commandBufferCount = submit_command_buffers.size(),
+        .pCommandBuffers = submit_command_buffers.data(),
+    };
+    vk::ArrayProxy<const vk::SubmitInfo> submit_infos(submit_info);
+    {
+        auto queue_lock = hardware_->LockQueue(Hardware::QueueType::TRANSFER);
+        hardware_->GetQueue(Hardware::QueueType::TRANSFER)->submit(submit_infos, *recording_.fence);
+    }
+
+    in_flight_.push_back(std::move(recording_));
+    recording_ = Batch{};
+    recording_.ticket = ticket + 1;
+    return ticket;
+}
+
+std::vector<vk::BufferMemoryBarrier> Uploader::MakeBarriers(const Batch &batch, bool release) const
+{
+    bool ownership_transfer = transfer_family_ != graphics_family_;
+
+    std::vector<vk::BufferMemoryBarrier> barriers;
+    barriers.reserve(batch.copies.size());
+    for (const auto &copy : batch.copies)
+    {
+        vk::BufferMemoryBarrier barrier
+        {
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = copy.dst_access,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = copy.dst_buffer,
+            .offset = copy.dst_offset,
+            .size = copy.size
+        };
+
+        if (ownership_transfer)
+        {
+            // access masks of the other queue's half are ignored
+            barrier.srcAccessMask = release ? vk::AccessFlags(vk::AccessFlagBits::eTransferWrite) : vk::AccessFlags{};
+            barrier.dstAccessMask = release ? vk::AccessFlags{} : copy.dst_access;
+            barrier.srcQueueFamilyIndex = transfer_family_;
+            barrier.dstQueueFamilyIndex = graphics_family_;
+        }
+        barriers.push_back(barrier);
+    }
+    return barriers;
+}
+
+void Uploader::Acquire(const vk::raii::CommandBuffer &command_buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<vk::BufferMemoryBarrier> barriers;
+    vk::PipelineStageFlags dst_stages;
+    Ticket resident_ticket = resident_ticket_;
+    while (!in_flight_.empty())
+    {
+        auto &batch = in_flight_.front();
+        vk::ArrayProxy<const vk::Fence> fences(*batch.fence);
+        if (hardware_->GetDevice().waitForFences(fences, VK_TRUE, 0) != vk::Result::eSuccess)
+        {
+            break;
+        }
+
+        auto batch_barriers = MakeBarriers(batch, false);
+        barriers.insert(barriers.end(), batch_barriers.begin(), batch_barriers.end());
+        for (const auto &copy : batch.copies)
+        {
+            dst_stages |= copy.dst_stage;
+        }
+
+        // the copies are done, staging memory and the command buffer can go
+        resident_ticket = batch.ticket;
+        in_flight_.pop_front();
+    }
+
+    if (barriers.empty())
+    {
+        return;
+    }
+
+    auto src_stage = transfer_family_ != graphics_family_ ? vk::PipelineStageFlagBits::eTopOfPipe : vk::PipelineStageFlagBits::eTransfer;
+    command_buffer.pipelineBarrier(src_stage, dst_stages, {}, nullptr, barriers, nullptr);
+    resident_ticket_ = resident_ticket;
+}
+
+void Uploader::WaitIdle()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &batch : in_flight_)
+    {
+        vk::ArrayProxy<const vk::Fence> fences(*batch.fence);
+        auto result = hardware_->GetDevice().waitForFences(fences, VK_TRUE, std::numeric_limits<uint64_t>::max());
+        if (result != vk::Result::eSuccess)
+        {
+            throw std::runtime_error(fmt::format("waitForFences error result: {}", (int)result));
+        }
+    }
+}
+
+}
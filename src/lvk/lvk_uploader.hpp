@@ -0,0 +1,109 @@
+#ifndef _LVK_UPLOADER_H
+#define _LVK_UPLOADER_H
+
+// module
+#include "lvk_buffer.hpp"
+
+// boost
+#include <boost/noncopyable.hpp>
+
+// std
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace lvk
+{
+class Hardware;
+class Allocator;
+
+// Streams buffer data to the gpu on the transfer queue.
+// Copies are staged and batched until Flush, one submission and one fence per batch.
+// When the transfer family differs from the graphics family the batch releases the
+// buffers and Acquire records the matching acquire barriers on the graphics side.
+class Uploader : public boost::noncopyable
+{
+public:
+    // monotonically increasing batch id, 0 is always resident
+    using Ticket = uint64_t;
+    // fills all of the staging memory it is given
+    using Writer = std::function<void(std::span<std::byte> staging)>;
+
+    Uploader(const lvk::Hardware &hardware, const lvk::Allocator &allocator);
+    ~Uploader();
+
+    // loader side, may run on any thread
+    Ticket Enqueue(
+        const void *data,
+        vk::DeviceSize size,
+        const lvk::Buffer &dst_buffer,
+        vk::DeviceSize dst_offset,
+        vk::AccessFlags dst_access,
+        vk::PipelineStageFlags dst_stage);
+    // the same, but write produces the data right in staging memory, saving a copy when
+    // it has to be converted anyway. Runs under the uploader's lock, keep it to the writing
+    Ticket EnqueueWrite(
+        vk::DeviceSize size,
+        const lvk::Buffer &dst_buffer,
+        vk::DeviceSize dst_offset,
+        vk::AccessFlags dst_access,
+        vk::PipelineStageFlags dst_stage,
+        const Writer &write);
+    Ticket Flush();
+    void WaitIdle();
+
+    // render side, record before the render pass begins
+    void Acquire(const vk::raii::CommandBuffer &command_buffer);
+    bool IsResident(Ticket ticket) const { return ticket <= resident_ticket_; }
+
+private:
+    struct Copy
+    {
+        size_t staging_index;
+        vk::DeviceSize staging_offset;
+        vk::Buffer dst_buffer;
+        vk::DeviceSize dst_offset;
+        vk::DeviceSize size;
+        vk::AccessFlags dst_access;
+        vk::PipelineStageFlags dst_stage;
+    };
+
+    struct Batch
+    {
+        Ticket ticket{0};
+        std::vector<lvk::Buffer> staging_buffers;
+        // write position and size of the last staging buffer
+        vk::DeviceSize staging_offset{0};
+        vk::DeviceSize staging_capacity{0};
+        vk::DeviceSize staging_total{0};
+        std::vector<Copy> copies;
+        vk::raii::CommandBuffer command_buffer{nullptr};
+        vk::raii::Fence fence{nullptr};
+    };
+
+    vk::raii::CommandPool ConstructCommandPool(const lvk::Hardware &hardware);
+    vk::DeviceSize ReserveStaging(vk::DeviceSize size);
+    Ticket SubmitRecording();
+    std::vector<vk::BufferMemoryBarrier> MakeBarriers(const Batch &batch, bool release) const;
+
+private:
+    const lvk::Hardware *hardware_;
+    const lvk::Allocator *allocator_;
+    uint32_t transfer_family_;
+    uint32_t graphics_family_;
+
+    std::mutex mutex_;
+    vk::raii::CommandPool command_pool_;
+    Batch recording_;
+    std::deque<Batch> in_flight_;
+    std::atomic<Ticket> resident_ticket_{0};
+};
+}
+#endif
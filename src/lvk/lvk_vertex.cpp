@@ -1,39 +1,79 @@
 #include "lvk_vertex.hpp"
+
+// std
+#include <cstring>
+#include <stdexcept>
+
+// fmt
+#include <fmt/format.h>
+
+// glm
+#include <glm/gtc/packing.hpp>
+
 namespace lvk
 {
-const std::vector<vk::VertexInputBindingDescription> &Vertex::GetVertexBindingDescriptions()
+
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must stay tightly packed");
+
+VertexInput GetVertexInput(VertexFormat format)
 {
-    static std::vector<vk::VertexInputBindingDescription> vertex_binding_descriptions
+    switch (format)
     {
-        vk::VertexInputBindingDescription
-        {
-            .binding = 0,
-            .stride = sizeof(Vertex),
-            .inputRate = vk::VertexInputRate::eVertex
-        },
-    };
-    return vertex_binding_descriptions;
+    case VertexFormat::FULL:
+        return MakeVertexInput<FullVertexLayout>();
+    case VertexFormat::PACKED:
+        return MakeVertexInput<PackedVertexLayout>();
+    }
+    throw std::invalid_argument(fmt::format("unknown vertex format {}", static_cast<int>(format)));
 }
 
-const std::vector<vk::VertexInputAttributeDescription> &Vertex::GetVertexInputAttributeDescriptions()
+void PackVertices(std::span<const Vertex> vertices, VertexFormat format, std::span<std::byte> destination)
 {
-    static std::vector<vk::VertexInputAttributeDescription> vertex_input_attribute_descriptions
+    switch (format)
     {
-        vk::VertexInputAttributeDescription
-        {
-            .location = 0,
-            .binding = 0,
-            .format = vk::Format::eR32G32B32Sfloat,
-            .offset = offsetof(Vertex, posision),
-        },
-        vk::VertexInputAttributeDescription
+    case VertexFormat::FULL:
+        std::memcpy(destination.data(), vertices.data(), vertices.size_bytes());
+        return;
+    case VertexFormat::PACKED:
         {
-            .location = 1,
-            .binding = 0,
-            .format = vk::Format::eR32G32B32Sfloat,
-            .offset = offsetof(Vertex, color)
+            auto *packed = reinterpret_cast<PackedVertex *>(destination.data());
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                packed[i].position = glm::packHalf(glm::vec4(vertices[i].posision, 1.f));
+                packed[i].color = glm::packUnorm<uint8_t>(glm::vec4(vertices[i].color, 1.f));
+            }
         }
-    };
-    return vertex_input_attribute_descriptions;
+        return;
+    }
+    throw std::invalid_argument(fmt::format("unknown vertex format {}", static_cast<int>(format)));
+}
+
+uint32_t GetIndexSize(vk::IndexType index_type)
+{
+    switch (index_type)
+    {
+    case vk::IndexType::eUint16:
+        return sizeof(uint16_t);
+    case vk::IndexType::eUint32:
+        return sizeof(uint32_t);
+    default:
+        throw std::invalid_argument(fmt::format("unsupported index type {}", static_cast<int>(index_type)));
+    }
+}
+
+void PackIndices(std::span<const uint32_t> indices, vk::IndexType index_type, std::span<std::byte> destination)
+{
+    if (index_type == vk::IndexType::eUint32)
+    {
+        std::memcpy(destination.data(), indices.data(), indices.size_bytes());
+        return;
+    }
+
+    auto *packed = reinterpret_cast<uint16_t *>(destination.data());
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        packed[i] = static_cast<uint16_t>(indices[i]);
+    }
+}
+
 }
-}
\ No newline at end of file
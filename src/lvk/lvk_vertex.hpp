@@ -3,26 +3,58 @@
 
 // module
 #include "lvk_definitions.hpp"
+#include "lvk_vertex_layout.hpp"
 
 // GLM
 #include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
 
 // vulkan
 #include <vulkan/vulkan.hpp>
 
 // std
-#include <vector>
+#include <cstddef>
+#include <span>
 
 namespace lvk
 {
 
+// what loaders produce and mesh files store, uploads convert it into the arena's format
 struct Vertex
 {
     glm::vec3 posision;
     glm::vec3 color;
-    static const std::vector<vk::VertexInputBindingDescription> &GetVertexBindingDescriptions();
-    static const std::vector<vk::VertexInputAttributeDescription> &GetVertexInputAttributeDescriptions();
 };
 
+using FullVertexLayout = VertexLayout<Vertex,
+    VertexAttribute{0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, posision)},
+    VertexAttribute{1, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, color)}>;
+
+// 12 instead of 24 bytes. Half floats keep about 3 decimal digits relative to the largest
+// coordinate, fine for models around their origin. w is padding, 3 component 16 bit formats
+// are optional for vertex buffers
+struct PackedVertex
+{
+    glm::u16vec4 position;
+    glm::u8vec4 color;
+};
+
+using PackedVertexLayout = VertexLayout<PackedVertex,
+    VertexAttribute{0, vk::Format::eR16G16B16A16Sfloat, offsetof(PackedVertex, position)},
+    VertexAttribute{1, vk::Format::eR8G8B8A8Unorm, offsetof(PackedVertex, color)}>;
+
+// FULL is Vertex as it is, PACKED is PackedVertex. The shaders read both the same way
+enum class VertexFormat : uint8_t { FULL, PACKED };
+
+VertexInput GetVertexInput(VertexFormat format);
+
+// writes vertices in format into destination, which holds vertices.size() * stride bytes
+void PackVertices(std::span<const Vertex> vertices, VertexFormat format, std::span<std::byte> destination);
+
+// 2 or 4
+uint32_t GetIndexSize(vk::IndexType index_type);
+// writes indices as index_type into destination, 16 bit indices must be below 65536
+void PackIndices(std::span<const uint32_t> indices, vk::IndexType index_type, std::span<std::byte> destination);
+
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,115 @@
+#ifndef _LVK_VERTEX_LAYOUT_H
+#define _LVK_VERTEX_LAYOUT_H
+
+// std
+#include <array>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+// vulkan
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_format_traits.hpp>
+
+namespace lvk
+{
+
+struct VertexAttribute
+{
+    uint32_t location;
+    vk::Format format;
+    // offsetof the member in the vertex
+    uint32_t offset;
+};
+
+// Vertex input state of a vertex struct, generated at compile time from its attributes:
+//   using MyVertexLayout = VertexLayout<MyVertex, VertexAttribute{0, vk::Format::eR32G32B32Sfloat, offsetof(MyVertex, position)}, ...>;
+// Every attribute must lie within the vertex and use its own location, vertices are read
+// from binding 0 with the vertex as stride.
+template <typename V, VertexAttribute... ATTRIBUTES>
+struct VertexLayout
+{
+    static_assert(std::is_trivially_copyable_v<V>, "vertices are copied into buffers byte by byte");
+    static_assert(((ATTRIBUTES.offset + vk::blockSize(ATTRIBUTES.format) <= sizeof(V)) && ...), "vertex attribute reaches past the vertex");
+
+    static constexpr bool HasDistinctLocations()
+    {
+        std::array<uint32_t, sizeof...(ATTRIBUTES)> locations{ATTRIBUTES.location...};
+        for (size_t i = 0; i < locations.size(); i++)
+        {
+            for (size_t j = i + 1; j < locations.size(); j++)
+            {
+                if (locations[i] == locations[j])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    static_assert(HasDistinctLocations(), "vertex attributes share a location");
+
+    using Vertex = V;
+    static constexpr uint32_t STRIDE = sizeof(V);
+
+    static constexpr std::array<vk::VertexInputBindingDescription, 1> BINDINGS
+    {
+        vk::VertexInputBindingDescription
+        {
+            .binding = 0,
+            .stride = STRIDE,
+            .inputRate = vk::VertexInputRate::eVertex
+        }
+    };
+
+    static constexpr std::array<vk::VertexInputAttributeDescription, sizeof...(ATTRIBUTES)> ATTRIBUTE_DESCRIPTIONS
+    {
+        vk::VertexInputAttributeDescription
+        {
+            .location = ATTRIBUTES.location,
+            .binding = 0,
+            .format = ATTRIBUTES.format,
+            .offset = ATTRIBUTES.offset
+        }...
+    };
+
+    // fnv-1a over the stride and the attributes, tells data written for another layout apart
+    static constexpr uint64_t HASH = []()
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        auto add = [&](uint32_t value)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                hash = (hash ^ ((value >> (i * 8)) & 0xff)) * 0x100000001b3ull;
+            }
+        };
+        add(STRIDE);
+        ((add(ATTRIBUTES.location), add(static_cast<uint32_t>(ATTRIBUTES.format)), add(ATTRIBUTES.offset)), ...);
+        return hash;
+    }();
+};
+
+// A layout's input state without its type, for code choosing the layout at runtime
+struct VertexInput
+{
+    std::span<const vk::VertexInputBindingDescription> bindings;
+    std::span<const vk::VertexInputAttributeDescription> attributes;
+    uint32_t stride;
+    uint64_t hash;
+};
+
+template <typename Layout>
+constexpr VertexInput MakeVertexInput()
+{
+    return VertexInput
+    {
+        .bindings = Layout::BINDINGS,
+        .attributes = Layout::ATTRIBUTE_DESCRIPTIONS,
+        .stride = Layout::STRIDE,
+        .hash = Layout::HASH
+    };
+}
+
+}
+#endif
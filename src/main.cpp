@@ -4,8 +4,12 @@
 #include <boost/log/trivial.hpp>
 
 // std
+#include <algorithm>
 #include <exception>
+#include <stdexcept>
 #include <iostream>
+#include <string_view>
+#include <string>
 
 // module
 #include "lvk/lvk_engine.hpp"
@@ -15,12 +19,99 @@ void init_log()
     boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::debug);
 }
 
-int main(int, char* argv[])
+lvk::EngineOptions parse_options(int argc, char* argv[])
+{
+    lvk::EngineOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+        bool has_value = i + 1 < argc;
+        if (arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if (arg == "--frames" && has_value)
+        {
+            options.max_frames = std::stoull(argv[++i]);
+        }
+        else if (arg == "--width" && has_value)
+        {
+            options.width = std::stoul(argv[++i]);
+        }
+        else if (arg == "--height" && has_value)
+        {
+            options.height = std::stoul(argv[++i]);
+        }
+        else if (arg == "--device" && has_value)
+        {
+            options.device = argv[++i];
+        }
+        else if (arg == "--cpu-culling")
+        {
+            options.gpu_culling = false;
+        }
+        else if (arg == "--record-threads" && has_value)
+        {
+            options.record_threads = std::stoul(argv[++i]);
+        }
+        else if (arg == "--worker-threads" && has_value)
+        {
+            options.worker_threads = std::stoul(argv[++i]);
+        }
+        else if (arg == "--tick-rate" && has_value)
+        {
+            options.tick_rate = std::max(1ul, std::stoul(argv[++i]));
+        }
+        else if (arg == "--pipeline-cache" && has_value)
+        {
+            options.pipeline_cache = argv[++i];
+        }
+        else if (arg == "--shader-bundle" && has_value)
+        {
+            options.shader_bundle = argv[++i];
+        }
+        else if (arg == "--watch-shaders" && has_value)
+        {
+            options.watch_shaders = argv[++i];
+        }
+        else if (arg == "--model" && has_value)
+        {
+            options.model = argv[++i];
+        }
+        else if (arg == "--mesh-cache" && has_value)
+        {
+            options.mesh_cache = argv[++i];
+        }
+        else if (arg == "--mesh-lod" && has_value)
+        {
+            options.mesh_lod = std::stoul(argv[++i]);
+        }
+        else if (arg == "--packed-vertices")
+        {
+            options.packed_vertices = true;
+        }
+        else if (arg == "--short-indices")
+        {
+            options.short_indices = true;
+        }
+        else if (arg == "--pin-threads")
+        {
+            options.pin_threads = true;
+        }
+        else
+        {
+            throw std::invalid_argument("usage: engine [--headless] [--frames N] [--width W] [--height H] [--device NAME|UUID] [--cpu-culling] [--record-threads N] [--worker-threads N] [--tick-rate N] [--pipeline-cache PATH] [--shader-bundle PATH] [--watch-shaders DIR] [--model PATH] [--mesh-cache DIR] [--mesh-lod N] [--packed-vertices] [--short-indices] [--pin-threads]");
+        }
+    }
+    return options;
+}
+
+int main(int argc, char* argv[])
 {
     try
     {
         init_log();
-        lvk::Engine().Run();
+        lvk::Engine(parse_options(argc, argv)).Run();
     }
     catch (std::exception& e)
     {
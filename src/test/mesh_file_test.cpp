@@ -0,0 +1,108 @@
+// std
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// module
+#include "lvk/lvk_mesh_file.hpp"
+
+// MeshFile has to reject damaged and crafted files before anything points into the mapping
+// usage: mesh_file_test
+
+// offsets into the header WriteMeshFile writes
+constexpr size_t VERTEX_OFFSET_FIELD = 24;
+constexpr size_t INDEX_OFFSET_FIELD = 32;
+constexpr size_t VERTEX_COUNT_FIELD = 40;
+constexpr size_t LOD_COUNT_FIELD = 44;
+
+static std::vector<char> ReadBytes(const std::filesystem::path &path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+static void WriteBytes(const std::filesystem::path &path, const std::vector<char> &bytes)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+template <typename T>
+static void Patch(std::vector<char> &bytes, size_t offset, T value)
+{
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+int main()
+{
+    auto directory = std::filesystem::temp_directory_path() / "lvk_mesh_file_test";
+    std::filesystem::create_directories(directory);
+    auto valid_path = directory / "valid.lvkmesh";
+
+    std::vector<lvk::Vertex> vertices{
+        {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}},
+        {{1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}},
+        {{0.f, 1.f, 0.f}, {0.f, 0.f, 1.f}},
+    };
+    std::vector<lvk::MeshLod> lods{{.indices = {0, 1, 2}, .error = 0.f}};
+    lvk::WriteMeshFile(valid_path, vertices, lods, 42);
+    auto valid = ReadBytes(valid_path);
+
+    int failures = 0;
+    auto expect = [&](std::string_view name, const std::vector<char> &bytes, bool loads)
+    {
+        auto path = directory / "case.lvkmesh";
+        WriteBytes(path, bytes);
+        std::string error;
+        try
+        {
+            lvk::MeshFile file(path);
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+        bool passed = error.empty() == loads;
+        failures += !passed;
+        std::cout << fmt::format("{:<32} {}{}\n", name, passed ? "ok" : "FAILED", error.empty() ? "" : fmt::format(" ({})", error));
+    };
+
+    expect("valid", valid, true);
+    expect("truncated header", {valid.begin(), valid.begin() + 16}, false);
+    expect("truncated lod table", {valid.begin(), valid.begin() + 96}, false);
+    expect("truncated vertices", {valid.begin(), valid.end() - 16 - sizeof(lvk::Vertex)}, false);
+    expect("truncated indices", {valid.begin(), valid.end() - 4}, false);
+
+    // the sum of offset and size wraps around to a small number that fits the file
+    auto overflow = valid;
+    Patch<uint64_t>(overflow, VERTEX_OFFSET_FIELD, 0xfffffffe80000070ull);
+    Patch<uint32_t>(overflow, VERTEX_COUNT_FIELD, 0x10000000u);
+    expect("overflowing vertex offset", overflow, false);
+
+    auto lod_overflow = valid;
+    Patch<uint32_t>(lod_overflow, LOD_COUNT_FIELD, 0xffffffffu);
+    expect("overflowing lod count", lod_overflow, false);
+
+    auto index_overflow = valid;
+    Patch<uint64_t>(index_overflow, INDEX_OFFSET_FIELD, 0xfffffffffffffff0ull);
+    expect("overflowing index offset", index_overflow, false);
+
+    auto out_of_range = valid;
+    uint64_t index_offset;
+    std::memcpy(&index_offset, valid.data() + INDEX_OFFSET_FIELD, sizeof(index_offset));
+    Patch<uint32_t>(out_of_range, index_offset, 3u);
+    expect("index past the vertices", out_of_range, false);
+
+    std::filesystem::remove_all(directory);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
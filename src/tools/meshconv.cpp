@@ -0,0 +1,63 @@
+// std
+#include <charconv>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// fmt
+#include <fmt/format.h>
+
+// module
+#include "lvk/lvk_job_system.hpp"
+#include "lvk/lvk_mesh_cache.hpp"
+#include "lvk/lvk_mesh_file.hpp"
+#include "lvk/lvk_mesh_optimizer.hpp"
+
+// converts an .obj into an .lvkmesh the engine uploads without parsing, see --model.
+// Converting everything ahead of time saves the first run with --mesh-cache from doing it
+// usage: meshconv [--lods N] SOURCE OUTPUT
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        uint32_t lod_count = lvk::DEFAULT_MESH_LOD_COUNT;
+        int first = 1;
+        if (argc > 2 && std::string_view(argv[1]) == "--lods")
+        {
+            std::string_view value(argv[2]);
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), lod_count);
+            if (error != std::errc() || end != value.data() + value.size() || lod_count == 0)
+            {
+                throw std::invalid_argument(fmt::format("expected a lod count above 0, got {}", value));
+            }
+            first = 3;
+        }
+        if (argc - first != 2)
+        {
+            std::cerr << "usage: meshconv [--lods N] SOURCE OUTPUT" << std::endl;
+            return 1;
+        }
+
+        lvk::JobSystem jobs;
+        lvk::ConvertMesh(argv[first], argv[first + 1], lod_count, &jobs);
+
+        lvk::MeshFile file(argv[first + 1]);
+        auto vertex_count = static_cast<uint32_t>(file.GetVertices().size());
+        std::cout << fmt::format("wrote {} with {} vertices", argv[first + 1], vertex_count) << std::endl;
+        for (uint32_t lod = 0; lod < file.GetLodCount(); lod++)
+        {
+            auto indices = file.GetIndices(lod);
+            auto stats = lvk::AnalyzeVertexCache(indices, vertex_count);
+            std::cout << fmt::format("  lod {}: {} triangles, error {:.4f}, acmr {:.3f}", lod, indices.size() / 3, file.GetLodError(lod), stats.acmr) << std::endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
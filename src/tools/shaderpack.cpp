@@ -0,0 +1,63 @@
+// std
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// module
+#include "lvk/lvk_mapped_file.hpp"
+#include "lvk/lvk_shader_bundle.hpp"
+
+// packs compiled shaders into a bundle the engine maps with --shader-bundle, each one
+// replaces the embedded shader of the same name, e.g. naive/naive.frag=build/my.frag.spv
+// usage: shaderpack OUTPUT NAME=SPV...
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: shaderpack OUTPUT NAME=SPV..." << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        std::vector<lvk::MappedFile> files;
+        std::vector<lvk::ShaderBundle::Entry> entries;
+        files.reserve(argc - 2);
+        for (int i = 2; i < argc; i++)
+        {
+            std::string_view arg(argv[i]);
+            auto separator = arg.find('=');
+            if (separator == std::string_view::npos)
+            {
+                throw std::invalid_argument(fmt::format("expected NAME=SPV, got {}", arg));
+            }
+
+            const auto &file = files.emplace_back(std::string(arg.substr(separator + 1)));
+            auto data = file.GetData();
+            if (data.empty() || data.size() % sizeof(uint32_t) != 0)
+            {
+                throw std::invalid_argument(fmt::format("{} is not a whole number of 32 bit words", file.GetPath().string()));
+            }
+            entries.push_back(
+            {
+                .name = std::string(arg.substr(0, separator)),
+                .code = {reinterpret_cast<const uint32_t *>(data.data()), data.size() / sizeof(uint32_t)}
+            });
+        }
+
+        lvk::ShaderBundle::Write(argv[1], entries);
+        std::cout << fmt::format("packed {} shaders into {}", entries.size(), argv[1]) << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}